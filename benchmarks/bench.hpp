@@ -0,0 +1,83 @@
+// small benchmark harness for vepp
+#ifndef VEPP_BENCH_HPP
+#define VEPP_BENCH_HPP
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/** number of heap allocations made by the process so far, counted by the
+ * operator new replacement in main.cpp */
+std::uint64_t allocation_count();
+
+/** keeps a value alive so the optimizer cannot drop its computation */
+template <class T> inline void do_not_optimize(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+/** same for a value the optimizer must also treat as modified, used on
+ * inputs so that constexpr construction cannot be folded into the loop */
+template <class T> inline void do_not_optimize(T &value) {
+  asm volatile("" : "+m"(value) : : "memory");
+}
+/** forces pending stores to memory */
+inline void clobber_memory() { asm volatile("" : : : "memory"); }
+
+/** Benchmark state: the body loops while keep_running() is true and the
+ * harness takes care of the iteration count and the measurements.*/
+class State {
+  std::size_t iterations;
+  std::size_t remaining;
+  std::size_t elements;
+
+public:
+  explicit State(std::size_t iters)
+      : iterations(iters), remaining(iters), elements(0) {}
+  bool keep_running() {
+    if (remaining == 0)
+      return false;
+    remaining--;
+    return true;
+  }
+  std::size_t max_iterations() const { return iterations; }
+  /** number of elements one iteration processes, reported as
+   * elements/s when set */
+  void set_elements(std::size_t n) { elements = n; }
+  std::size_t elements_per_iteration() const { return elements; }
+};
+
+typedef void (*bench_fn)(State &);
+
+struct Entry {
+  std::string name;
+  bench_fn fn;
+};
+
+inline std::vector<Entry> &registry() {
+  static std::vector<Entry> entries;
+  return entries;
+}
+
+struct Registrar {
+  Registrar(const std::string &name, bench_fn fn) {
+    Entry e;
+    e.name = name;
+    e.fn = fn;
+    registry().push_back(e);
+  }
+};
+
+} // namespace bench
+
+#define BENCH_IMPL_CONCAT2(a, b) a##b
+#define BENCH_IMPL_CONCAT(a, b) BENCH_IMPL_CONCAT2(a, b)
+
+/** registers a benchmark function, ie BENCH(bm_add) { while (state...) } */
+#define BENCH(name)                                                            \
+  static void name(bench::State &state);                                       \
+  static bench::Registrar BENCH_IMPL_CONCAT(name, _registrar)(#name, name);    \
+  static void name(bench::State &state)
+
+#endif
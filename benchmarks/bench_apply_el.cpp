@@ -0,0 +1,76 @@
+// inlined functors against std::function dispatch in apply_el
+#include "../vepp.hpp"
+#include "../vepp_memory.hpp"
+#include "bench.hpp"
+
+typedef float real;
+using namespace vepp;
+
+BENCH(bm_apply_el_lambda_vecn8) {
+  VecN<real, 8> a(1), b(2), out;
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    a.apply_el(b, [](real x, real y) { return x + y; }, out);
+    bench::do_not_optimize(out);
+  }
+}
+
+BENCH(bm_apply_el_std_function_vecn8) {
+  VecN<real, 8> a(1), b(2), out;
+  std::function<real(real, real)> fn = [](real x, real y) { return x + y; };
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    a.apply_el(b, fn, out);
+    bench::do_not_optimize(out);
+  }
+}
+
+BENCH(bm_add_vecn8) {
+  VecN<real, 8> a(1), b(2), out;
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    a.add(b, out);
+    bench::do_not_optimize(out);
+  }
+}
+
+BENCH(bm_add_vector8) {
+  VecN<real, 8> a(1);
+  std::vector<real> b(8, 2), out(8);
+  while (state.keep_running()) {
+    a.add(b, out);
+    bench::do_not_optimize(out.data());
+    bench::clobber_memory();
+  }
+}
+
+/** a request allocating fresh output vectors, from the heap and from an
+ * arena released once per request*/
+BENCH(bm_add_vector8_fresh) {
+  VecN<real, 8> a(1);
+  std::vector<real> b(8, 2);
+  while (state.keep_running()) {
+    std::vector<real> s, t;
+    a.add(b, s);
+    a.multiply(s, t);
+    bench::do_not_optimize(t.data());
+  }
+}
+
+BENCH(bm_add_vector8_arena) {
+  VecN<real, 8> a(1);
+  std::vector<real> b(8, 2);
+  Arena &arena = thread_arena();
+  while (state.keep_running()) {
+    {
+      ArenaVector<real> s, t;
+      a.add(b, s);
+      a.multiply(s, t);
+      bench::do_not_optimize(t.data());
+    }
+    arena.reset();
+  }
+}
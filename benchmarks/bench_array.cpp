@@ -0,0 +1,84 @@
+// bulk structure of arrays operations against per vector calls
+#include "../vepp_array.hpp"
+#include "bench.hpp"
+
+typedef float real;
+using namespace vepp;
+
+static const std::size_t nb_vectors = 1 << 16;
+
+BENCH(bm_array_add_aos_calls) {
+  std::vector<VecN<real, 3>> a(nb_vectors, VecN<real, 3>(1));
+  std::vector<VecN<real, 3>> b(nb_vectors, VecN<real, 3>(2));
+  std::vector<VecN<real, 3>> out(nb_vectors);
+  while (state.keep_running()) {
+    for (std::size_t i = 0; i < nb_vectors; i++) {
+      a[i].add(b[i], out[i]);
+    }
+    bench::do_not_optimize(out.data());
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_array_add_soa) {
+  VecNArray<real, 3> a(nb_vectors, 1), b(nb_vectors, 2), out(nb_vectors);
+  while (state.keep_running()) {
+    Result r = a.add(b, out);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_array_dot_aos_calls) {
+  std::vector<VecN<real, 4>> a(nb_vectors, VecN<real, 4>(1));
+  std::vector<VecN<real, 4>> b(nb_vectors, VecN<real, 4>(2));
+  std::vector<real> out(nb_vectors);
+  while (state.keep_running()) {
+    for (std::size_t i = 0; i < nb_vectors; i++) {
+      a[i].dot(b[i], out[i]);
+    }
+    bench::do_not_optimize(out.data());
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_array_dot_soa) {
+  VecNArray<real, 4> a(nb_vectors, 1), b(nb_vectors, 2);
+  std::vector<real> out(nb_vectors);
+  while (state.keep_running()) {
+    Result r = a.dot(b, out);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_array_from_aos) {
+  std::vector<VecN<real, 3>> a(nb_vectors, VecN<real, 3>(1));
+  VecNArray<real, 3> out(nb_vectors);
+  while (state.keep_running()) {
+    out.from_aos(a);
+    bench::clobber_memory();
+  }
+}
+
+/** pos += vel * dt as two passes with a temporary, then fused in place*/
+BENCH(bm_array_update_two_pass) {
+  VecNArray<real, 3> pos(nb_vectors, 1), vel(nb_vectors, 2), tmp(nb_vectors);
+  const real dt = static_cast<real>(0.01);
+  while (state.keep_running()) {
+    vel.multiply(dt, tmp);
+    Result r = pos.add(tmp, pos);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_array_update_axpy) {
+  VecNArray<real, 3> pos(nb_vectors, 1), vel(nb_vectors, 2);
+  const real dt = static_cast<real>(0.01);
+  while (state.keep_running()) {
+    Result r = pos.axpy(dt, vel);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
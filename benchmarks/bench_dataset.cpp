@@ -0,0 +1,89 @@
+// loading vector datasets: parsing into VecN against mapping a file
+#include "../vepp_dataset.hpp"
+#include "bench.hpp"
+#include <cstdio>
+
+typedef float real;
+using namespace vepp;
+
+static const std::size_t nb_vectors = 1 << 16;
+static const char *bench_path = "bench_dataset.bin";
+
+static void make_dataset() {
+  dataset::Writer<real, 3> w;
+  w.open(bench_path);
+  std::vector<real> v(3 * nb_vectors, 1);
+  w.append(v.data(), nb_vectors);
+  w.close();
+}
+
+/** the old path, a std::vector per record through the VecN constructor*/
+BENCH(bm_dataset_load_vectors) {
+  std::vector<real> flat(3 * nb_vectors, 1);
+  std::vector<VecN<real, 3>> out;
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    out.clear();
+    for (std::size_t i = 0; i < nb_vectors; i++) {
+      std::vector<real> rec(flat.begin() + 3 * i, flat.begin() + 3 * i + 3);
+      out.push_back(VecN<real, 3>(rec));
+    }
+    bench::do_not_optimize(out.data());
+  }
+}
+
+BENCH(bm_dataset_open) {
+  make_dataset();
+  dataset::Reader<real, 3> r;
+  while (state.keep_running()) {
+    Result res = r.open(bench_path);
+    bench::do_not_optimize(res);
+    r.close();
+  }
+  std::remove(bench_path);
+}
+
+BENCH(bm_dataset_open_and_sum) {
+  make_dataset();
+  dataset::Reader<real, 3> r;
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    r.open(bench_path);
+    ConstVecNView<real, 3> v(nullptr);
+    real sum = 0, d = 0;
+    for (std::size_t i = 0; i < nb_vectors; i++) {
+      r.get(i, v);
+      v.dot(v, d);
+      sum += d;
+    }
+    bench::do_not_optimize(sum);
+    r.close();
+  }
+  std::remove(bench_path);
+}
+
+BENCH(bm_dataset_verify) {
+  make_dataset();
+  dataset::Reader<real, 3> r;
+  r.open(bench_path);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result res = r.verify();
+    bench::do_not_optimize(res);
+  }
+  r.close();
+  std::remove(bench_path);
+}
+
+BENCH(bm_dataset_write) {
+  VecNArray<real, 3> batch(nb_vectors, 1);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    dataset::Writer<real, 3> w;
+    w.open(bench_path);
+    w.append(batch);
+    Result res = w.close();
+    bench::do_not_optimize(res);
+  }
+  std::remove(bench_path);
+}
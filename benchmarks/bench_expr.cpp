@@ -0,0 +1,38 @@
+// fused expressions against chains of Result returning calls
+#include "../vepp.hpp"
+#include "bench.hpp"
+
+typedef float real;
+using namespace vepp;
+
+template <unsigned int N> static void bm_expr_fused(bench::State &state) {
+  VecN<real, N> a(1), b(2), c(3), out;
+  real s = 1.5f;
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    bench::do_not_optimize(c);
+    out = a * s + b - c;
+    bench::do_not_optimize(out);
+  }
+}
+template <unsigned int N> static void bm_expr_chained(bench::State &state) {
+  VecN<real, N> a(1), b(2), c(3), t1, t2, out;
+  real s = 1.5f;
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    bench::do_not_optimize(c);
+    a.multiply(s, t1);
+    t1.add(b, t2);
+    t2.subtract(c, out);
+    bench::do_not_optimize(out);
+  }
+}
+
+static bench::Registrar r_fused4("bm_expr_fused_4", bm_expr_fused<4>);
+static bench::Registrar r_chain4("bm_expr_chained_4", bm_expr_chained<4>);
+static bench::Registrar r_fused16("bm_expr_fused_16", bm_expr_fused<16>);
+static bench::Registrar r_chain16("bm_expr_chained_16", bm_expr_chained<16>);
+static bench::Registrar r_fused64("bm_expr_fused_64", bm_expr_fused<64>);
+static bench::Registrar r_chain64("bm_expr_chained_64", bm_expr_chained<64>);
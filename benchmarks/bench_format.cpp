@@ -0,0 +1,61 @@
+// text output: an ostream per element against the to_chars kernel
+#include "../vepp_format.hpp"
+#include "bench.hpp"
+#include <cstdio>
+#include <sstream>
+
+typedef float real;
+using namespace vepp;
+
+static const std::size_t nb_vectors = 1 << 14;
+
+static VecNArray<real, 3> input() {
+  VecNArray<real, 3> a(nb_vectors);
+  for (std::size_t i = 0; i < nb_vectors; i++) {
+    a.set(i, VecN<real, 3>(std::array<real, 3>{i * 0.1f, 1.0f / (i + 1),
+                                               -1.5f * i}));
+  }
+  return a;
+}
+
+/** the old path: every element through a stream with round trip precision*/
+BENCH(bm_format_ostream) {
+  const VecNArray<real, 3> a = input();
+  std::ostringstream out;
+  out.precision(9);
+  VecN<real, 3> v;
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    out.str("");
+    for (std::size_t i = 0; i < nb_vectors; i++) {
+      a.get(i, v);
+      out << v.eval(0) << ", " << v.eval(1) << ", " << v.eval(2) << '\n';
+    }
+    bench::do_not_optimize(out);
+  }
+}
+
+BENCH(bm_format_batch) {
+  const VecNArray<real, 3> a = input();
+  std::vector<char> buf(1 << 20);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    std::size_t next = 0, w = 0;
+    Result r = text::format(a, next, buf.data(), buf.size(), w);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_format_writer) {
+  const VecNArray<real, 3> a = input();
+  std::FILE *f = std::fopen("/dev/null", "w");
+  text::Writer out(f);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result r = out.write(a);
+    bench::do_not_optimize(r);
+  }
+  out.flush();
+  std::fclose(f);
+}
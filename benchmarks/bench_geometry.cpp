@@ -0,0 +1,95 @@
+// triangle normals and the fused geometry kernels
+#include "../vepp.hpp"
+#include "bench.hpp"
+
+typedef float real;
+using namespace vepp;
+
+typedef VecN<real, 3> Vec3;
+
+static const unsigned int nb_triangles = 4096;
+
+/** deterministic triangle soup, three vertices per triangle*/
+static std::vector<Vec3> triangle_soup() {
+  std::vector<Vec3> v(3 * nb_triangles);
+  for (unsigned int i = 0; i < v.size(); i++) {
+    std::array<real, 3> arr = {{static_cast<real>(i % 7) + 0.5f,
+                                static_cast<real>(i % 11) - 3.0f,
+                                static_cast<real>(i % 13) * 0.25f}};
+    v[i] = Vec3(arr);
+  }
+  return v;
+}
+
+/** one normal per op with the fused methods*/
+BENCH(bm_triangle_normal_fused) {
+  std::vector<Vec3> soup = triangle_soup();
+  std::vector<Vec3> normals(nb_triangles, Vec3(0));
+  unsigned int t = 0;
+  while (state.keep_running()) {
+    const Vec3 &a = soup[3 * t], &b = soup[3 * t + 1], &c = soup[3 * t + 2];
+    Vec3 e1 = b - a, e2 = c - a;
+    e1.cross(e2, e1);
+    e1.normalize(normals[t]);
+    t = (t + 1) % nb_triangles;
+  }
+  bench::do_not_optimize(normals.data());
+  bench::clobber_memory();
+}
+
+/** the same normal built per component through get and set*/
+BENCH(bm_triangle_normal_get_set) {
+  std::vector<Vec3> soup = triangle_soup();
+  std::vector<Vec3> normals(nb_triangles, Vec3(0));
+  unsigned int t = 0;
+  while (state.keep_running()) {
+    real a[3], b[3], c[3];
+    for (unsigned int k = 0; k < 3; k++) {
+      soup[3 * t].get(k, a[k]);
+      soup[3 * t + 1].get(k, b[k]);
+      soup[3 * t + 2].get(k, c[k]);
+    }
+    real e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    real e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    real n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                 e1[0] * e2[1] - e1[1] * e2[0]};
+    real len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    for (unsigned int k = 0; k < 3; k++) {
+      normals[t].set(k, n[k] / len);
+    }
+    t = (t + 1) % nb_triangles;
+  }
+  bench::do_not_optimize(normals.data());
+  bench::clobber_memory();
+}
+
+BENCH(bm_cross3) {
+  Vec3 a(1), b(2), out(0);
+  b.set(1, 3);
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    a.cross(b, out);
+    bench::do_not_optimize(out);
+  }
+}
+
+BENCH(bm_normalize3) {
+  Vec3 a(2), out(0);
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    a.normalize(out);
+    bench::do_not_optimize(out);
+  }
+}
+
+BENCH(bm_distance3) {
+  Vec3 a(2), b(-1);
+  real d = 0;
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    a.distance(b, d);
+    bench::do_not_optimize(d);
+  }
+}
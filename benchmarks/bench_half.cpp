@@ -0,0 +1,89 @@
+// 16 bit storage: conversions and dot products with float accumulation
+#include "../vepp_array.hpp"
+#include "../vepp_half.hpp"
+#include "bench.hpp"
+
+using namespace vepp;
+
+static const std::size_t nb_elements = 1 << 16;
+
+/** below AVX2 the conversions fall back to the portable bit twiddling*/
+template <simd::isa_t Isa> static void bm_half_widen(bench::State &state) {
+  simd::isa_t prev = simd::active_isa();
+  simd::set_isa(Isa);
+  std::vector<half> in(nb_elements, half(1.5f));
+  std::vector<float> out(nb_elements);
+  state.set_elements(nb_elements);
+  while (state.keep_running()) {
+    simd::convert(in.data(), out.data(), nb_elements);
+    bench::clobber_memory();
+  }
+  simd::set_isa(prev);
+}
+template <simd::isa_t Isa> static void bm_half_narrow(bench::State &state) {
+  simd::isa_t prev = simd::active_isa();
+  simd::set_isa(Isa);
+  std::vector<float> in(nb_elements, 1.5f);
+  std::vector<half> out(nb_elements);
+  state.set_elements(nb_elements);
+  while (state.keep_running()) {
+    simd::convert(in.data(), out.data(), nb_elements);
+    bench::clobber_memory();
+  }
+  simd::set_isa(prev);
+}
+static bench::Registrar r_widen_sw("bm_half_widen_software",
+                                   bm_half_widen<simd::ISA_SSE2>);
+static bench::Registrar r_widen_hw("bm_half_widen_f16c",
+                                   bm_half_widen<simd::ISA_AVX512>);
+static bench::Registrar r_narrow_sw("bm_half_narrow_software",
+                                    bm_half_narrow<simd::ISA_SSE2>);
+static bench::Registrar r_narrow_hw("bm_half_narrow_f16c",
+                                    bm_half_narrow<simd::ISA_AVX512>);
+
+BENCH(bm_bfloat16_widen) {
+  std::vector<bfloat16> in(nb_elements, bfloat16(1.5f));
+  std::vector<float> out(nb_elements);
+  state.set_elements(nb_elements);
+  while (state.keep_running()) {
+    simd::convert(in.data(), out.data(), nb_elements);
+    bench::clobber_memory();
+  }
+}
+
+/** the same dot product over float storage, half storage read into float
+ * blocks, and float storage accumulated in double*/
+BENCH(bm_half_dot_float_storage) {
+  std::vector<float> a(nb_elements, 1), b(nb_elements, 0.5f);
+  while (state.keep_running()) {
+    float d = simd::dot(a.data(), b.data(), nb_elements);
+    bench::do_not_optimize(d);
+  }
+}
+
+BENCH(bm_half_dot_half_storage) {
+  std::vector<half> a(nb_elements, half(1.0f)), b(nb_elements, half(0.5f));
+  while (state.keep_running()) {
+    float d = simd::dot_acc<float>(a.data(), b.data(), nb_elements);
+    bench::do_not_optimize(d);
+  }
+}
+
+BENCH(bm_half_dot_double_acc) {
+  std::vector<float> a(nb_elements, 1), b(nb_elements, 0.5f);
+  while (state.keep_running()) {
+    double d = simd::dot_acc<double>(a.data(), b.data(), nb_elements);
+    bench::do_not_optimize(d);
+  }
+}
+
+BENCH(bm_half_array_dot) {
+  VecNArray<half, 4> a(nb_elements / 4, half(1.0f));
+  VecNArray<half, 4> b(nb_elements / 4, half(0.5f));
+  std::vector<float> out(nb_elements / 4);
+  while (state.keep_running()) {
+    Result r = a.dot(b, out);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
@@ -0,0 +1,76 @@
+// matrix products and batched transforms
+#include "../vepp_mat.hpp"
+#include "bench.hpp"
+
+typedef float real;
+using namespace vepp;
+
+template <unsigned int R, unsigned int C>
+static MatNM<real, R, C> sample_mat() {
+  MatNM<real, R, C> m(0);
+  for (unsigned int r = 0; r < R; r++) {
+    for (unsigned int c = 0; c < C; c++) {
+      m.set(r, c, static_cast<real>((r * 7 + c * 3) % 11) * 0.25f);
+    }
+  }
+  return m;
+}
+
+template <unsigned int N> static void bm_mat_vec(bench::State &state) {
+  MatNM<real, N, N> m = sample_mat<N, N>();
+  VecN<real, N> v(1.5f), out(0);
+  while (state.keep_running()) {
+    bench::do_not_optimize(m);
+    bench::do_not_optimize(v);
+    m.multiply(v, out);
+    bench::do_not_optimize(out);
+  }
+}
+static bench::Registrar r_mv3("bm_mat_vec_3", bm_mat_vec<3>);
+static bench::Registrar r_mv4("bm_mat_vec_4", bm_mat_vec<4>);
+static bench::Registrar r_mv8("bm_mat_vec_8", bm_mat_vec<8>);
+
+template <unsigned int N> static void bm_matmul(bench::State &state) {
+  // heap allocated, the large sizes do not fit on the stack twice
+  std::vector<MatNM<real, N, N>> m(3, sample_mat<N, N>());
+  while (state.keep_running()) {
+    bench::do_not_optimize(m[0]);
+    m[0].multiply(m[1], m[2]);
+    bench::do_not_optimize(m[2]);
+  }
+}
+static bench::Registrar r_mm4("bm_matmul_4", bm_matmul<4>);
+static bench::Registrar r_mm16("bm_matmul_16", bm_matmul<16>);
+static bench::Registrar r_mm128("bm_matmul_128", bm_matmul<128>);
+
+static const std::size_t nb_vectors = 4096;
+
+/** 4096 vectors through a 4x4 transform per op, structure of arrays*/
+BENCH(bm_transform_4x4_batch) {
+  MatNM<real, 4, 4> m = sample_mat<4, 4>();
+  VecNArray<real, 4> in(nb_vectors, 1.5f), out(nb_vectors);
+  while (state.keep_running()) {
+    m.multiply(in, out);
+    bench::clobber_memory();
+  }
+}
+/** the same transform one VecN at a time*/
+BENCH(bm_transform_4x4_loop) {
+  MatNM<real, 4, 4> m = sample_mat<4, 4>();
+  std::vector<VecN<real, 4>> in(nb_vectors, VecN<real, 4>(1.5f));
+  std::vector<VecN<real, 4>> out(nb_vectors, VecN<real, 4>(0));
+  while (state.keep_running()) {
+    for (std::size_t i = 0; i < nb_vectors; i++) {
+      m.multiply(in[i], out[i]);
+    }
+    bench::clobber_memory();
+  }
+}
+BENCH(bm_transform_3x3_batch) {
+  MatNM<real, 3, 3> m = sample_mat<3, 3>();
+  VecNArray<real, 3> in(nb_vectors, 1.5f), out(nb_vectors);
+  while (state.keep_running()) {
+    m.multiply(in, out);
+    bench::clobber_memory();
+  }
+}
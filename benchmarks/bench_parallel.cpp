@@ -0,0 +1,103 @@
+// scaling of the parallel batch engine from one thread to every core
+#include "../vepp_parallel.hpp"
+#include "bench.hpp"
+#include <thread>
+
+typedef float real;
+using namespace vepp;
+
+/** past the last level cache, so the bulk calls are memory bound*/
+static const std::size_t nb_vectors = 1 << 21;
+
+/** thread counts measured: powers of two up to the hardware threads and
+ * the hardware thread count itself*/
+static const unsigned int nb_slots = 10;
+static std::vector<unsigned int> &thread_counts() {
+  static std::vector<unsigned int> counts;
+  if (counts.empty()) {
+    unsigned int hw = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int t = 1; t < hw && counts.size() + 1 < nb_slots; t *= 2) {
+      counts.push_back(t);
+    }
+    counts.push_back(hw);
+  }
+  return counts;
+}
+
+template <unsigned int Slot> static void bm_parallel_add(bench::State &state) {
+  parallel::Pool pool(thread_counts()[Slot]);
+  VecNArray<real, 3> a, b, out;
+  parallel::first_touch(pool, a, nb_vectors, static_cast<real>(1));
+  parallel::first_touch(pool, b, nb_vectors, static_cast<real>(2));
+  parallel::first_touch(pool, out, nb_vectors, static_cast<real>(0));
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result r = parallel::add(pool, a, b, out);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
+
+template <unsigned int Slot> static void bm_parallel_dot(bench::State &state) {
+  parallel::Pool pool(thread_counts()[Slot]);
+  VecNArray<real, 3> a, b;
+  parallel::first_touch(pool, a, nb_vectors, static_cast<real>(1));
+  parallel::first_touch(pool, b, nb_vectors, static_cast<real>(2));
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    real d = 0;
+    parallel::dot(pool, a, b, d);
+    bench::do_not_optimize(d);
+  }
+}
+
+template <unsigned int Slot>
+static void bm_parallel_dot_deterministic(bench::State &state) {
+  parallel::Pool pool(thread_counts()[Slot]);
+  VecNArray<real, 3> a, b;
+  parallel::first_touch(pool, a, nb_vectors, static_cast<real>(1));
+  parallel::first_touch(pool, b, nb_vectors, static_cast<real>(2));
+  parallel::Options o;
+  o.deterministic = true;
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    real d = 0;
+    parallel::dot(pool, a, b, d, o);
+    bench::do_not_optimize(d);
+  }
+}
+
+template <unsigned int Slot> static void bm_parallel_norms(bench::State &state) {
+  parallel::Pool pool(thread_counts()[Slot]);
+  VecNArray<real, 3> a;
+  parallel::first_touch(pool, a, nb_vectors, static_cast<real>(1));
+  std::vector<real> out(nb_vectors);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result r = parallel::norms(pool, a, out);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
+
+template <unsigned int Slot> static void add_slot(unsigned int threads) {
+  std::string t = "_t" + std::to_string(threads);
+  bench::Registrar("bm_parallel_add" + t, bm_parallel_add<Slot>);
+  bench::Registrar("bm_parallel_dot" + t, bm_parallel_dot<Slot>);
+  bench::Registrar("bm_parallel_dot_deterministic" + t,
+                   bm_parallel_dot_deterministic<Slot>);
+  bench::Registrar("bm_parallel_norms" + t, bm_parallel_norms<Slot>);
+}
+
+static bool register_scaling() {
+  typedef void (*add_fn)(unsigned int);
+  static const add_fn slots[nb_slots] = {
+      add_slot<0>, add_slot<1>, add_slot<2>, add_slot<3>, add_slot<4>,
+      add_slot<5>, add_slot<6>, add_slot<7>, add_slot<8>, add_slot<9>};
+  const std::vector<unsigned int> &counts = thread_counts();
+  for (unsigned int i = 0; i < counts.size(); i++) {
+    slots[i](counts[i]);
+  }
+  return true;
+}
+static bool scaling_registered = register_scaling();
@@ -0,0 +1,59 @@
+// per operation cost of the VecN error policies
+#include "../vepp.hpp"
+#include "bench.hpp"
+
+typedef float real;
+using namespace vepp;
+
+template <class Policy> static void bm_get_policy(bench::State &state) {
+  VecN<real, 8, Policy> v(1);
+  real t = 0;
+  unsigned int i = 0;
+  while (state.keep_running()) {
+    v.get(i & 7, t);
+    bench::do_not_optimize(t);
+    i++;
+  }
+}
+template <class Policy> static void bm_set_policy(bench::State &state) {
+  VecN<real, 8, Policy> v(1);
+  unsigned int i = 0;
+  while (state.keep_running()) {
+    v.set(i & 7, static_cast<real>(i));
+    i++;
+  }
+  bench::do_not_optimize(v);
+}
+template <class Policy> static void bm_divide_policy(bench::State &state) {
+  VecN<real, 8, Policy> a(3), b(2), out;
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    Result r = a.divide(b, out);
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(out);
+  }
+}
+
+static bench::Registrar r_get_checked("bm_get_checked",
+                                      bm_get_policy<CheckedPolicy>);
+static bench::Registrar r_get_throw("bm_get_throw", bm_get_policy<ThrowPolicy>);
+static bench::Registrar r_get_assert("bm_get_assert",
+                                     bm_get_policy<AssertPolicy>);
+static bench::Registrar r_get_unchecked("bm_get_unchecked",
+                                        bm_get_policy<UncheckedPolicy>);
+static bench::Registrar r_set_checked("bm_set_checked",
+                                      bm_set_policy<CheckedPolicy>);
+static bench::Registrar r_set_throw("bm_set_throw", bm_set_policy<ThrowPolicy>);
+static bench::Registrar r_set_assert("bm_set_assert",
+                                     bm_set_policy<AssertPolicy>);
+static bench::Registrar r_set_unchecked("bm_set_unchecked",
+                                        bm_set_policy<UncheckedPolicy>);
+static bench::Registrar r_div_checked("bm_divide_checked",
+                                      bm_divide_policy<CheckedPolicy>);
+static bench::Registrar r_div_throw("bm_divide_throw",
+                                    bm_divide_policy<ThrowPolicy>);
+static bench::Registrar r_div_assert("bm_divide_assert",
+                                     bm_divide_policy<AssertPolicy>);
+static bench::Registrar r_div_unchecked("bm_divide_unchecked",
+                                        bm_divide_policy<UncheckedPolicy>);
@@ -0,0 +1,100 @@
+// quaternion rotations, per vector calls against the batched kernels
+#include "../vepp_quat.hpp"
+#include "bench.hpp"
+
+typedef float real;
+using namespace vepp;
+
+static const std::size_t nb_vectors = 1 << 16;
+
+static Quat<real> rotation() {
+  Quat<real> q;
+  Quat<real>::from_axis_angle(VecN<real, 3>(std::array<real, 3>{1, 2, 2}),
+                              static_cast<real>(0.7), q);
+  return q;
+}
+
+BENCH(bm_quat_rotate_calls) {
+  const Quat<real> q = rotation();
+  std::vector<VecN<real, 3>> v(nb_vectors, VecN<real, 3>(1));
+  std::vector<VecN<real, 3>> out(nb_vectors);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    for (std::size_t i = 0; i < nb_vectors; i++) {
+      q.rotate(v[i], out[i]);
+    }
+    bench::do_not_optimize(out.data());
+    bench::clobber_memory();
+  }
+}
+
+/** one quaternion for the batch, through its rotation matrix*/
+BENCH(bm_quat_rotate_batch_one) {
+  const Quat<real> q = rotation();
+  VecNArray<real, 3> v(nb_vectors, 1), out(nb_vectors);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result r = q.rotate(v, out);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
+
+/** a quaternion per vector*/
+BENCH(bm_quat_rotate_batch_each) {
+  const Quat<real> q = rotation();
+  VecNArray<real, 4> qs(nb_vectors);
+  for (std::size_t i = 0; i < nb_vectors; i++) {
+    qs.set(i, q.coeffs());
+  }
+  VecNArray<real, 3> v(nb_vectors, 1), out(nb_vectors);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result r = quat::rotate(qs, v, out);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_quat_multiply_calls) {
+  const Quat<real> q = rotation();
+  std::vector<Quat<real>> a(nb_vectors, q), out(nb_vectors);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    for (std::size_t i = 0; i < nb_vectors; i++) {
+      a[i].multiply(q, out[i]);
+    }
+    bench::do_not_optimize(out.data());
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_quat_multiply_batch) {
+  const Quat<real> q = rotation();
+  VecNArray<real, 4> a(nb_vectors), out(nb_vectors);
+  for (std::size_t i = 0; i < nb_vectors; i++) {
+    a.set(i, q.coeffs());
+  }
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result r = quat::multiply(a, a, out);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_quat_slerp_batch) {
+  VecNArray<real, 4> a(nb_vectors), b(nb_vectors), out(nb_vectors);
+  Quat<real> qa = rotation(), qb;
+  qa.multiply(qa, qb);
+  for (std::size_t i = 0; i < nb_vectors; i++) {
+    a.set(i, qa.coeffs());
+    b.set(i, qb.coeffs());
+  }
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result r = quat::slerp(a, b, static_cast<real>(0.3), out);
+    bench::do_not_optimize(r);
+    bench::clobber_memory();
+  }
+}
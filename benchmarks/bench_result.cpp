@@ -0,0 +1,67 @@
+// cost of building and returning Result objects from VecN calls
+#include "../vepp.hpp"
+#include "bench.hpp"
+
+typedef float real;
+using namespace vepp;
+
+BENCH(bm_result_size) {
+  VecN<real, 4> v(1);
+  unsigned int n = 0;
+  while (state.keep_running()) {
+    Result r = v.size(n);
+    bench::do_not_optimize(r);
+  }
+}
+
+BENCH(bm_result_get) {
+  VecN<real, 4> v(1);
+  real t = 0;
+  unsigned int i = 0;
+  while (state.keep_running()) {
+    Result r = v.get(i & 3, t);
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(t);
+    i++;
+  }
+}
+
+BENCH(bm_result_set) {
+  VecN<real, 4> v(1);
+  unsigned int i = 0;
+  while (state.keep_running()) {
+    Result r = v.set(i & 3, static_cast<real>(i));
+    bench::do_not_optimize(r);
+    i++;
+  }
+  bench::do_not_optimize(v);
+}
+
+BENCH(bm_result_add_vecn) {
+  VecN<real, 4> a(1), b(2), out;
+  while (state.keep_running()) {
+    Result r = a.add(b, out);
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(out);
+  }
+}
+
+BENCH(bm_result_dot_vecn) {
+  VecN<real, 4> a(1), b(2);
+  real out = 0;
+  while (state.keep_running()) {
+    Result r = a.dot(b, out);
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(out);
+  }
+}
+
+BENCH(bm_result_check_m) {
+  VecN<real, 4> v(1);
+  unsigned int n = 0;
+  while (state.keep_running()) {
+    Result r;
+    CHECK_M(v.size(n), r);
+    bench::do_not_optimize(r);
+  }
+}
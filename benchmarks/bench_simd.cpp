@@ -0,0 +1,65 @@
+// bulk kernels of each SIMD backend
+#include "../vepp.hpp"
+#include "bench.hpp"
+
+using namespace vepp;
+
+static const std::size_t nb_elements = 4096;
+
+template <class T, simd::isa_t Isa>
+static void bm_simd_add(bench::State &state) {
+  simd::isa_t prev = simd::active_isa();
+  simd::set_isa(Isa);
+  std::vector<T> a(nb_elements, 1), b(nb_elements, 2), out(nb_elements);
+  while (state.keep_running()) {
+    simd::add(a.data(), b.data(), out.data(), nb_elements);
+    bench::clobber_memory();
+  }
+  simd::set_isa(prev);
+}
+template <class T, simd::isa_t Isa>
+static void bm_simd_dot(bench::State &state) {
+  simd::isa_t prev = simd::active_isa();
+  simd::set_isa(Isa);
+  std::vector<T> a(nb_elements, 1), b(nb_elements, 2);
+  while (state.keep_running()) {
+    T d = simd::dot(a.data(), b.data(), nb_elements);
+    bench::do_not_optimize(d);
+  }
+  simd::set_isa(prev);
+}
+template <class T, unsigned int N>
+static void bm_simd_vecn_dot(bench::State &state) {
+  VecN<T, N> a(1), b(2);
+  T out = 0;
+  while (state.keep_running()) {
+    a.dot(b, out);
+    bench::do_not_optimize(out);
+  }
+}
+
+#define BM_SIMD_ISAS(fn, T, tname)                                             \
+  static bench::Registrar r_##fn##_##tname##_scalar(                           \
+      #fn "_" #tname "_scalar", fn<T, simd::ISA_SCALAR>);                      \
+  static bench::Registrar r_##fn##_##tname##_sse2(#fn "_" #tname "_sse2",      \
+                                                  fn<T, simd::ISA_SSE2>);      \
+  static bench::Registrar r_##fn##_##tname##_avx2(#fn "_" #tname "_avx2",      \
+                                                  fn<T, simd::ISA_AVX2>);      \
+  static bench::Registrar r_##fn##_##tname##_avx512(                           \
+      #fn "_" #tname "_avx512", fn<T, simd::ISA_AVX512>);
+
+BM_SIMD_ISAS(bm_simd_add, float, float)
+BM_SIMD_ISAS(bm_simd_dot, float, float)
+BM_SIMD_ISAS(bm_simd_add, double, double)
+BM_SIMD_ISAS(bm_simd_dot, double, double)
+BM_SIMD_ISAS(bm_simd_add, std::int32_t, int32)
+BM_SIMD_ISAS(bm_simd_dot, std::int32_t, int32)
+
+static bench::Registrar r_vdot3("bm_simd_vecn_dot_float_3",
+                                bm_simd_vecn_dot<float, 3>);
+static bench::Registrar r_vdot4("bm_simd_vecn_dot_float_4",
+                                bm_simd_vecn_dot<float, 4>);
+static bench::Registrar r_vdot16("bm_simd_vecn_dot_float_16",
+                                 bm_simd_vecn_dot<float, 16>);
+static bench::Registrar r_vdotd4("bm_simd_vecn_dot_double_4",
+                                 bm_simd_vecn_dot<double, 4>);
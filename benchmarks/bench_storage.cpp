@@ -0,0 +1,84 @@
+// VecN storage layouts: packed, aligned, padded and cache line isolated
+#include "../vepp.hpp"
+#include "bench.hpp"
+#include <thread>
+
+typedef float real;
+using namespace vepp;
+
+static const unsigned int nb_vectors = 4096;
+
+template <class V> static std::vector<V> samples() {
+  std::vector<V> vs;
+  for (unsigned int i = 0; i < nb_vectors; i++) {
+    std::array<real, 3> arr = {{static_cast<real>(i % 17) - 8.0f,
+                                static_cast<real>(i % 13) * 0.5f - 3.0f,
+                                static_cast<real>(i % 7) + 0.25f}};
+    vs.push_back(V(arr));
+  }
+  return vs;
+}
+
+template <class V> static void dot_pairs(bench::State &state) {
+  std::vector<V> a = samples<V>(), b = samples<V>();
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    real sum = 0;
+    for (unsigned int i = 0; i < nb_vectors; i++) {
+      real d = 0;
+      a[i].dot(b[i], d);
+      sum += d;
+    }
+    bench::do_not_optimize(sum);
+  }
+}
+template <class V> static void normalize_all(bench::State &state) {
+  std::vector<V> a = samples<V>(), out(nb_vectors);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    for (unsigned int i = 0; i < nb_vectors; i++) {
+      a[i].normalize(out[i]);
+    }
+    bench::do_not_optimize(out.data());
+    bench::clobber_memory();
+  }
+}
+
+BENCH(bm_storage_dot_packed) { dot_pairs<VecN<real, 3>>(state); }
+BENCH(bm_storage_dot_aligned16) { dot_pairs<VecNAligned<real, 3, 16>>(state); }
+BENCH(bm_storage_dot_padded) { dot_pairs<VecNPadded<real, 3>>(state); }
+BENCH(bm_storage_normalize_packed) { normalize_all<VecN<real, 3>>(state); }
+BENCH(bm_storage_normalize_padded) {
+  normalize_all<VecNPadded<real, 3>>(state);
+}
+
+/** every thread adds into its own accumulator, neighbours in a packed
+ * array share cache lines*/
+template <class V> static void accumulate(bench::State &state) {
+  const unsigned int nb_threads =
+      std::max(2u, std::thread::hardware_concurrency());
+  const unsigned int nb_adds = 1 << 16;
+  std::vector<V> acc(nb_threads, V(0));
+  state.set_elements(nb_threads * nb_adds);
+  while (state.keep_running()) {
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < nb_threads; t++) {
+      threads.push_back(std::thread([&acc, t, nb_adds]() {
+        V step(1);
+        for (unsigned int i = 0; i < nb_adds; i++) {
+          acc[t].add(step, acc[t]);
+          bench::clobber_memory();
+        }
+      }));
+    }
+    for (std::thread &th : threads) {
+      th.join();
+    }
+  }
+  bench::do_not_optimize(acc.data());
+}
+
+BENCH(bm_storage_accumulate_packed) { accumulate<VecN<real, 3>>(state); }
+BENCH(bm_storage_accumulate_cacheline) {
+  accumulate<VecNCacheLine<real, 3>>(state);
+}
@@ -0,0 +1,64 @@
+// text ingest: iostream into std::vector and VecN against text::parse
+#include "../vepp_text.hpp"
+#include "bench.hpp"
+#include <sstream>
+#include <string>
+
+typedef float real;
+using namespace vepp;
+
+static const std::size_t nb_vectors = 1 << 14;
+
+static std::string text_input() {
+  std::string s;
+  for (std::size_t i = 0; i < nb_vectors; i++) {
+    s += std::to_string(i * 0.25) + "," + std::to_string(i * 0.5) + "," +
+         std::to_string(-1.5 * i) + "\n";
+  }
+  return s;
+}
+
+/** the old path: a stream per line, a std::vector per row*/
+BENCH(bm_text_iostream) {
+  const std::string s = text_input();
+  std::vector<VecN<real, 3>> out;
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    out.clear();
+    std::istringstream in(s);
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream fields(line);
+      std::vector<real> row;
+      std::string field;
+      while (std::getline(fields, field, ',')) {
+        row.push_back(std::stof(field));
+      }
+      out.push_back(VecN<real, 3>(row));
+    }
+    bench::do_not_optimize(out.data());
+  }
+}
+
+BENCH(bm_text_parse) {
+  const std::string s = text_input();
+  VecNArray<real, 3> out;
+  text::Stats st;
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result r = text::parse(s.data(), s.size(), out, st);
+    bench::do_not_optimize(r);
+  }
+}
+
+BENCH(bm_text_parse_pool) {
+  const std::string s = text_input();
+  VecNArray<real, 3> out;
+  text::Stats st;
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    Result r = text::parse(parallel::default_pool(), s.data(), s.size(), out,
+                           st);
+    bench::do_not_optimize(r);
+  }
+}
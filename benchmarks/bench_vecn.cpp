@@ -0,0 +1,176 @@
+// every public VecN operation for T in {float, double, int} and
+// N in {2, 3, 4, 8, 16, 64}, named bm_vecn_<op>_<type>_<N>
+#include "../vepp.hpp"
+#include "bench.hpp"
+
+using namespace vepp;
+
+namespace {
+
+/** operands are made opaque on every iteration so the compiler can not
+ * fold the constant inputs into the loop*/
+template <class T, unsigned int N, class Op>
+void bm_vec_op(bench::State &state) {
+  VecN<T, N> a(static_cast<T>(6)), b(static_cast<T>(2)), out(static_cast<T>(0));
+  state.set_elements(N);
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    Result r = Op::apply(a, b, out);
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(out);
+  }
+}
+template <class T, unsigned int N, class Op>
+void bm_scalar_op(bench::State &state) {
+  VecN<T, N> a(static_cast<T>(6)), out(static_cast<T>(0));
+  T s = static_cast<T>(2);
+  state.set_elements(N);
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(s);
+    Result r = Op::apply(a, s, out);
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(out);
+  }
+}
+
+struct Add {
+  template <class V, class A> static Result apply(const V &a, const A &b, V &o) {
+    return a.add(b, o);
+  }
+};
+struct Subtract {
+  template <class V, class A> static Result apply(const V &a, const A &b, V &o) {
+    return a.subtract(b, o);
+  }
+};
+struct Multiply {
+  template <class V, class A> static Result apply(const V &a, const A &b, V &o) {
+    return a.multiply(b, o);
+  }
+};
+struct Divide {
+  template <class V, class A> static Result apply(const V &a, const A &b, V &o) {
+    return a.divide(b, o);
+  }
+};
+
+template <class T, unsigned int N> void bm_dot(bench::State &state) {
+  VecN<T, N> a(static_cast<T>(3)), b(static_cast<T>(2));
+  T out = static_cast<T>(0);
+  state.set_elements(N);
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    bench::do_not_optimize(b);
+    Result r = a.dot(b, out);
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(out);
+  }
+}
+template <class T, unsigned int N> void bm_get(bench::State &state) {
+  VecN<T, N> a(static_cast<T>(3));
+  T out = static_cast<T>(0);
+  unsigned int i = 0;
+  state.set_elements(1);
+  while (state.keep_running()) {
+    bench::do_not_optimize(a);
+    Result r = a.get(i % N, out);
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(out);
+    i++;
+  }
+}
+template <class T, unsigned int N> void bm_set(bench::State &state) {
+  VecN<T, N> a(static_cast<T>(3));
+  unsigned int i = 0;
+  state.set_elements(1);
+  while (state.keep_running()) {
+    Result r = a.set(i % N, static_cast<T>(i));
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(a);
+    i++;
+  }
+}
+template <class T, unsigned int N> void bm_base(bench::State &state) {
+  VecN<T, N> out(static_cast<T>(0));
+  unsigned int i = 0;
+  state.set_elements(N);
+  while (state.keep_running()) {
+    Result r = VecN<T, N>::base(i % N, out);
+    bench::do_not_optimize(r);
+    bench::do_not_optimize(out);
+    i++;
+  }
+}
+template <class T, unsigned int N> void bm_ctor_scalar(bench::State &state) {
+  T s = static_cast<T>(3);
+  state.set_elements(N);
+  while (state.keep_running()) {
+    bench::do_not_optimize(s);
+    VecN<T, N> v(s);
+    bench::do_not_optimize(v);
+  }
+}
+template <class T, unsigned int N> void bm_ctor_array(bench::State &state) {
+  std::array<T, N> arr;
+  arr.fill(static_cast<T>(3));
+  state.set_elements(N);
+  while (state.keep_running()) {
+    bench::do_not_optimize(arr);
+    VecN<T, N> v(arr);
+    bench::do_not_optimize(v);
+  }
+}
+template <class T, unsigned int N> void bm_ctor_vector(bench::State &state) {
+  std::vector<T> vec(N, static_cast<T>(3));
+  state.set_elements(N);
+  while (state.keep_running()) {
+    bench::do_not_optimize(vec.data());
+    VecN<T, N> v(vec);
+    bench::do_not_optimize(v);
+  }
+}
+
+template <class T, unsigned int N> void register_all(const char *tname) {
+  const std::string suffix =
+      std::string("_") + tname + "_" + std::to_string(N);
+  bench::Registrar("bm_vecn_add" + suffix, bm_vec_op<T, N, Add>);
+  bench::Registrar("bm_vecn_subtract" + suffix, bm_vec_op<T, N, Subtract>);
+  bench::Registrar("bm_vecn_multiply" + suffix, bm_vec_op<T, N, Multiply>);
+  bench::Registrar("bm_vecn_divide" + suffix, bm_vec_op<T, N, Divide>);
+  bench::Registrar("bm_vecn_add_scalar" + suffix, bm_scalar_op<T, N, Add>);
+  bench::Registrar("bm_vecn_subtract_scalar" + suffix,
+                   bm_scalar_op<T, N, Subtract>);
+  bench::Registrar("bm_vecn_multiply_scalar" + suffix,
+                   bm_scalar_op<T, N, Multiply>);
+  bench::Registrar("bm_vecn_divide_scalar" + suffix,
+                   bm_scalar_op<T, N, Divide>);
+  bench::Registrar("bm_vecn_dot" + suffix, bm_dot<T, N>);
+  bench::Registrar("bm_vecn_get" + suffix, bm_get<T, N>);
+  bench::Registrar("bm_vecn_set" + suffix, bm_set<T, N>);
+  bench::Registrar("bm_vecn_base" + suffix, bm_base<T, N>);
+  bench::Registrar("bm_vecn_ctor_scalar" + suffix, bm_ctor_scalar<T, N>);
+  bench::Registrar("bm_vecn_ctor_array" + suffix, bm_ctor_array<T, N>);
+  bench::Registrar("bm_vecn_ctor_vector" + suffix, bm_ctor_vector<T, N>);
+}
+
+template <class T> void register_sizes(const char *tname) {
+  register_all<T, 2>(tname);
+  register_all<T, 3>(tname);
+  register_all<T, 4>(tname);
+  register_all<T, 8>(tname);
+  register_all<T, 16>(tname);
+  register_all<T, 64>(tname);
+}
+
+struct RegisterSweep {
+  RegisterSweep() {
+    register_sizes<float>("float");
+    register_sizes<double>("double");
+    register_sizes<int>("int");
+  }
+};
+RegisterSweep register_sweep;
+
+} // namespace
@@ -0,0 +1,91 @@
+// macro workloads: an n-body step and batched normalization
+#include "../vepp_array.hpp"
+#include "bench.hpp"
+#include <cmath>
+
+typedef float real;
+using namespace vepp;
+
+typedef VecN<real, 3> Vec3;
+
+static Vec3 sample3(unsigned int i) {
+  std::array<real, 3> arr = {{static_cast<real>(i % 17) - 8.0f,
+                              static_cast<real>(i % 13) * 0.5f - 3.0f,
+                              static_cast<real>(i % 7) + 0.25f}};
+  return Vec3(arr);
+}
+
+static const unsigned int nb_bodies = 256;
+
+/** one softened gravity step over all pairs, elements are interactions*/
+BENCH(bm_workload_nbody_step) {
+  std::vector<Vec3> pos(nb_bodies), vel(nb_bodies, Vec3(0));
+  for (unsigned int i = 0; i < nb_bodies; i++) {
+    pos[i] = sample3(i);
+  }
+  const real dt = 1e-4f, softening = 1e-2f;
+  state.set_elements(nb_bodies * nb_bodies);
+  while (state.keep_running()) {
+    for (unsigned int i = 0; i < nb_bodies; i++) {
+      Vec3 acc(0);
+      for (unsigned int j = 0; j < nb_bodies; j++) {
+        Vec3 d = pos[j] - pos[i];
+        real r2 = 0;
+        d.length_squared(r2);
+        r2 += softening;
+        acc = acc + d * (1 / (r2 * std::sqrt(r2)));
+      }
+      vel[i] = vel[i] + acc * dt;
+    }
+    for (unsigned int i = 0; i < nb_bodies; i++) {
+      pos[i] = pos[i] + vel[i] * dt;
+    }
+    bench::clobber_memory();
+  }
+  bench::do_not_optimize(pos.data());
+}
+
+static const unsigned int nb_vectors = 4096;
+
+/** normalizes an array of structures one VecN at a time*/
+BENCH(bm_workload_normalize_aos) {
+  std::vector<Vec3> in(nb_vectors), out(nb_vectors);
+  for (unsigned int i = 0; i < nb_vectors; i++) {
+    in[i] = sample3(i);
+  }
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    for (unsigned int i = 0; i < nb_vectors; i++) {
+      in[i].normalize(out[i]);
+    }
+    bench::clobber_memory();
+  }
+  bench::do_not_optimize(out.data());
+}
+
+/** normalizes a structure of arrays: squared lengths with the batched dot,
+ * then every lane is scaled by the inverse lengths*/
+BENCH(bm_workload_normalize_soa) {
+  std::vector<Vec3> aos(nb_vectors);
+  for (unsigned int i = 0; i < nb_vectors; i++) {
+    aos[i] = sample3(i);
+  }
+  VecNArray<real, 3> in, out(nb_vectors);
+  in.from_aos(aos);
+  std::vector<real> inv(nb_vectors);
+  state.set_elements(nb_vectors);
+  while (state.keep_running()) {
+    in.dot(in, inv);
+    for (unsigned int i = 0; i < nb_vectors; i++) {
+      inv[i] = 1 / std::sqrt(inv[i]);
+    }
+    for (unsigned int k = 0; k < 3; k++) {
+      const real *src = nullptr;
+      real *dst = nullptr;
+      in.lane(k, src);
+      out.lane(k, dst);
+      simd::multiply(src, inv.data(), dst, nb_vectors);
+    }
+    bench::clobber_memory();
+  }
+}
@@ -0,0 +1,234 @@
+// entry point of the vepp benchmark suite
+//
+// usage: vepp_bench [--filter=substring] [--min-time=seconds]
+//                   [--json=out.json] [--compare=baseline.json]
+//
+// --json writes the results so that a later run can be compared against
+// them with --compare, which adds the change of ns/op to every line.
+#include "../vepp_simd.hpp"
+#include "bench.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+
+static std::uint64_t g_allocations = 0;
+
+/** counts one allocation, align is 0 for the default new alignment*/
+static void *counted_allocate(std::size_t size, std::size_t align) noexcept {
+  g_allocations++;
+  if (size == 0) {
+    size = 1;
+  }
+  if (align == 0) {
+    return std::malloc(size);
+  }
+  // aligned_alloc wants a multiple of the alignment
+  return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+static void *counted_new(std::size_t size, std::size_t align) {
+  void *p = counted_allocate(size, align);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+// every replaceable form is counted, the over-aligned storage layouts
+// take the align_val_t ones
+void *operator new(std::size_t size) { return counted_new(size, 0); }
+void *operator new[](std::size_t size) { return counted_new(size, 0); }
+void *operator new(std::size_t size, std::align_val_t al) {
+  return counted_new(size, static_cast<std::size_t>(al));
+}
+void *operator new[](std::size_t size, std::align_val_t al) {
+  return counted_new(size, static_cast<std::size_t>(al));
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return counted_allocate(size, 0);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return counted_allocate(size, 0);
+}
+void *operator new(std::size_t size, std::align_val_t al,
+                   const std::nothrow_t &) noexcept {
+  return counted_allocate(size, static_cast<std::size_t>(al));
+}
+void *operator new[](std::size_t size, std::align_val_t al,
+                     const std::nothrow_t &) noexcept {
+  return counted_allocate(size, static_cast<std::size_t>(al));
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete(void *p, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+
+std::uint64_t bench::allocation_count() { return g_allocations; }
+
+namespace {
+
+struct Measure {
+  std::size_t iterations;
+  double seconds;
+  std::uint64_t allocations;
+  std::size_t elements;
+};
+
+Measure run_once(bench::bench_fn fn, std::size_t iterations) {
+  bench::State state(iterations);
+  std::uint64_t alloc_start = bench::allocation_count();
+  auto start = std::chrono::steady_clock::now();
+  fn(state);
+  auto stop = std::chrono::steady_clock::now();
+  Measure m;
+  m.iterations = iterations;
+  m.seconds = std::chrono::duration<double>(stop - start).count();
+  m.allocations = bench::allocation_count() - alloc_start;
+  m.elements = state.elements_per_iteration();
+  return m;
+}
+
+/** grows the iteration count until a run lasts at least min_time */
+Measure run(bench::bench_fn fn, double min_time) {
+  std::size_t iterations = 1;
+  Measure m = run_once(fn, iterations);
+  while (m.seconds < min_time && iterations < (std::size_t(1) << 34)) {
+    double scale = m.seconds > 0 ? (min_time * 1.4) / m.seconds : 100.0;
+    if (scale > 100.0)
+      scale = 100.0;
+    if (scale < 2.0)
+      scale = 2.0;
+    iterations = static_cast<std::size_t>(iterations * scale);
+    m = run_once(fn, iterations);
+  }
+  return m;
+}
+
+/** ns/op of every benchmark in a file written by --json, the writer puts
+ * one benchmark per line */
+std::map<std::string, double> read_baseline(const char *path) {
+  std::map<std::string, double> out;
+  FILE *f = std::fopen(path, "r");
+  if (f == nullptr) {
+    std::fprintf(stderr, "cannot read %s\n", path);
+    return out;
+  }
+  char line[1024];
+  while (std::fgets(line, sizeof(line), f) != nullptr) {
+    const char *name = std::strstr(line, "\"name\": \"");
+    const char *ns = std::strstr(line, "\"ns_per_op\": ");
+    if (name == nullptr || ns == nullptr)
+      continue;
+    name += 9;
+    const char *end = std::strchr(name, '"');
+    if (end == nullptr)
+      continue;
+    out[std::string(name, end)] = std::strtod(ns + 13, nullptr);
+  }
+  std::fclose(f);
+  return out;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  const char *filter = nullptr;
+  const char *json_path = nullptr;
+  const char *baseline_path = nullptr;
+  double min_time = 0.1;
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+      filter = argv[i] + 9;
+    } else if (std::strncmp(argv[i], "--min-time=", 11) == 0) {
+      min_time = std::atof(argv[i] + 11);
+    } else if (std::strncmp(argv[i], "--json=", 7) == 0) {
+      json_path = argv[i] + 7;
+    } else if (std::strncmp(argv[i], "--compare=", 10) == 0) {
+      baseline_path = argv[i] + 10;
+    }
+  }
+  std::map<std::string, double> baseline;
+  if (baseline_path != nullptr) {
+    baseline = read_baseline(baseline_path);
+  }
+  FILE *json = nullptr;
+  if (json_path != nullptr) {
+    json = std::fopen(json_path, "w");
+    if (json == nullptr) {
+      std::fprintf(stderr, "cannot write %s\n", json_path);
+      return 1;
+    }
+    std::fprintf(json,
+                 "{\n  \"context\": {\"isa\": \"%s\", \"min_time\": %g},\n"
+                 "  \"benchmarks\": [",
+                 vepp::simd::isa_name(vepp::simd::active_isa()), min_time);
+  }
+  std::printf("%-48s %14s %12s %14s %12s%s\n", "benchmark", "iterations",
+              "ns/op", "elements/s", "allocs/op",
+              baseline_path != nullptr ? "       change" : "");
+  bool first = true;
+  for (const bench::Entry &e : bench::registry()) {
+    if (filter != nullptr && std::strstr(e.name.c_str(), filter) == nullptr)
+      continue;
+    Measure m = run(e.fn, min_time);
+    double ns = m.seconds * 1e9 / static_cast<double>(m.iterations);
+    double allocs =
+        static_cast<double>(m.allocations) / static_cast<double>(m.iterations);
+    double eps = m.elements > 0 && ns > 0
+                     ? static_cast<double>(m.elements) * 1e9 / ns
+                     : 0.0;
+    char eps_text[32] = "-";
+    if (m.elements > 0) {
+      std::snprintf(eps_text, sizeof(eps_text), "%.4g", eps);
+    }
+    std::printf("%-48s %14zu %12.3f %14s %12.3f", e.name.c_str(),
+                m.iterations, ns, eps_text, allocs);
+    if (baseline_path != nullptr) {
+      std::map<std::string, double>::const_iterator it = baseline.find(e.name);
+      if (it != baseline.end() && it->second > 0) {
+        std::printf(" %+11.1f%%", (ns / it->second - 1.0) * 100.0);
+      } else {
+        std::printf(" %12s", "new");
+      }
+    }
+    std::printf("\n");
+    if (json != nullptr) {
+      std::fprintf(json,
+                   "%s\n    {\"name\": \"%s\", \"iterations\": %zu, "
+                   "\"ns_per_op\": %.6g, \"elements_per_second\": %.6g, "
+                   "\"allocs_per_op\": %.6g}",
+                   first ? "" : ",", e.name.c_str(), m.iterations, ns, eps,
+                   allocs);
+    }
+    first = false;
+  }
+  if (json != nullptr) {
+    std::fprintf(json, "\n  ]\n}\n");
+    std::fclose(json);
+  }
+  return 0;
+}
@@ -0,0 +1,259 @@
+// per call cost budgets for the vepp tests
+//
+// budget::measure runs a callable many times and reports the average heap
+// allocations, allocated bytes and, where the kernel grants
+// perf_event_open, user space instructions and cycles of one call. The
+// ASSERT_*_BUDGET macros fail the current ctest test when a measure goes
+// over its budget.
+//
+// Define BUDGET_MAIN in one translation unit of the test executable
+// before including this header, it then replaces every form of the global
+// operator new and operator delete, aligned and nothrow included, with
+// counting versions. Set BUDGET_NO_PERF in the environment to skip the
+// hardware counters.
+#ifndef BUDGET_HPP
+#define BUDGET_HPP
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <ctest.h>
+
+namespace budget {
+
+struct Counters {
+  std::uint64_t allocations;
+  std::uint64_t bytes;
+};
+
+/** heap traffic seen by the counting operator new*/
+inline Counters &counters() {
+  static Counters c = {0, 0};
+  return c;
+}
+
+/** keeps a value alive and opaque so a measured call is not folded away*/
+template <class T> inline void keep(T &value) {
+  asm volatile("" : "+m"(value) : : "memory");
+}
+
+/** user space hardware event counter, not available when the kernel or
+ * the virtual machine refuses perf_event_open*/
+class PerfCounter {
+  int fd;
+
+  PerfCounter(const PerfCounter &);
+  PerfCounter &operator=(const PerfCounter &);
+
+public:
+  explicit PerfCounter(std::uint64_t config) : fd(-1) {
+#if defined(__linux__)
+    if (std::getenv("BUDGET_NO_PERF") != nullptr)
+      return;
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+    (void)config;
+#endif
+  }
+  ~PerfCounter() {
+#if defined(__linux__)
+    if (fd >= 0)
+      close(fd);
+#endif
+  }
+  bool available() const { return fd >= 0; }
+  void start() {
+#if defined(__linux__)
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+  std::uint64_t stop() {
+    std::uint64_t value = 0;
+#if defined(__linux__)
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd, &value, sizeof(value)) != sizeof(value))
+        value = 0;
+    }
+#endif
+    return value;
+  }
+};
+
+/** average cost of one call, instructions and cycles are negative when
+ * the counters are not available*/
+struct Usage {
+  double allocations;
+  double bytes;
+  double instructions;
+  double cycles;
+};
+
+#if defined(__linux__)
+inline PerfCounter &instruction_counter() {
+  static PerfCounter c(PERF_COUNT_HW_INSTRUCTIONS);
+  return c;
+}
+inline PerfCounter &cycle_counter() {
+  static PerfCounter c(PERF_COUNT_HW_CPU_CYCLES);
+  return c;
+}
+#else
+inline PerfCounter &instruction_counter() {
+  static PerfCounter c(0);
+  return c;
+}
+inline PerfCounter &cycle_counter() { return instruction_counter(); }
+#endif
+
+/** runs fn once to warm up lazily initialized state, then calls times,
+ * and returns the average cost of one call*/
+template <class Fn> Usage measure(std::size_t calls, Fn fn) {
+  PerfCounter &ins = instruction_counter();
+  PerfCounter &cyc = cycle_counter();
+  fn();
+  Counters before = counters();
+  ins.start();
+  cyc.start();
+  for (std::size_t i = 0; i < calls; i++) {
+    fn();
+  }
+  std::uint64_t nb_cycles = cyc.stop();
+  std::uint64_t nb_instructions = ins.stop();
+  Counters after = counters();
+  const double n = static_cast<double>(calls);
+  Usage u;
+  u.allocations = static_cast<double>(after.allocations - before.allocations) / n;
+  u.bytes = static_cast<double>(after.bytes - before.bytes) / n;
+  u.instructions = ins.available() ? static_cast<double>(nb_instructions) / n
+                                   : -1.0;
+  u.cycles = cyc.available() ? static_cast<double>(nb_cycles) / n : -1.0;
+  return u;
+}
+
+} // namespace budget
+
+#define ASSERT_ALLOC_BUDGET(usage, max_allocations)                            \
+  do {                                                                         \
+    if ((usage).allocations > (max_allocations))                               \
+      CTEST_ERR("%s:%d %.2f allocations per call, budget %.2f", __FILE__,      \
+                __LINE__, (usage).allocations,                                 \
+                static_cast<double>(max_allocations));                         \
+  } while (0)
+
+/** skipped when the instruction counter is not available*/
+#define ASSERT_INSTRUCTION_BUDGET(usage, max_instructions)                     \
+  do {                                                                         \
+    if ((usage).instructions >= 0 &&                                           \
+        (usage).instructions > (max_instructions))                             \
+      CTEST_ERR("%s:%d %.1f instructions per call, budget %.1f", __FILE__,     \
+                __LINE__, (usage).instructions,                                \
+                static_cast<double>(max_instructions));                        \
+  } while (0)
+
+/** skipped when the cycle counter is not available*/
+#define ASSERT_CYCLE_BUDGET(usage, max_cycles)                                 \
+  do {                                                                         \
+    if ((usage).cycles >= 0 && (usage).cycles > (max_cycles))                  \
+      CTEST_ERR("%s:%d %.1f cycles per call, budget %.1f", __FILE__,           \
+                __LINE__, (usage).cycles, static_cast<double>(max_cycles));    \
+  } while (0)
+
+#ifdef BUDGET_MAIN
+namespace budget {
+/** counts one allocation, align is 0 for the default new alignment*/
+inline void *counted_allocate(std::size_t size, std::size_t align) noexcept {
+  Counters &c = counters();
+  c.allocations++;
+  c.bytes += size;
+  if (size == 0) {
+    size = 1;
+  }
+  if (align == 0) {
+    return std::malloc(size);
+  }
+  // aligned_alloc wants a multiple of the alignment
+  return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+inline void *counted_new(std::size_t size, std::size_t align) {
+  void *p = counted_allocate(size, align);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+} // namespace budget
+
+// every replaceable form is counted, an over-aligned type takes the
+// align_val_t ones
+void *operator new(std::size_t size) { return budget::counted_new(size, 0); }
+void *operator new[](std::size_t size) { return budget::counted_new(size, 0); }
+void *operator new(std::size_t size, std::align_val_t al) {
+  return budget::counted_new(size, static_cast<std::size_t>(al));
+}
+void *operator new[](std::size_t size, std::align_val_t al) {
+  return budget::counted_new(size, static_cast<std::size_t>(al));
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  return budget::counted_allocate(size, 0);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  return budget::counted_allocate(size, 0);
+}
+void *operator new(std::size_t size, std::align_val_t al,
+                   const std::nothrow_t &) noexcept {
+  return budget::counted_allocate(size, static_cast<std::size_t>(al));
+}
+void *operator new[](std::size_t size, std::align_val_t al,
+                     const std::nothrow_t &) noexcept {
+  return budget::counted_allocate(size, static_cast<std::size_t>(al));
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept {
+  std::free(p);
+}
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete(void *p, std::align_val_t,
+                     const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+void operator delete[](void *p, std::align_val_t,
+                       const std::nothrow_t &) noexcept {
+  std::free(p);
+}
+#endif
+
+#endif
@@ -0,0 +1,321 @@
+// test file for heap traffic and per call budgets of VecN methods
+#include "../vepp.hpp"
+#include "../vepp_memory.hpp"
+#define BUDGET_MAIN
+#include <budget.hpp>
+#include <ctest.h>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+static std::uint64_t allocations() { return budget::counters().allocations; }
+
+/*! @{ testing VecN output overloads do not allocate
+ */
+CTEST(suite, test_alloc_scalar_vecn_outputs) {
+  VecN<real, 5> v(2);
+  VecN<real, 5> out;
+  std::uint64_t before = allocations();
+  ASSERT_EQUAL(v.add(1, out).status, SUCCESS);
+  ASSERT_EQUAL(v.subtract(1, out).status, SUCCESS);
+  ASSERT_EQUAL(v.multiply(2, out).status, SUCCESS);
+  ASSERT_EQUAL(v.divide(2, out).status, SUCCESS);
+  ASSERT_EQUAL(v.apply_el(static_cast<real>(3),
+                          [](real a, real b) { return a * b; }, out)
+                   .status,
+               SUCCESS);
+  ASSERT_EQUAL(allocations() - before, 0);
+  real t = 0;
+  out.get(4, t);
+  ASSERT_EQUAL(t, static_cast<real>(6));
+}
+CTEST(suite, test_alloc_vecn_vecn_outputs) {
+  VecN<real, 5> v(2);
+  VecN<real, 5> w(4);
+  VecN<real, 5> out;
+  std::uint64_t before = allocations();
+  ASSERT_EQUAL(v.add(w, out).status, SUCCESS);
+  ASSERT_EQUAL(v.subtract(w, out).status, SUCCESS);
+  ASSERT_EQUAL(v.multiply(w, out).status, SUCCESS);
+  ASSERT_EQUAL(v.divide(w, out).status, SUCCESS);
+  ASSERT_EQUAL(
+      v.apply_el(w, [](real a, real b) { return a - b; }, out).status,
+      SUCCESS);
+  ASSERT_EQUAL(allocations() - before, 0);
+  real t = 0;
+  out.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(-2));
+}
+CTEST(suite, test_alloc_base_vecn) {
+  VecN<real, 6> vout(5);
+  std::uint64_t before = allocations();
+  typedef VecN<real, 6> Vec6;
+  ASSERT_EQUAL(Vec6::base(2, vout).status, SUCCESS);
+  ASSERT_EQUAL(Vec6::base(6, vout).status, ARG_ERROR);
+  ASSERT_EQUAL(allocations() - before, 0);
+  real t = 0;
+  vout.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(1));
+  vout.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(0));
+}
+CTEST(suite, test_alloc_failed_calls) {
+  VecN<real, 5> v(2);
+  VecN<real, 5> z(0);
+  VecN<real, 5> out;
+  real t = 0;
+  std::uint64_t before = allocations();
+  ASSERT_EQUAL(v.divide(0, out).status, ARG_ERROR);
+  ASSERT_EQUAL(v.divide(z, out).status, ARG_ERROR);
+  ASSERT_EQUAL(v.get(5, t).status, INDEX_ERROR);
+  ASSERT_EQUAL(allocations() - before, 0);
+}
+CTEST(suite, test_alloc_vector_output_reused) {
+  VecN<real, 5> v(2);
+  std::vector<real> out(5);
+  std::uint64_t before = allocations();
+  ASSERT_EQUAL(v.add(1, out).status, SUCCESS);
+  ASSERT_EQUAL(v.multiply(1, out).status, SUCCESS);
+  ASSERT_EQUAL(allocations() - before, 0);
+}
+
+/*! @} */
+
+/*! @{ testing per call budgets of every VecN method
+
+  Allocation budgets always apply. Instruction budgets only apply where
+  perf_event_open is available, they are loose upper bounds meant to
+  catch a call that stops inlining or starts looping over the heap, not
+  to pin the generated code.
+ */
+typedef VecN<real, 4> Vec4;
+
+CTEST(suite, test_budget_access) {
+  Vec4 v(2);
+  real t = 0;
+  unsigned int i = 0;
+  budget::Usage u = budget::measure(1000, [&]() {
+    budget::keep(v);
+    Result r = v.get(i++ & 3, t);
+    budget::keep(r);
+    budget::keep(t);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 40);
+  u = budget::measure(1000, [&]() {
+    Result r = v.set(i++ & 3, t);
+    budget::keep(r);
+    budget::keep(v);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 40);
+  u = budget::measure(1000, [&]() {
+    Result r = Vec4::base(i++ & 3, v);
+    budget::keep(r);
+    budget::keep(v);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 60);
+}
+CTEST(suite, test_budget_constructors) {
+  real s = 3;
+  std::array<real, 4> arr = {{1, 2, 3, 4}};
+  std::vector<real> vec(4, 2);
+  budget::Usage u = budget::measure(1000, [&]() {
+    budget::keep(s);
+    Vec4 v(s);
+    budget::keep(v);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 40);
+  u = budget::measure(1000, [&]() {
+    budget::keep(arr);
+    Vec4 v(arr);
+    budget::keep(v);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 40);
+  u = budget::measure(1000, [&]() {
+    Vec4 v(vec);
+    budget::keep(v);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 80);
+}
+CTEST(suite, test_budget_aligned_new) {
+  // over-aligned elements go through the align_val_t operator new
+  budget::Usage u = budget::measure(100, [&]() {
+    std::vector<VecNCacheLine<real, 3>> v(4);
+    budget::keep(v);
+  });
+  ASSERT_DBL_NEAR_TOL(u.allocations, 1.0, 1e-9);
+  ASSERT_DBL_NEAR_TOL(u.bytes, 4.0 * 64, 1e-9);
+  u = budget::measure(100, [&]() {
+    VecNCacheLine<real, 3> *p = new VecNCacheLine<real, 3>[2];
+    budget::keep(p);
+    delete[] p;
+  });
+  ASSERT_DBL_NEAR_TOL(u.allocations, 1.0, 1e-9);
+  u = budget::measure(100, [&]() {
+    Vec4 *p = new (std::nothrow) Vec4(1);
+    budget::keep(p);
+    delete p;
+  });
+  ASSERT_DBL_NEAR_TOL(u.allocations, 1.0, 1e-9);
+}
+CTEST(suite, test_budget_arithmetic) {
+  Vec4 a(6), b(2), out(0);
+  real s = 2;
+  Result (Vec4::*vec_ops[4])(const Vec4 &, Vec4 &) const = {
+      &Vec4::add, &Vec4::subtract, &Vec4::multiply, &Vec4::divide};
+  Result (Vec4::*scalar_ops[4])(real, Vec4 &) const = {
+      &Vec4::add, &Vec4::subtract, &Vec4::multiply, &Vec4::divide};
+  for (int op = 0; op < 4; op++) {
+    budget::Usage u = budget::measure(1000, [&]() {
+      budget::keep(a);
+      budget::keep(b);
+      Result r = (a.*vec_ops[op])(b, out);
+      budget::keep(r);
+      budget::keep(out);
+    });
+    ASSERT_ALLOC_BUDGET(u, 0);
+    ASSERT_INSTRUCTION_BUDGET(u, 80);
+    u = budget::measure(1000, [&]() {
+      budget::keep(a);
+      budget::keep(s);
+      Result r = (a.*scalar_ops[op])(s, out);
+      budget::keep(r);
+      budget::keep(out);
+    });
+    ASSERT_ALLOC_BUDGET(u, 0);
+    ASSERT_INSTRUCTION_BUDGET(u, 80);
+  }
+  // vector outputs of the right size are reused
+  std::vector<real> vout(4), vb(4, 2);
+  budget::Usage u = budget::measure(1000, [&]() {
+    Result r = a.add(vb, vout);
+    budget::keep(r);
+    r = a.divide(s, vout);
+    budget::keep(r);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 160);
+  // a stored std::function is passed without copies
+  std::function<real(real, real)> fn = [](real x, real y) { return x * y; };
+  u = budget::measure(1000, [&]() {
+    Result r = a.apply_el(b, fn, out);
+    budget::keep(r);
+    budget::keep(out);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+}
+CTEST(suite, test_budget_geometry) {
+  Vec4 a(3), b(2);
+  real t = 0;
+  budget::Usage u = budget::measure(1000, [&]() {
+    budget::keep(a);
+    budget::keep(b);
+    Result r = a.dot(b, t);
+    budget::keep(r);
+    budget::keep(t);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 60);
+  Vec4 n(0);
+  u = budget::measure(1000, [&]() {
+    budget::keep(a);
+    Result r = a.normalize(n);
+    budget::keep(r);
+    budget::keep(n);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 120);
+  VecN<real, 3> c(1), d(2), x(0);
+  d.set(0, 5);
+  u = budget::measure(1000, [&]() {
+    budget::keep(c);
+    budget::keep(d);
+    Result r = c.cross(d, x);
+    budget::keep(r);
+    budget::keep(x);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 60);
+}
+CTEST(suite, test_budget_failures) {
+  // failed preconditions report through Result without touching the heap
+  Vec4 a(3), z(0), out(0);
+  real t = 0;
+  budget::Usage u = budget::measure(1000, [&]() {
+    Result r = a.divide(z, out);
+    budget::keep(r);
+    r = a.get(7, t);
+    budget::keep(r);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  ASSERT_INSTRUCTION_BUDGET(u, 100);
+}
+
+/*! @} */
+
+/*! @{ testing arena backed outputs
+ */
+CTEST(suite, test_alloc_arena) {
+  Arena arena(1024);
+  char *a = static_cast<char *>(arena.allocate(3, 1));
+  double *d = static_cast<double *>(arena.allocate(sizeof(double), 64));
+  ASSERT_TRUE(reinterpret_cast<std::uintptr_t>(d) % 64 == 0);
+  ASSERT_TRUE(reinterpret_cast<char *>(d) > a);
+  ASSERT_EQUAL(arena.blocks(), 1);
+  // larger than a block, gets a block of its own
+  void *big = arena.allocate(4096, 16);
+  ASSERT_TRUE(big != nullptr);
+  ASSERT_EQUAL(arena.blocks(), 2);
+  // the last allocation is given back, earlier ones wait for reset
+  arena.deallocate(big, 4096);
+  ASSERT_TRUE(arena.allocate(4096, 16) == big);
+  arena.reset();
+  ASSERT_TRUE(arena.allocate(3, 1) == a);
+  ASSERT_EQUAL(arena.blocks(), 2);
+  ASSERT_EQUAL(arena.capacity(), 1024 + 4096 + 16);
+}
+CTEST(suite, test_alloc_arena_outputs) {
+  VecN<real, 5> v(2);
+  std::vector<real> in(5, 4);
+  Arena arena;
+  ArenaAllocator<real> alloc(arena);
+  // one request: temporaries of every vector output overload
+  auto request = [&]() {
+    ArenaVector<real> s(alloc), t(alloc), u(alloc), b(alloc), n(alloc);
+    Result r = v.add(1, s);
+    r = v.subtract(in, t);
+    r = v.apply_el(in, [](real x, real y) { return x * y; }, u);
+    r = VecN<real, 5>::base(5, 3, b);
+    r = v.normalize(n);
+    real d = 0;
+    v.dot(s, d);
+    return d + t[0] + u[1] + b[3] + n[4];
+  };
+  real first = request();
+  ASSERT_EQUAL(first, static_cast<real>(30 - 2 + 8 + 1) +
+                          static_cast<real>(1 / std::sqrt(5.0)));
+  arena.reset();
+  // later requests reuse the blocks of the first one
+  std::uint64_t before = allocations();
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQUAL(request(), first);
+    arena.reset();
+  }
+  ASSERT_EQUAL(allocations() - before, 0);
+  ASSERT_EQUAL(arena.blocks(), 1);
+  // the default ArenaAllocator draws from the calling thread's arena
+  ArenaVector<real> w;
+  ASSERT_EQUAL(v.multiply(3, w).status, SUCCESS);
+  ASSERT_TRUE(w.get_allocator().arena == &thread_arena());
+  ASSERT_EQUAL(w[2], 6);
+}
+
+/*! @} */
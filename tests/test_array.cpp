@@ -0,0 +1,203 @@
+// test file for the structure of arrays container
+#include "../vepp_array.hpp"
+#include <ctest.h>
+#include <cstdint>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+static VecN<real, 3> make3(real a, real b, real c) {
+  std::array<real, 3> arr = {{a, b, c}};
+  return VecN<real, 3>(arr);
+}
+
+static std::vector<VecN<real, 3>> make_aos(std::size_t n) {
+  std::vector<VecN<real, 3>> vs;
+  for (std::size_t i = 0; i < n; i++) {
+    real f = static_cast<real>(i);
+    vs.push_back(make3(f, f + 1, f + 2));
+  }
+  return vs;
+}
+
+/*! @{ testing construction and conversion
+ */
+CTEST(suite, test_array_empty_constructor) {
+  VecNArray<real, 3> arr;
+  std::size_t n = 5;
+  ASSERT_EQUAL(arr.size(n).status, SUCCESS);
+  ASSERT_EQUAL(n, static_cast<std::size_t>(0));
+}
+CTEST(suite, test_array_size_constructor) {
+  VecNArray<real, 4> arr(10);
+  std::size_t n = 0;
+  arr.size(n);
+  ASSERT_EQUAL(n, static_cast<std::size_t>(10));
+  VecN<real, 4> v;
+  ASSERT_EQUAL(arr.get(9, v).status, SUCCESS);
+  real t = 1;
+  v.get(3, t);
+  ASSERT_EQUAL(t, static_cast<real>(0));
+  ASSERT_EQUAL(arr.get(10, v).status, INDEX_ERROR);
+}
+CTEST(suite, test_array_resize_zero_fills) {
+  VecNArray<real, 2> arr(4, 3);
+  arr.resize(2);
+  arr.resize(6);
+  VecN<real, 2> v;
+  real t = 1;
+  arr.get(1, v);
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(3));
+  arr.get(5, v);
+  v.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(0));
+  ASSERT_EQUAL(arr.resize_for_overwrite(8).status, SUCCESS);
+  std::size_t n = 0;
+  arr.size(n);
+  ASSERT_EQUAL(n, static_cast<std::size_t>(8));
+}
+CTEST(suite, test_array_lane_alignment) {
+  VecNArray<real, 3> arr(33);
+  for (unsigned int k = 0; k < 3; k++) {
+    real *p = nullptr;
+    ASSERT_EQUAL(arr.lane(k, p).status, SUCCESS);
+    ASSERT_EQUAL(reinterpret_cast<std::uintptr_t>(p) % 64,
+                 static_cast<std::uintptr_t>(0));
+  }
+  real *p = nullptr;
+  ASSERT_EQUAL(arr.lane(3, p).status, INDEX_ERROR);
+}
+CTEST(suite, test_array_aos_roundtrip) {
+  std::vector<VecN<real, 3>> vs = make_aos(17);
+  VecNArray<real, 3> arr;
+  ASSERT_EQUAL(arr.from_aos(vs).status, SUCCESS);
+  const real *ys = nullptr;
+  arr.lane(1, ys);
+  ASSERT_EQUAL(ys[5], static_cast<real>(6));
+  std::vector<VecN<real, 3>> back;
+  ASSERT_EQUAL(arr.to_aos(back).status, SUCCESS);
+  ASSERT_EQUAL(back.size(), static_cast<std::size_t>(17));
+  real t = 0;
+  back[16].get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(18));
+}
+CTEST(suite, test_array_interleaved_roundtrip) {
+  std::vector<real> raw = {1, 2, 3, 4, 5, 6};
+  VecNArray<real, 3> arr;
+  arr.from_aos(raw.data(), 2);
+  VecN<real, 3> v;
+  arr.get(1, v);
+  real t = 0;
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(4));
+  std::vector<real> back(6);
+  arr.to_aos(back.data());
+  ASSERT_EQUAL(back[5], static_cast<real>(6));
+  ASSERT_EQUAL(arr.set(0, make3(7, 8, 9)).status, SUCCESS);
+  arr.to_aos(back.data());
+  ASSERT_EQUAL(back[1], static_cast<real>(8));
+}
+
+/*! @} */
+
+/*! @{ testing bulk arithmetic
+ */
+CTEST(suite, test_array_add_subtract) {
+  VecNArray<real, 3> a, b, out;
+  a.from_aos(make_aos(20));
+  b.from_aos(make_aos(20));
+  ASSERT_EQUAL(a.add(b, out).status, SUCCESS);
+  VecN<real, 3> v;
+  out.get(19, v);
+  real t = 0;
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(38));
+  ASSERT_EQUAL(out.subtract(b, out).status, SUCCESS);
+  out.get(19, v);
+  v.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(21));
+  ASSERT_EQUAL(a.add(1, out).status, SUCCESS);
+  out.get(0, v);
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(1));
+  VecNArray<real, 3> c(3);
+  ASSERT_EQUAL(a.add(c, out).status, SIZE_ERROR);
+}
+CTEST(suite, test_array_multiply_divide) {
+  VecNArray<real, 3> a(8, 6), b(8, 2), out;
+  ASSERT_EQUAL(a.divide(b, out).status, SUCCESS);
+  VecN<real, 3> v;
+  out.get(7, v);
+  real t = 0;
+  v.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(3));
+  ASSERT_EQUAL(a.multiply(2, out).status, SUCCESS);
+  out.get(3, v);
+  v.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(12));
+  ASSERT_EQUAL(a.divide(3, out).status, SUCCESS);
+  ASSERT_EQUAL(a.divide(0, out).status, ARG_ERROR);
+  b.set(5, make3(1, 0, 1));
+  ASSERT_EQUAL(a.divide(b, out).status, ARG_ERROR);
+  // the sizes are checked before the divisor is scanned for zeros
+  VecNArray<real, 3> shorter(4, 0);
+  ASSERT_EQUAL(a.divide(shorter, out).status, SIZE_ERROR);
+}
+CTEST(suite, test_array_dot) {
+  VecNArray<real, 3> a, b;
+  a.from_aos(make_aos(10));
+  b.from_aos(make_aos(10));
+  std::vector<real> out;
+  ASSERT_EQUAL(a.dot(b, out).status, SUCCESS);
+  ASSERT_EQUAL(out.size(), static_cast<std::size_t>(10));
+  // 2*2 + 3*3 + 4*4
+  ASSERT_EQUAL(out[2], static_cast<real>(29));
+  ASSERT_EQUAL(a.dot(make3(1, 0, -1), out).status, SUCCESS);
+  ASSERT_EQUAL(out[9], static_cast<real>(-2));
+}
+
+CTEST(suite, test_array_inplace_fused) {
+  VecNArray<real, 3> pos, vel, out;
+  pos.from_aos(make_aos(37));
+  vel.from_aos(make_aos(37));
+  ASSERT_EQUAL(pos.add_inplace(vel).status, SUCCESS);
+  ASSERT_EQUAL(pos.multiply_inplace(static_cast<real>(0.5)).status, SUCCESS);
+  VecN<real, 3> v;
+  real t = 0;
+  pos.get(36, v);
+  v.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(37));
+  ASSERT_EQUAL(pos.add_inplace(static_cast<real>(1)).status, SUCCESS);
+  ASSERT_EQUAL(pos.divide_inplace(vel).status, ARG_ERROR);
+  ASSERT_EQUAL(pos.axpy(static_cast<real>(2), vel).status, SUCCESS);
+  pos.get(36, v);
+  v.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(112));
+  ASSERT_EQUAL(pos.axpby(static_cast<real>(1), vel, static_cast<real>(-1))
+                   .status,
+               SUCCESS);
+  pos.get(36, v);
+  v.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(-75));
+  ASSERT_EQUAL(pos.axpy(vel, vel).status, SUCCESS);
+  pos.get(2, v);
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(-1));
+  ASSERT_EQUAL(vel.fma(vel, vel, out).status, SUCCESS);
+  out.get(3, v);
+  v.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(30));
+  ASSERT_EQUAL(vel.fma(static_cast<real>(2), vel, out).status, SUCCESS);
+  out.get(3, v);
+  v.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(15));
+  VecNArray<real, 3> shorter(4);
+  ASSERT_EQUAL(pos.axpy(static_cast<real>(1), shorter).status, SIZE_ERROR);
+  ASSERT_EQUAL(vel.fma(vel, shorter, out).status, SIZE_ERROR);
+}
+
+/*! @} */
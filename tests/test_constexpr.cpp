@@ -0,0 +1,108 @@
+// test file for constant expression support of VecN
+#include "../vepp.hpp"
+#include <ctest.h>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+typedef VecN<real, 3> Vec3;
+typedef VecN<int, 4> Vec4i;
+
+/*! @{ testing compile time construction
+ */
+constexpr Vec3 ones(static_cast<real>(1));
+constexpr Vec3 ex = Vec3::base<0>();
+constexpr Vec3 ey = Vec3::base<1>();
+constexpr Vec4i iota4(std::array<int, 4>{{1, 2, 3, 4}});
+
+static_assert(ones.eval(2) == 1, "scalar constructor");
+static_assert(ex.eval(0) == 1 && ex.eval(1) == 0 && ex.eval(2) == 0,
+              "basis vector");
+static_assert(ey.eval(1) == 1, "basis vector");
+static_assert(iota4.eval(3) == 4, "array constructor");
+
+constexpr real get_el(const Vec3 &v, unsigned int i) {
+  real t = 0;
+  v.get(i, t);
+  return t;
+}
+constexpr status_t get_status(const Vec3 &v, unsigned int i) {
+  real t = 0;
+  return v.get(i, t).status;
+}
+static_assert(get_el(ey, 1) == 1, "checked get");
+static_assert(get_status(ey, 3) == INDEX_ERROR, "checked get bounds");
+
+CTEST(suite, test_constexpr_construction) {
+  real t = 0;
+  ey.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(1));
+  Vec3 out = ones;
+  Result res = Vec3::base(3, out);
+  ASSERT_EQUAL(res.status, ARG_ERROR);
+}
+
+/*! @} */
+
+/*! @{ testing compile time arithmetic
+ */
+constexpr Vec4i ivec = iota4 * 2 + iota4 - 1;
+static_assert(ivec.eval(0) == 2 && ivec.eval(3) == 11, "operators");
+
+constexpr Vec3 sum = ex + ey * static_cast<real>(2);
+static_assert(sum.eval(0) == 1 && sum.eval(1) == 2 && sum.eval(2) == 0,
+              "operators");
+
+constexpr int add_el(int i) {
+  Vec4i out(0);
+  iota4.add(iota4, out);
+  out.multiply(3, out);
+  return out.eval(i);
+}
+static_assert(add_el(1) == 12, "Result methods");
+
+constexpr status_t divide_zero() {
+  Vec4i out(0);
+  return iota4.divide(Vec4i(0), out).status;
+}
+static_assert(divide_zero() == ARG_ERROR, "checked division");
+
+CTEST(suite, test_constexpr_arithmetic) {
+  ASSERT_EQUAL(ivec.eval(1), 5);
+  ASSERT_EQUAL(add_el(3), 24);
+}
+
+/*! @} */
+
+/*! @{ testing compile time dot product
+ */
+constexpr int dot4(const Vec4i &a, const Vec4i &b) {
+  int out = 0;
+  a.dot(b, out);
+  return out;
+}
+static_assert(dot4(iota4, iota4) == 30, "dot");
+static_assert(dot4(iota4, Vec4i::base<2>()) == 3, "dot with basis");
+
+constexpr real dot3(const Vec3 &a, const Vec3 &b) {
+  real out = 0;
+  a.dot(b, out);
+  return out;
+}
+static_assert(dot3(ex, ey) == 0, "orthogonal basis");
+static_assert(dot3(sum, ones) == 3, "dot");
+
+CTEST(suite, test_constexpr_dot_matches_runtime) {
+  // the runtime call goes through the SIMD kernels
+  Vec4i a = iota4;
+  int out = 0;
+  a.dot(iota4, out);
+  ASSERT_EQUAL(out, dot4(iota4, iota4));
+}
+
+/*! @} */
+
+/*! @} */
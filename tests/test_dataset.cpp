@@ -0,0 +1,181 @@
+// test file for the binary vector datasets
+#include "../vepp_dataset.hpp"
+#include <ctest.h>
+#include <cstdio>
+#include <fstream>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+static const char *aos_path = "test_dataset_aos.bin";
+static const char *soa_path = "test_dataset_soa.bin";
+
+/** vector i is (i, 2 i, -i)*/
+static VecN<real, 3> expected(std::size_t i) {
+  real x = static_cast<real>(i);
+  return VecN<real, 3>(std::array<real, 3>{x, 2 * x, -x});
+}
+
+/** writes n vectors in three batches of each kind*/
+static void write_dataset(const char *path, dataset::layout_t layout,
+                          std::size_t n) {
+  dataset::Writer<real, 3> w;
+  ASSERT_EQUAL(w.open(path, layout, n).status, SUCCESS);
+  const std::size_t a = n / 3, b = n / 2;
+  VecNArray<real, 3> first(a);
+  for (std::size_t i = 0; i < a; i++) {
+    first.set(i, expected(i));
+  }
+  ASSERT_EQUAL(w.append(first).status, SUCCESS);
+  std::vector<VecN<real, 3>> second;
+  for (std::size_t i = a; i < b; i++) {
+    second.push_back(expected(i));
+  }
+  ASSERT_EQUAL(w.append(second).status, SUCCESS);
+  std::vector<real> third;
+  for (std::size_t i = b; i < n; i++) {
+    for (unsigned int k = 0; k < 3; k++) {
+      third.push_back(expected(i).eval(k));
+    }
+  }
+  ASSERT_EQUAL(w.append(third.data(), n - b).status, SUCCESS);
+  std::size_t count = 0;
+  w.size(count);
+  ASSERT_EQUAL(count, n);
+  ASSERT_EQUAL(w.close().status, SUCCESS);
+}
+
+/** every vector read back through a view and as a copy*/
+static void check_dataset(const char *path, dataset::layout_t layout,
+                          std::size_t n) {
+  dataset::Reader<real, 3> r;
+  ASSERT_EQUAL(r.open(path).status, SUCCESS);
+  std::size_t count = 0;
+  r.size(count);
+  ASSERT_EQUAL(count, n);
+  dataset::layout_t l = dataset::AOS;
+  r.layout(l);
+  ASSERT_EQUAL(l, layout);
+  ASSERT_EQUAL(r.verify().status, SUCCESS);
+  ConstVecNView<real, 3> v(nullptr);
+  for (std::size_t i = 0; i < n; i++) {
+    ASSERT_EQUAL(r.get(i, v).status, SUCCESS);
+    for (unsigned int k = 0; k < 3; k++) {
+      ASSERT_EQUAL(v.eval(k), expected(i).eval(k));
+    }
+  }
+  ASSERT_EQUAL(r.get(n, v).status, INDEX_ERROR);
+  VecN<real, 3> c;
+  ASSERT_EQUAL(r.get(n - 1, c).status, SUCCESS);
+  ASSERT_EQUAL(c.eval(1), expected(n - 1).eval(1));
+  VecNArray<real, 3> all;
+  ASSERT_EQUAL(r.read(all).status, SUCCESS);
+  all.size(count);
+  ASSERT_EQUAL(count, n);
+  all.get(n / 2, c);
+  ASSERT_EQUAL(c.eval(2), expected(n / 2).eval(2));
+}
+
+/*! @{ testing the checksum
+ */
+CTEST(suite, test_dataset_checksum) {
+  unsigned char bytes[203];
+  for (unsigned int i = 0; i < sizeof(bytes); i++) {
+    bytes[i] = static_cast<unsigned char>(i * 7 + 1);
+  }
+  dataset::Checksum one;
+  one.update(bytes, sizeof(bytes));
+  // any split of the bytes gives the same hash
+  const std::size_t splits[] = {1, 3, 8, 13, 32, 37, 100};
+  for (std::size_t split : splits) {
+    dataset::Checksum two;
+    two.update(bytes, split);
+    two.update(bytes + split, sizeof(bytes) - split);
+    ASSERT_TRUE(one.value() == two.value());
+  }
+  // a flipped bit and a zero appended change it
+  dataset::Checksum flipped, longer;
+  bytes[150] ^= 4;
+  flipped.update(bytes, sizeof(bytes));
+  ASSERT_TRUE(flipped.value() != one.value());
+  bytes[150] ^= 4;
+  unsigned char zero = 0;
+  longer.update(bytes, sizeof(bytes));
+  longer.update(&zero, 1);
+  ASSERT_TRUE(longer.value() != one.value());
+}
+
+/*! @{ testing write and read in both layouts
+ */
+CTEST(suite, test_dataset_roundtrip) {
+  write_dataset(aos_path, dataset::AOS, 1000);
+  check_dataset(aos_path, dataset::AOS, 1000);
+  dataset::Reader<real, 3> r;
+  r.open(aos_path);
+  const real *el = nullptr;
+  ASSERT_EQUAL(r.elements(el).status, SUCCESS);
+  ASSERT_EQUAL(el[3 * 10 + 1], 20);
+  ASSERT_EQUAL(r.lane(0, el).status, ARG_ERROR);
+
+  write_dataset(soa_path, dataset::SOA, 1000);
+  check_dataset(soa_path, dataset::SOA, 1000);
+  r.open(soa_path);
+  ASSERT_EQUAL(r.lane(2, el).status, SUCCESS);
+  ASSERT_EQUAL(el[10], -10);
+  // lanes start on 64 byte boundaries
+  ASSERT_EQUAL(reinterpret_cast<std::uintptr_t>(el) % 64, 0);
+  ASSERT_EQUAL(r.elements(el).status, ARG_ERROR);
+  ASSERT_EQUAL(r.lane(3, el).status, INDEX_ERROR);
+  r.close();
+  std::remove(aos_path);
+  std::remove(soa_path);
+}
+
+/*! @{ testing large batches that bypass the staging buffer
+ */
+CTEST(suite, test_dataset_large_batch) {
+  const std::size_t n = dataset::Writer<real, 3>::buffer_bytes / 4;
+  write_dataset(aos_path, dataset::AOS, n);
+  check_dataset(aos_path, dataset::AOS, n);
+  std::remove(aos_path);
+}
+
+/*! @{ testing rejected files
+ */
+CTEST(suite, test_dataset_errors) {
+  dataset::Reader<real, 3> r;
+  ASSERT_EQUAL(r.open("test_dataset_missing.bin").status, IO_ERROR);
+  dataset::Writer<real, 3> w;
+  ASSERT_EQUAL(w.open(soa_path, dataset::SOA).status, ARG_ERROR);
+  ASSERT_EQUAL(w.open(soa_path, dataset::SOA, 4).status, SUCCESS);
+  std::vector<VecN<real, 3>> five(5, VecN<real, 3>(1));
+  ASSERT_EQUAL(w.append(five).status, SIZE_ERROR);
+  // an unclosed file has no header yet
+  ASSERT_EQUAL(r.open(soa_path).status, FORMAT_ERROR);
+  w.close();
+  ASSERT_EQUAL(r.open(soa_path).status, SUCCESS);
+  // another element type or dimension
+  dataset::Reader<double, 3> rd;
+  ASSERT_EQUAL(rd.open(soa_path).status, ARG_ERROR);
+  dataset::Reader<real, 4> r4;
+  ASSERT_EQUAL(r4.open(soa_path).status, ARG_ERROR);
+
+  write_dataset(aos_path, dataset::AOS, 100);
+  {
+    // a corrupted element opens, verify catches it
+    std::fstream f(aos_path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(64 + 17);
+    f.put(0x55);
+  }
+  ASSERT_EQUAL(r.open(aos_path).status, SUCCESS);
+  ASSERT_EQUAL(r.verify().status, FORMAT_ERROR);
+  r.close();
+  // a truncated file does not open
+  ASSERT_EQUAL(::truncate(aos_path, 64 + 99 * 3 * sizeof(real)), 0);
+  ASSERT_EQUAL(r.open(aos_path).status, FORMAT_ERROR);
+  std::remove(aos_path);
+  std::remove(soa_path);
+}
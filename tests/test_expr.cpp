@@ -0,0 +1,119 @@
+// test file for VecN operators and expression templates
+#include "../vepp.hpp"
+#include <ctest.h>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+static VecN<real, 3> make3(real a, real b, real c) {
+  std::array<real, 3> arr = {{a, b, c}};
+  return VecN<real, 3>(arr);
+}
+
+/*! @{ testing vector operators
+ */
+CTEST(suite, test_expr_vector_operators) {
+  VecN<real, 3> a = make3(1, 2, 3);
+  VecN<real, 3> b = make3(4, 5, 6);
+  VecN<real, 3> out = a + b;
+  real t = 0;
+  out.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(9));
+  out = b - a;
+  out.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(3));
+  out = a * b;
+  out.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(10));
+  out = b / a;
+  out.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(4));
+}
+CTEST(suite, test_expr_scalar_operators) {
+  VecN<real, 3> a = make3(2, 4, 8);
+  VecN<real, 3> out = a * 2;
+  real t = 0;
+  out.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(16));
+  out = 2 * a;
+  out.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(4));
+  out = a / 2;
+  out.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  out = 16 / a;
+  out.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  out = a + 1;
+  out.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(3));
+  out = 1 - a;
+  out.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(-1));
+}
+
+/*! @} */
+
+/*! @{ testing compound expressions
+ */
+CTEST(suite, test_expr_compound_matches_methods) {
+  VecN<real, 3> a = make3(1, -2, 3);
+  VecN<real, 3> b = make3(0.5f, 4, -1);
+  VecN<real, 3> c = make3(2, 2, 2);
+  real s = 3;
+  VecN<real, 3> fused = a * s + b - c;
+
+  VecN<real, 3> t1, t2, chained;
+  a.multiply(s, t1);
+  t1.add(b, t2);
+  t2.subtract(c, chained);
+  for (unsigned int i = 0; i < 3; i++) {
+    real x = 0, y = 0;
+    fused.get(i, x);
+    chained.get(i, y);
+    ASSERT_EQUAL(x, y);
+  }
+}
+CTEST(suite, test_expr_aliased_assignment) {
+  VecN<real, 3> a = make3(1, 2, 3);
+  VecN<real, 3> b = make3(1, 1, 1);
+  a = a + b * a;
+  real t = 0;
+  a.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(6));
+}
+CTEST(suite, test_expr_mixed_policies) {
+  VecNUnchecked<real, 3> a(2);
+  VecN<real, 3> b(3);
+  VecN<real, 3> out = a * b;
+  real t = 0;
+  ASSERT_EQUAL(out.get(1, t).status, SUCCESS);
+  ASSERT_EQUAL(t, static_cast<real>(6));
+}
+
+CTEST(suite, test_expr_compound_assignment) {
+  VecN<real, 3> pos = make3(1, 2, 3);
+  VecN<real, 3> vel = make3(2, 0, -2);
+  real dt = 0.5f;
+  pos += vel * dt;
+  real t = 0;
+  pos.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  pos.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  pos -= 1.0f;
+  pos *= vel;
+  pos.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  pos /= 2.0f;
+  pos.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(-1));
+  pos += pos;
+  pos.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(-2));
+}
+
+/*! @} */
@@ -0,0 +1,138 @@
+// test file for the text output
+#include "../vepp_format.hpp"
+#include "../vepp_half.hpp"
+#include "../vepp_text.hpp"
+#include <ctest.h>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+/*! @{
+ */
+
+using namespace vepp;
+
+/** values without a short decimal form*/
+static VecNArray<double, 3> awkward(std::size_t n) {
+  VecNArray<double, 3> a(n);
+  for (std::size_t i = 0; i < n; i++) {
+    a.set(i, VecN<double, 3>(std::array<double, 3>{
+                 0.1 * i, 1.0 / (i + 3), -1e-300 * (i + 1)}));
+  }
+  return a;
+}
+
+static std::string formatted(const VecN<float, 3> &v,
+                             const text::Style &s = text::Style()) {
+  char buf[128];
+  std::size_t w = 0;
+  text::format(v, buf, sizeof(buf), w, s);
+  return std::string(buf, w);
+}
+
+/*! @{ testing single vectors
+ */
+CTEST(suite, test_format_vector) {
+  VecN<float, 3> v(std::array<float, 3>{0.1f, -2, 1e20f});
+  ASSERT_STR(formatted(v).c_str(), "0.1, -2, 1e+20");
+  text::Style s;
+  s.separator = ";";
+  s.open = "[";
+  s.close = "]";
+  s.precision = 3;
+  VecN<float, 3> third(1.0f / 3);
+  ASSERT_STR(formatted(third, s).c_str(), "[0.333;0.333;0.333]");
+  // integers ignore the precision, half goes through float
+  char buf[64];
+  std::size_t w = 0;
+  ASSERT_EQUAL(text::format(VecN<int, 2>(-17), buf, sizeof(buf), w, s).status,
+               SUCCESS);
+  ASSERT_STR(std::string(buf, w).c_str(), "[-17;-17]");
+  text::format(VecNHalf<2>(1.5f), buf, sizeof(buf), w);
+  ASSERT_STR(std::string(buf, w).c_str(), "1.5, 1.5");
+  // expressions are evaluated as they are written
+  VecN<float, 3> one(1);
+  text::format(one + one * 2.0f, buf, sizeof(buf), w);
+  ASSERT_STR(std::string(buf, w).c_str(), "3, 3, 3");
+  // a buffer one byte short
+  ASSERT_EQUAL(text::format(v, buf, 13, w).status, SIZE_ERROR);
+  ASSERT_EQUAL(w, 0);
+  ASSERT_EQUAL(text::format(v, buf, 14, w).status, SUCCESS);
+}
+CTEST(suite, test_format_ostream) {
+  std::ostringstream out;
+  VecN<double, 2> v(std::array<double, 2>{0.5, 0.1});
+  out << v << ' ' << v * 2.0;
+  ASSERT_STR(out.str().c_str(), "(0.5, 0.1) (1, 0.2)");
+  // longer than the stack buffer
+  std::ostringstream big;
+  big << VecN<double, 64>(1.0 / 3);
+  ASSERT_EQUAL(big.str().size(), 2 + 64 * 18 + 63 * 2);
+}
+
+/*! @{ testing batches
+ */
+CTEST(suite, test_format_batch_roundtrip) {
+  const std::size_t n = 1000;
+  VecNArray<double, 3> a = awkward(n);
+  // a small buffer takes several calls, each ends on a whole line
+  std::string all;
+  std::vector<char> buf(500);
+  std::size_t next = 0, calls = 0;
+  while (next < n) {
+    std::size_t w = 0;
+    ASSERT_EQUAL(text::format(a, next, buf.data(), buf.size(), w).status,
+                 SUCCESS);
+    ASSERT_EQUAL(buf[w - 1], '\n');
+    all.append(buf.data(), w);
+    calls++;
+  }
+  ASSERT_TRUE(calls > 10);
+  // the shortest round trip text parses back to the same bits
+  VecNArray<double, 3> back;
+  text::Stats st;
+  ASSERT_EQUAL(text::parse(all.data(), all.size(), back, st).status,
+               SUCCESS);
+  ASSERT_EQUAL(st.vectors, n);
+  VecN<double, 3> x, y;
+  for (std::size_t i = 0; i < n; i++) {
+    a.get(i, x);
+    back.get(i, y);
+    for (unsigned int k = 0; k < 3; k++) {
+      ASSERT_TRUE(x.eval(k) == y.eval(k));
+    }
+  }
+  std::size_t w = 0;
+  next = 0;
+  ASSERT_EQUAL(text::format(a, next, buf.data(), 10, w).status, SIZE_ERROR);
+  ASSERT_EQUAL(next, 0);
+  next = n;
+  ASSERT_EQUAL(text::format(a, next, buf.data(), 10, w).status, SUCCESS);
+  ASSERT_EQUAL(w, 0);
+}
+CTEST(suite, test_format_writer) {
+  const std::size_t n = 50000;
+  VecNArray<double, 3> a = awkward(n);
+  std::FILE *f = std::tmpfile();
+  ASSERT_TRUE(f != nullptr);
+  {
+    text::Writer out(f);
+    ASSERT_EQUAL(out.write(a).status, SUCCESS);
+    ASSERT_EQUAL(out.write(VecN<double, 3>(7)).status, SUCCESS);
+  }
+  std::rewind(f);
+  VecNArray<double, 3> back;
+  text::Stats st;
+  ASSERT_EQUAL(text::parse(f, back, st).status, SUCCESS);
+  std::fclose(f);
+  ASSERT_EQUAL(st.vectors, n + 1);
+  VecN<double, 3> x, y;
+  for (std::size_t i = 0; i < n; i += 7) {
+    a.get(i, x);
+    back.get(i, y);
+    ASSERT_TRUE(x.eval(1) == y.eval(1));
+    ASSERT_TRUE(x.eval(2) == y.eval(2));
+  }
+  back.get(n, y);
+  ASSERT_EQUAL(y.eval(0), 7);
+}
@@ -0,0 +1,131 @@
+// test file for the VecN geometry kernels
+#include "../vepp.hpp"
+#include <ctest.h>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+typedef VecN<real, 3> Vec3;
+typedef VecN<double, 7> Vec7;
+
+static Vec3 make3(real a, real b, real c) {
+  std::array<real, 3> arr = {{a, b, c}};
+  return Vec3(arr);
+}
+
+/*! @{ testing cross and triple products
+ */
+CTEST(suite, test_cross_basis) {
+  Vec3 ex = Vec3::base<0>(), ey = Vec3::base<1>(), out(0);
+  ASSERT_EQUAL(ex.cross(ey, out).status, SUCCESS);
+  real t = 0;
+  out.get(2, t);
+  ASSERT_DBL_NEAR(t, 1.0);
+  out.get(0, t);
+  ASSERT_DBL_NEAR(t, 0.0);
+  // anti commutative
+  ey.cross(ex, out);
+  out.get(2, t);
+  ASSERT_DBL_NEAR(t, -1.0);
+}
+CTEST(suite, test_cross_aliased_output) {
+  Vec3 a = make3(1, 2, 3), b = make3(4, 5, 6);
+  a.cross(b, a);
+  real x = 0, y = 0, z = 0;
+  a.get(0, x);
+  a.get(1, y);
+  a.get(2, z);
+  ASSERT_DBL_NEAR(x, -3.0);
+  ASSERT_DBL_NEAR(y, 6.0);
+  ASSERT_DBL_NEAR(z, -3.0);
+}
+CTEST(suite, test_cross_vector) {
+  Vec3 a = make3(1, 2, 3);
+  std::vector<real> b = {4, 5, 6}, out;
+  ASSERT_EQUAL(a.cross(b, out).status, SUCCESS);
+  ASSERT_EQUAL(out.size(), 3);
+  ASSERT_DBL_NEAR(out[1], 6.0);
+  std::vector<real> shorter = {1, 2};
+  ASSERT_EQUAL(a.cross(shorter, out).status, SIZE_ERROR);
+}
+CTEST(suite, test_cross_seven_dimensions) {
+  std::array<double, 7> aa = {{1, -2, 3, 0.5, 2, -1, 4}};
+  std::array<double, 7> ba = {{-3, 1, 0.25, 2, -1, 5, 1}};
+  Vec7 a(aa), b(ba), c(0.0);
+  ASSERT_EQUAL(a.cross(b, c).status, SUCCESS);
+  // orthogonal to both operands
+  double d = 1;
+  c.dot(a, d);
+  ASSERT_DBL_NEAR(d, 0.0);
+  c.dot(b, d);
+  ASSERT_DBL_NEAR(d, 0.0);
+  // |a x b|^2 = |a|^2 |b|^2 - (a . b)^2
+  double aa2 = 0, bb2 = 0, ab = 0, cc2 = 0;
+  a.length_squared(aa2);
+  b.length_squared(bb2);
+  a.dot(b, ab);
+  c.length_squared(cc2);
+  ASSERT_DBL_NEAR(cc2, aa2 * bb2 - ab * ab);
+  // e_1 x e_2 = e_4
+  Vec7 e1 = Vec7::base<0>(), e2 = Vec7::base<1>();
+  e1.cross(e2, c);
+  c.get(3, d);
+  ASSERT_DBL_NEAR(d, 1.0);
+}
+CTEST(suite, test_triple_product) {
+  Vec3 a = make3(1, 0, 0), b = make3(0, 2, 0), c = make3(0, 0, 3);
+  real t = 0;
+  ASSERT_EQUAL(a.triple(b, c, t).status, SUCCESS);
+  ASSERT_DBL_NEAR(t, 6.0);
+  b.triple(a, c, t);
+  ASSERT_DBL_NEAR(t, -6.0);
+}
+
+/*! @} */
+
+/*! @{ testing lengths and normalization
+ */
+CTEST(suite, test_length_distance) {
+  Vec3 a = make3(3, 4, 12), b = make3(0, 0, 0);
+  real t = 0;
+  a.length_squared(t);
+  ASSERT_DBL_NEAR(t, 169.0);
+  a.length(t);
+  ASSERT_DBL_NEAR(t, 13.0);
+  a.distance(b, t);
+  ASSERT_DBL_NEAR(t, 13.0);
+  b.distance(a, t);
+  ASSERT_DBL_NEAR(t, 13.0);
+}
+CTEST(suite, test_normalize) {
+  Vec3 a = make3(3, 4, 12), out(0);
+  ASSERT_EQUAL(a.normalize(out).status, SUCCESS);
+  real t = 0;
+  out.length(t);
+  ASSERT_DBL_NEAR(t, 1.0);
+  out.get(0, t);
+  ASSERT_DBL_NEAR(t, 3.0 / 13.0);
+  std::vector<real> vout;
+  ASSERT_EQUAL(a.normalize(vout).status, SUCCESS);
+  ASSERT_DBL_NEAR(vout[2], 12.0 / 13.0);
+  // in place
+  a.normalize(a);
+  a.get(1, t);
+  ASSERT_DBL_NEAR(t, 4.0 / 13.0);
+}
+CTEST(suite, test_normalize_zero_vector) {
+  Vec3 z(0), out(5);
+  ASSERT_EQUAL(z.normalize(out).status, ARG_ERROR);
+  real t = 0;
+  out.get(0, t);
+  ASSERT_DBL_NEAR(t, 5.0);
+  VecNUnchecked<real, 3> zu(0), outu(0);
+  ASSERT_EQUAL(zu.normalize(outu).status, SUCCESS);
+}
+
+/*! @} */
+
+/*! @} */
@@ -0,0 +1,168 @@
+// test file for the 16 bit floating point storage
+#include "../vepp_array.hpp"
+#include "../vepp_half.hpp"
+#include "../vepp_parallel.hpp"
+#include <ctest.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/*! @{
+ */
+
+using namespace vepp;
+
+/** deterministic values in [-1, 1)*/
+static std::vector<float> sample(std::size_t n, unsigned int seed) {
+  std::vector<float> out(n);
+  std::uint32_t x = seed * 2654435761u + 1;
+  for (std::size_t i = 0; i < n; i++) {
+    x = x * 1664525u + 1013904223u;
+    out[i] = static_cast<float>(x >> 8) / 8388608.0f - 1.0f;
+  }
+  return out;
+}
+
+/** every binary16 value converts to float and back unchanged*/
+static bool half_roundtrips() {
+  std::vector<half> in(65536), back(65536);
+  std::vector<float> f(65536);
+  for (std::uint32_t b = 0; b < 65536; b++) {
+    in[b] = half::from_bits(static_cast<std::uint16_t>(b));
+  }
+  simd::convert(in.data(), f.data(), in.size());
+  simd::convert(f.data(), back.data(), f.size());
+  for (std::uint32_t b = 0; b < 65536; b++) {
+    bool nan = (b & 0x7c00u) == 0x7c00u && (b & 0x3ffu) != 0;
+    if (nan ? !std::isnan(f[b]) : back[b].bits != b)
+      return false;
+    if (!nan && f[b] != half::to_float(static_cast<std::uint16_t>(b)))
+      return false;
+  }
+  return true;
+}
+
+/*! @{ testing the scalar conversions
+ */
+CTEST(suite, test_half_rounding) {
+  ASSERT_EQUAL(half(1.0f).bits, 0x3c00);
+  ASSERT_EQUAL(half(-2.0f).bits, 0xc000);
+  ASSERT_EQUAL(half(65504.0f).bits, 0x7bff);
+  // ties go to the even mantissa
+  ASSERT_EQUAL(half(1.0f + 1.0f / 2048).bits, 0x3c00);
+  ASSERT_EQUAL(half(1.0f + 3.0f / 2048).bits, 0x3c02);
+  // overflow, underflow and the smallest subnormal
+  ASSERT_EQUAL(half(65520.0f).bits, 0x7c00);
+  ASSERT_EQUAL(half(std::numeric_limits<float>::infinity()).bits, 0x7c00);
+  ASSERT_EQUAL(half(1e-8f).bits, 0x0000);
+  ASSERT_EQUAL(half(5.9604645e-8f).bits, 0x0001);
+  ASSERT_EQUAL(static_cast<float>(half::from_bits(0x0001)), 5.9604645e-8f);
+  ASSERT_EQUAL(static_cast<float>(half::from_bits(0x8400)), -6.103515625e-05f);
+  ASSERT_TRUE(std::isnan(static_cast<float>(
+      half(std::numeric_limits<float>::quiet_NaN()))));
+}
+CTEST(suite, test_bfloat16_rounding) {
+  ASSERT_EQUAL(bfloat16(1.0f).bits, 0x3f80);
+  ASSERT_EQUAL(static_cast<float>(bfloat16(3.0f)), 3.0f);
+  // 1 + 2^-8 is a tie, 1 + 3 * 2^-8 rounds up to the even 1 + 2^-6
+  ASSERT_EQUAL(bfloat16(1.0f + 1.0f / 256).bits, 0x3f80);
+  ASSERT_EQUAL(bfloat16(1.0f + 3.0f / 256).bits, 0x3f82);
+  ASSERT_EQUAL(bfloat16(3.0e38f).bits, 0x7f62);
+  ASSERT_TRUE(std::isnan(static_cast<float>(
+      bfloat16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+/*! @{ testing the bulk conversions on every instruction set
+ */
+CTEST(suite, test_half_bulk_conversions) {
+  simd::isa_t best = simd::detect_isa();
+  std::vector<float> f = sample(1003, 3);
+  for (int isa = simd::ISA_SCALAR; isa <= best; isa++) {
+    simd::set_isa(static_cast<simd::isa_t>(isa));
+    ASSERT_TRUE(half_roundtrips());
+    std::vector<half> h(f.size());
+    simd::convert(f.data(), h.data(), f.size());
+    for (std::size_t i = 0; i < f.size(); i++) {
+      ASSERT_EQUAL(h[i].bits, half(f[i]).bits);
+    }
+  }
+  simd::set_isa(best);
+  std::vector<bfloat16> b(f.size());
+  std::vector<float> back(f.size());
+  simd::convert(f.data(), b.data(), f.size());
+  simd::convert(b.data(), back.data(), b.size());
+  for (std::size_t i = 0; i < f.size(); i++) {
+    ASSERT_TRUE(std::fabs(back[i] - f[i]) <= std::fabs(f[i]) / 256);
+  }
+}
+
+/*! @{ testing VecN with 16 bit storage
+ */
+CTEST(suite, test_half_vecn) {
+  VecNHalf<3> a(1.5f), b(2.0f), out;
+  ASSERT_EQUAL(a.add(b, out).status, SUCCESS);
+  ASSERT_EQUAL(static_cast<float>(out.eval(0)), 3.5f);
+  ASSERT_EQUAL(a.divide(half(0.0f), out).status, ARG_ERROR);
+  out = a * b + a;
+  ASSERT_EQUAL(static_cast<float>(out.eval(2)), 4.5f);
+  float d = 0;
+  ASSERT_EQUAL(a.dot(b, d).status, SUCCESS);
+  ASSERT_EQUAL(d, 9.0f);
+  double l = 0;
+  ASSERT_EQUAL(b.length(l).status, SUCCESS);
+  ASSERT_DBL_NEAR_TOL(l, std::sqrt(12.0), 1e-12);
+  VecNBFloat16<4> c(0.25f);
+  ASSERT_EQUAL(c.dot(c, d).status, SUCCESS);
+  ASSERT_EQUAL(d, 0.25f);
+  // past 2048 halves are even, a half accumulator would round every
+  // partial sum of 49s
+  VecNHalf<64> big(7.0f);
+  ASSERT_EQUAL(big.dot(big, d).status, SUCCESS);
+  ASSERT_EQUAL(d, 3136.0f);
+  half hd;
+  ASSERT_EQUAL(big.dot(big, hd).status, SUCCESS);
+  ASSERT_EQUAL(static_cast<float>(hd), 3136.0f);
+}
+
+/*! @{ testing accumulation accuracy
+ */
+CTEST(suite, test_half_dot_accuracy) {
+  const std::size_t n = 1 << 14;
+  std::vector<float> fx = sample(n, 1), fy = sample(n, 2);
+  VecNArray<float, 4> x(n / 4), y(n / 4);
+  for (unsigned int k = 0; k < 4; k++) {
+    float *lx = nullptr, *ly = nullptr;
+    x.lane(k, lx);
+    y.lane(k, ly);
+    for (std::size_t i = 0; i < n / 4; i++) {
+      lx[i] = fx[k * (n / 4) + i];
+      ly[i] = fy[k * (n / 4) + i];
+    }
+  }
+  VecNArray<half, 4> hx, hy;
+  ASSERT_EQUAL(x.convert(hx).status, SUCCESS);
+  ASSERT_EQUAL(y.convert(hy).status, SUCCESS);
+  // per vector dot products match the double reference of the rounded
+  // values up to float accumulation
+  std::vector<float> dots;
+  std::vector<double> ref;
+  ASSERT_EQUAL(hx.dot(hy, dots).status, SUCCESS);
+  ASSERT_EQUAL(hx.dot(hy, ref).status, SUCCESS);
+  ASSERT_EQUAL(dots.size(), n / 4);
+  for (std::size_t i = 0; i < dots.size(); i++) {
+    ASSERT_DBL_NEAR_TOL(dots[i], ref[i], 1e-6);
+  }
+  // the sum over the whole array: float storage with double accumulation
+  // is the reference, half storage loses about 3 decimal digits
+  parallel::Pool pool(2);
+  double exact = 0;
+  float from_half = 0;
+  ASSERT_EQUAL(parallel::dot(pool, x, y, exact).status, SUCCESS);
+  ASSERT_EQUAL(parallel::dot(pool, hx, hy, from_half).status, SUCCESS);
+  ASSERT_DBL_NEAR_TOL(from_half, exact, 1e-3 * std::sqrt(double(n)));
+  std::vector<double> wide;
+  ASSERT_EQUAL(x.dot(y, wide).status, SUCCESS);
+  std::vector<float> narrow;
+  ASSERT_EQUAL(x.dot(y, narrow).status, SUCCESS);
+  ASSERT_DBL_NEAR_TOL(wide[7], narrow[7], 1e-6);
+}
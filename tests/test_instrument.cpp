@@ -0,0 +1,169 @@
+// test file for the opt-in instrumentation
+#define VEPP_INSTRUMENT
+#include "../vepp.hpp"
+#include "../vepp_array.hpp"
+#include "../vepp_dataset.hpp"
+#include "../vepp_text.hpp"
+#include <ctest.h>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+/*! @{ testing call counters
+ */
+CTEST(suite, test_instrument_calls) {
+  instrument::reset();
+  VecN<real, 3> v(1), w(2), out;
+  real t = 0;
+  v.get(0, t);
+  v.set(1, t);
+  v.add(w, out);
+  v.dot(w, t);
+  v.cross(w, out);
+  v.normalize(out);
+  instrument::Snapshot s = instrument::snapshot();
+  ASSERT_EQUAL(s.calls[instrument::OP_GET], 1);
+  ASSERT_EQUAL(s.calls[instrument::OP_SET], 1);
+  ASSERT_EQUAL(s.calls[instrument::OP_ADD], 1);
+  ASSERT_EQUAL(s.calls[instrument::OP_CROSS], 1);
+  ASSERT_EQUAL(s.calls[instrument::OP_NORMALIZE], 1);
+  // normalize goes through dot
+  ASSERT_EQUAL(s.calls[instrument::OP_DOT], 2);
+  ASSERT_EQUAL(s.calls[instrument::OP_TRIPLE], 0);
+  ASSERT_EQUAL(s.total_failures(), 0);
+}
+CTEST(suite, test_instrument_reset) {
+  VecN<real, 3> v(1), out;
+  v.add(v, out);
+  instrument::reset();
+  instrument::Snapshot s = instrument::snapshot();
+  ASSERT_EQUAL(s.calls[instrument::OP_ADD], 0);
+}
+
+/*! @} */
+
+/*! @{ testing failure counters
+ */
+CTEST(suite, test_instrument_failures) {
+  instrument::reset();
+  VecN<real, 3> v(1), zero(0), out;
+  real t = 0;
+  v.get(3, t);
+  v.set(4, t);
+  v.divide(0, out);
+  zero.normalize(out);
+  std::vector<real> shorter(2, 1), vout;
+  v.add(shorter, vout);
+  instrument::Snapshot s = instrument::snapshot();
+  ASSERT_EQUAL(s.failures[INDEX_ERROR], 2);
+  ASSERT_EQUAL(s.failures[ARG_ERROR], 2);
+  ASSERT_EQUAL(s.failures[SIZE_ERROR], 1);
+  ASSERT_EQUAL(s.total_failures(), 5);
+}
+CTEST(suite, test_instrument_batch_failures) {
+  // batch operations count their failures like VecN methods
+  instrument::reset();
+  VecNArray<real, 3> a(8, 1), b(4, 1), out;
+  VecN<real, 3> v;
+  a.get(8, v);
+  a.add(b, out);
+  a.divide(b, out);
+  a.divide(0, out);
+  instrument::Snapshot s = instrument::snapshot();
+  ASSERT_EQUAL(s.failures[INDEX_ERROR], 1);
+  ASSERT_EQUAL(s.failures[SIZE_ERROR], 2);
+  ASSERT_EQUAL(s.failures[ARG_ERROR], 1);
+  ASSERT_EQUAL(s.total_failures(), 4);
+}
+CTEST(suite, test_instrument_unchecked) {
+  instrument::reset();
+  VecNUnchecked<real, 3> v(1);
+  real t = 0;
+  v.get(3, t);
+  ASSERT_EQUAL(instrument::snapshot().total_failures(), 0);
+}
+
+/*! @} */
+
+/*! @{ testing threads and export
+ */
+CTEST(suite, test_instrument_threads) {
+  instrument::reset();
+  auto work = []() {
+    VecN<real, 4> v(1), out;
+    for (int i = 0; i < 100; i++) {
+      v.multiply(v, out);
+    }
+  };
+  std::thread a(work), b(work);
+  a.join();
+  b.join();
+  work();
+  instrument::Snapshot s = instrument::snapshot();
+  ASSERT_EQUAL(s.calls[instrument::OP_MULTIPLY], 300);
+}
+CTEST(suite, test_instrument_export) {
+  instrument::reset();
+  VecN<real, 3> v(1), out;
+  v.subtract(v, out);
+  v.divide(0, out);
+  instrument::Snapshot s = instrument::snapshot();
+  std::ostringstream text, csv;
+  instrument::write(text, s);
+  instrument::write_perf_stat(csv, s);
+  ASSERT_NOT_EQUAL(text.str().find("subtract 1 calls"), std::string::npos);
+  ASSERT_NOT_EQUAL(csv.str().find("1,,vepp.subtract.calls\n"),
+                   std::string::npos);
+  ASSERT_NOT_EQUAL(csv.str().find("1,,vepp.failures.ARG_ERROR\n"),
+                   std::string::npos);
+}
+CTEST(suite, test_instrument_every_status) {
+  // the I/O and parsing statuses are counted where they are reported
+  instrument::reset();
+  dataset::Reader<real, 3> r;
+  ASSERT_EQUAL(r.open("test_instrument_missing.bin").status, IO_ERROR);
+  const char *short_path = "test_instrument_short.bin";
+  std::FILE *f = std::fopen(short_path, "wb");
+  std::fputs("vepp", f);
+  std::fclose(f);
+  ASSERT_EQUAL(r.open(short_path).status, FORMAT_ERROR);
+  std::remove(short_path);
+  const std::string rows = "1 2 3\n1 2\nx y z\n";
+  VecNArray<real, 3> parsed;
+  text::Stats st;
+  ASSERT_EQUAL(text::parse(rows.data(), rows.size(), parsed, st).status,
+               FORMAT_ERROR);
+  instrument::Snapshot s = instrument::snapshot();
+  ASSERT_EQUAL(s.failures[IO_ERROR], 1);
+  ASSERT_EQUAL(s.failures[FORMAT_ERROR], 2);
+  ASSERT_EQUAL(s.failures[0], 0);
+  // the last status has its own counter and name in both exports
+  std::ostringstream out, csv;
+  instrument::write(out, s);
+  instrument::write_perf_stat(csv, s);
+  ASSERT_NOT_EQUAL(out.str().find("FORMAT_ERROR 2"), std::string::npos);
+  ASSERT_EQUAL(out.str().find("UNKNOWN"), std::string::npos);
+  ASSERT_NOT_EQUAL(csv.str().find("2,,vepp.failures.FORMAT_ERROR\n"),
+                   std::string::npos);
+}
+#if __cplusplus >= 201703L
+CTEST(suite, test_instrument_constexpr) {
+  // counting keeps the methods usable in constant expressions
+  constexpr VecN<real, 3> v(2);
+  constexpr real t = [](const VecN<real, 3> &a) {
+    real d = 0;
+    a.dot(a, d);
+    return d;
+  }(v);
+  static_assert(t == 12, "constexpr dot");
+  ASSERT_EQUAL(t, static_cast<real>(12));
+}
+#endif
+
+/*! @} */
@@ -0,0 +1,145 @@
+// test file for the asynchronous log sink
+#define VEPP_ASYNC_LOG
+#include "../vepp.hpp"
+#include <ctest.h>
+#include <cmath>
+#include <sstream>
+#include <thread>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+static unsigned int count(const std::string &s, const std::string &what) {
+  unsigned int n = 0;
+  for (size_t i = s.find(what); i != std::string::npos;
+       i = s.find(what, i + 1)) {
+    n++;
+  }
+  return n;
+}
+
+/*! @{ testing the routing of INFO
+ */
+CTEST(suite, test_log_info) {
+  std::ostringstream out;
+  async_log::set_output(out);
+  async_log::set_rate_limit(100);
+  VecN<real, 3> v(1);
+  real t = 0;
+  Result res;
+  INFO_M(v.get(0, t), res);
+  INFO_M(v.get(5, t), res);
+  ASSERT_EQUAL(res.status, INDEX_ERROR);
+  async_log::flush();
+  // successes are only written by INFO_VERBOSE
+  ASSERT_EQUAL(count(out.str(), "SUCCESS"), 0);
+  ASSERT_EQUAL(count(out.str(), "INDEX_ERROR at get"), 1);
+  async_log::set_output(std::cerr);
+}
+CTEST(suite, test_log_info_verbose) {
+  std::ostringstream out;
+  async_log::set_output(out);
+  async_log::set_rate_limit(100);
+  VecN<real, 3> v(1);
+  real t = 0;
+  Result res;
+  INFO_VERBOSE_M(v.get(0, t), res);
+  async_log::flush();
+  ASSERT_EQUAL(count(out.str(), "SUCCESS at get"), 1);
+  async_log::set_output(std::cerr);
+}
+
+/*! @} */
+
+/*! @{ testing dedup, rate limit and threads
+ */
+CTEST(suite, test_log_dedup) {
+  std::ostringstream out;
+  async_log::set_output(out);
+  async_log::set_rate_limit(100);
+  VecN<real, 3> v(1);
+  real t = 0;
+  for (int i = 0; i < 50; i++) {
+    INFO(v.get(5, t));
+  }
+  async_log::flush();
+  ASSERT_EQUAL(count(out.str(), "INDEX_ERROR at get"), 1);
+  ASSERT_EQUAL(count(out.str(), "repeated 49 times"), 1);
+  async_log::set_output(std::cerr);
+}
+CTEST(suite, test_log_rate_limit) {
+  std::ostringstream out;
+  async_log::set_output(out);
+  async_log::set_rate_limit(0);
+  async_log::post(ARG_ERROR, "a", "f", 1);
+  async_log::post(SIZE_ERROR, "b", "f", 2);
+  async_log::flush();
+  ASSERT_EQUAL(count(out.str(), " at "), 0);
+  async_log::set_rate_limit(100);
+  async_log::set_output(std::cerr);
+}
+CTEST(suite, test_log_threads) {
+  std::ostringstream out;
+  async_log::set_output(out);
+  async_log::set_rate_limit(1000);
+  auto work = [](unsigned int line) {
+    for (int i = 0; i < 10; i++) {
+      async_log::post(ARG_ERROR, "work", "f", line);
+      async_log::post(SIZE_ERROR, "work", "f", line);
+    }
+  };
+  std::thread a(work, 1), b(work, 2);
+  a.join();
+  b.join();
+  async_log::flush();
+  ASSERT_EQUAL(count(out.str(), "ARG_ERROR at work :: f :: 1\n"), 10);
+  ASSERT_EQUAL(count(out.str(), "SIZE_ERROR at work :: f :: 2\n"), 10);
+  async_log::set_output(std::cerr);
+}
+CTEST(suite, test_log_thread_rings) {
+  // the ring of a finished thread is freed once its records are written
+  std::ostringstream out;
+  async_log::set_output(out);
+  async_log::set_rate_limit(1000);
+  async_log::flush();
+  const std::size_t before = async_log::rings_alive();
+  for (unsigned int i = 0; i < 16; i++) {
+    std::thread t([i]() { async_log::post(ARG_ERROR, "short", "f", i); });
+    t.join();
+  }
+  async_log::flush();
+  ASSERT_EQUAL(count(out.str(), "ARG_ERROR at short"), 16);
+  ASSERT_EQUAL(async_log::rings_alive(), before);
+  async_log::set_rate_limit(100);
+  async_log::set_output(std::cerr);
+}
+CTEST(suite, test_log_ring_full) {
+  std::ostringstream out;
+  async_log::set_output(out);
+  async_log::set_rate_limit(0);
+  bool dropped = false;
+  const unsigned int n = 100 * async_log::Ring::capacity;
+  for (unsigned int i = 0; i < n && !dropped; i++) {
+    dropped = !async_log::post(ARG_ERROR, "full", "f", i);
+  }
+  async_log::flush();
+  if (dropped) {
+    ASSERT_NOT_EQUAL(out.str().find("dropped, ring full"), std::string::npos);
+  }
+  async_log::set_rate_limit(100);
+  async_log::set_output(std::cerr);
+}
+
+/*! @} */
+
+/*! @{ testing the header next to <math.h>
+ */
+CTEST(suite, test_log_math_names) {
+  // the sink namespace must not hide ::log under using namespace vepp
+  ASSERT_DBL_NEAR_TOL(log(std::exp(2.0)), 2.0, 1e-12);
+}
+
+/*! @} */
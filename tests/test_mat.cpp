@@ -0,0 +1,226 @@
+// test file for MatNM
+#include "../vepp_mat.hpp"
+#include <ctest.h>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+typedef MatNM<real, 3, 3> Mat3;
+typedef MatNM<real, 4, 4> Mat4;
+typedef MatNM<real, 2, 3> Mat23;
+
+/** m[r][c] = r * C + c + 1*/
+template <class M> static M counting() {
+  M m(0);
+  for (unsigned int r = 0; r < M::rows; r++) {
+    for (unsigned int c = 0; c < M::cols; c++) {
+      m.set(r, c, static_cast<typename M::value_type>(r * M::cols + c + 1));
+    }
+  }
+  return m;
+}
+
+/*! @{ testing construction and access
+ */
+CTEST(suite, test_mat_constructors) {
+  Mat23 m(2);
+  unsigned int r = 0, c = 0;
+  m.size(r, c);
+  ASSERT_EQUAL(r, 2);
+  ASSERT_EQUAL(c, 3);
+  real t = 0;
+  ASSERT_EQUAL(m.get(1, 2, t).status, SUCCESS);
+  ASSERT_DBL_NEAR(t, 2.0);
+  ASSERT_EQUAL(m.get(2, 0, t).status, INDEX_ERROR);
+  ASSERT_EQUAL(m.set(0, 3, t).status, INDEX_ERROR);
+  Mat23 a(std::array<real, 6>{{1, 2, 3, 4, 5, 6}});
+  a.get(1, 0, t);
+  ASSERT_DBL_NEAR(t, 4.0);
+  Mat3 id = Mat3::identity();
+  id.get(1, 1, t);
+  ASSERT_DBL_NEAR(t, 1.0);
+  id.get(1, 2, t);
+  ASSERT_DBL_NEAR(t, 0.0);
+  // built by default, the matrix is zero
+  Mat23 z;
+  t = 1;
+  ASSERT_EQUAL(z.get(1, 2, t).status, SUCCESS);
+  ASSERT_DBL_NEAR(t, 0.0);
+}
+CTEST(suite, test_mat_row_col_transpose) {
+  Mat23 m = counting<Mat23>();
+  VecN<real, 3> row;
+  VecN<real, 2> col;
+  real t = 0;
+  ASSERT_EQUAL(m.row(1, row).status, SUCCESS);
+  row.get(0, t);
+  ASSERT_DBL_NEAR(t, 4.0);
+  ASSERT_EQUAL(m.col(2, col).status, SUCCESS);
+  col.get(1, t);
+  ASSERT_DBL_NEAR(t, 6.0);
+  ASSERT_EQUAL(m.row(2, row).status, INDEX_ERROR);
+  MatNM<real, 3, 2> mt;
+  ASSERT_EQUAL(m.transpose(mt).status, SUCCESS);
+  mt.get(2, 1, t);
+  ASSERT_DBL_NEAR(t, 6.0);
+  mt.get(0, 1, t);
+  ASSERT_DBL_NEAR(t, 4.0);
+  // square transpose in place
+  Mat3 s = counting<Mat3>();
+  s.transpose(s);
+  s.get(0, 2, t);
+  ASSERT_DBL_NEAR(t, 7.0);
+}
+
+/*! @} */
+
+/*! @{ testing products
+ */
+CTEST(suite, test_mat_vector_products) {
+  Mat23 m = counting<Mat23>();
+  VecN<real, 3> v(std::array<real, 3>{{1, 0, -1}});
+  VecN<real, 2> out;
+  ASSERT_EQUAL(m.multiply(v, out).status, SUCCESS);
+  real t = 0;
+  out.get(0, t);
+  ASSERT_DBL_NEAR(t, -2.0);
+  out.get(1, t);
+  ASSERT_DBL_NEAR(t, -2.0);
+  VecN<real, 2> w(std::array<real, 2>{{1, 2}});
+  VecN<real, 3> wout;
+  ASSERT_EQUAL(m.left_multiply(w, wout).status, SUCCESS);
+  wout.get(0, t);
+  ASSERT_DBL_NEAR(t, 9.0);
+  wout.get(2, t);
+  ASSERT_DBL_NEAR(t, 15.0);
+}
+CTEST(suite, test_mat_vector_fixed_kernels) {
+  // the 3x3 and 4x4 float transforms against the generic loop
+  Mat3 m3 = counting<Mat3>();
+  Mat4 m4 = counting<Mat4>();
+  VecN<real, 3> v3(std::array<real, 3>{{0.5f, -1, 2}}), o3;
+  VecN<real, 4> v4(std::array<real, 4>{{0.5f, -1, 2, 3}}), o4;
+  m3.multiply(v3, o3);
+  m4.multiply(v4, o4);
+  for (unsigned int r = 0; r < 4; r++) {
+    real e3 = 0, e4 = 0, t = 0, x = 0;
+    for (unsigned int c = 0; c < 4; c++) {
+      v4.get(c, x);
+      e4 += static_cast<real>(r * 4 + c + 1) * x;
+      if (r < 3 && c < 3) {
+        v3.get(c, x);
+        e3 += static_cast<real>(r * 3 + c + 1) * x;
+      }
+    }
+    o4.get(r, t);
+    ASSERT_DBL_NEAR(t, e4);
+    if (r < 3) {
+      o3.get(r, t);
+      ASSERT_DBL_NEAR(t, e3);
+    }
+  }
+  // the identity leaves vectors unchanged
+  Mat4::identity().multiply(v4, o4);
+  real t = 0;
+  o4.get(3, t);
+  ASSERT_DBL_NEAR(t, 3.0);
+}
+CTEST(suite, test_mat_matmul) {
+  Mat23 a = counting<Mat23>();
+  MatNM<real, 3, 2> b = counting<MatNM<real, 3, 2>>();
+  MatNM<real, 2, 2> out;
+  ASSERT_EQUAL(a.multiply(b, out).status, SUCCESS);
+  real t = 0;
+  out.get(0, 0, t);
+  ASSERT_DBL_NEAR(t, 22.0);
+  out.get(0, 1, t);
+  ASSERT_DBL_NEAR(t, 28.0);
+  out.get(1, 0, t);
+  ASSERT_DBL_NEAR(t, 49.0);
+  out.get(1, 1, t);
+  ASSERT_DBL_NEAR(t, 64.0);
+  // aliased square product
+  Mat3 s = counting<Mat3>();
+  Mat3 expected;
+  s.multiply(s, expected);
+  s.multiply(s, s);
+  for (unsigned int i = 0; i < 9; i++) {
+    real x = 0, y = 0;
+    s.get(i / 3, i % 3, x);
+    expected.get(i / 3, i % 3, y);
+    ASSERT_DBL_NEAR(x, y);
+  }
+}
+CTEST(suite, test_mat_matmul_tiled) {
+  // larger than a tile in every dimension and not a multiple of it
+  typedef MatNM<double, 70, 67> A;
+  typedef MatNM<double, 67, 75> B;
+  A *a = new A(counting<A>());
+  B *b = new B(counting<B>());
+  MatNM<double, 70, 75> *out = new MatNM<double, 70, 75>(0.0);
+  a->multiply(*b, *out);
+  bool ok = true;
+  for (unsigned int i = 0; i < 70; i += 13) {
+    for (unsigned int j = 0; j < 75; j += 11) {
+      double e = 0, x = 0, y = 0;
+      for (unsigned int k = 0; k < 67; k++) {
+        a->get(i, k, x);
+        b->get(k, j, y);
+        e += x * y;
+      }
+      out->get(i, j, x);
+      ok = ok && x == e;
+    }
+  }
+  ASSERT_TRUE(ok);
+  delete a;
+  delete b;
+  delete out;
+}
+CTEST(suite, test_mat_batched_transform) {
+  Mat23 m = counting<Mat23>();
+  const std::size_t n = 37;
+  VecNArray<real, 3> in(n);
+  for (std::size_t i = 0; i < n; i++) {
+    VecN<real, 3> v(std::array<real, 3>{
+        {static_cast<real>(i), 1, -static_cast<real>(i % 5)}});
+    in.set(i, v);
+  }
+  VecNArray<real, 2> out;
+  ASSERT_EQUAL(m.multiply(in, out).status, SUCCESS);
+  std::size_t size = 0;
+  out.size(size);
+  ASSERT_EQUAL(size, n);
+  for (std::size_t i = 0; i < n; i++) {
+    VecN<real, 3> v;
+    VecN<real, 2> expected, got;
+    in.get(i, v);
+    m.multiply(v, expected);
+    out.get(i, got);
+    real x = 0, y = 0;
+    for (unsigned int r = 0; r < 2; r++) {
+      expected.get(r, x);
+      got.get(r, y);
+      ASSERT_DBL_NEAR(x, y);
+    }
+  }
+  // in place with a square matrix
+  Mat3 s = counting<Mat3>();
+  VecNArray<real, 3> copy(in);
+  s.multiply(in, in);
+  VecN<real, 3> v, e, g;
+  copy.get(5, v);
+  s.multiply(v, e);
+  in.get(5, g);
+  real x = 0, y = 0;
+  e.get(2, x);
+  g.get(2, y);
+  ASSERT_DBL_NEAR(x, y);
+}
+
+/*! @} */
+
+/*! @} */
@@ -0,0 +1,255 @@
+// test file for the parallel batch engine
+#include "../vepp_parallel.hpp"
+#include <ctest.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+static const std::size_t nb_vectors = 100000;
+
+static VecNArray<real, 3> ramp(std::size_t n) {
+  VecNArray<real, 3> a(n);
+  for (std::size_t i = 0; i < n; i++) {
+    std::array<real, 3> arr = {{static_cast<real>(i % 7),
+                                static_cast<real>(i % 5) + 1,
+                                -static_cast<real>(i % 3)}};
+    a.set(i, VecN<real, 3>(arr));
+  }
+  return a;
+}
+
+/*! @{ testing the pool
+ */
+CTEST(suite, test_pool_every_chunk_once) {
+  // more threads than cores makes the stealing path run
+  parallel::Pool pool(4);
+  ASSERT_EQUAL(pool.size(), 4);
+  std::vector<std::atomic<int>> seen(1000);
+  for (std::atomic<int> &s : seen) {
+    s.store(0);
+  }
+  std::atomic<unsigned int> bad_participant(0);
+  for (int rep = 0; rep < 20; rep++) {
+    pool.run(seen.size(), [&](std::size_t c, unsigned int p) {
+      bad_participant.fetch_add(p >= 4 ? 1 : 0);
+      seen[c].fetch_add(1);
+    });
+  }
+  ASSERT_EQUAL(bad_participant.load(), 0);
+  for (std::atomic<int> &s : seen) {
+    ASSERT_EQUAL(s.load(), 20);
+  }
+}
+CTEST(suite, test_pool_for_range) {
+  parallel::Pool pool(3);
+  std::vector<int> v(10001, 0);
+  parallel::Options o;
+  o.chunk = 100;
+  parallel::for_range(pool, v.size(), [&](std::size_t b, std::size_t e) {
+    for (std::size_t i = b; i < e; i++) {
+      v[i] += 1;
+    }
+  }, o);
+  int sum = 0;
+  for (int x : v) {
+    sum += x;
+  }
+  ASSERT_EQUAL(sum, 10001);
+}
+CTEST(suite, test_pool_concurrent_callers) {
+  // two threads sharing the default pool take turns
+  parallel::Pool &pool = parallel::default_pool();
+  std::vector<int> a(50000, 0), b(50000, 0);
+  parallel::Options o;
+  o.chunk = 100;
+  auto fill = [&](std::vector<int> &v, int x) {
+    for (int rep = 0; rep < 20; rep++) {
+      parallel::for_range(pool, v.size(), [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; i++) {
+          v[i] += x;
+        }
+      }, o);
+    }
+  };
+  std::thread other(fill, std::ref(b), 2);
+  fill(a, 1);
+  other.join();
+  long sa = 0, sb = 0;
+  for (std::size_t i = 0; i < a.size(); i++) {
+    sa += a[i];
+    sb += b[i];
+  }
+  ASSERT_EQUAL(sa, 20 * 50000);
+  ASSERT_EQUAL(sb, 40 * 50000);
+  // a job started from a task runs inline on that task's thread
+  parallel::Pool p4(4);
+  std::atomic<int> inner(0);
+  p4.run(8, [&](std::size_t, unsigned int) {
+    p4.run(10, [&](std::size_t, unsigned int q) {
+      inner.fetch_add(q == 0 ? 1 : 100);
+    });
+  });
+  ASSERT_EQUAL(inner.load(), 80);
+}
+CTEST(suite, test_pool_reduce_deterministic) {
+  std::vector<double> v(50000);
+  for (std::size_t i = 0; i < v.size(); i++) {
+    v[i] = 1.0 / static_cast<double>(i + 1);
+  }
+  parallel::Options o;
+  o.deterministic = true;
+  o.chunk = 1000;
+  auto map = [&](std::size_t b, std::size_t e) {
+    double s = 0;
+    for (std::size_t i = b; i < e; i++) {
+      s += v[i];
+    }
+    return s;
+  };
+  auto plus = [](double x, double y) { return x + y; };
+  parallel::Pool one(1), four(4);
+  double r1 = parallel::reduce(one, v.size(), 0.0, map, plus, o);
+  double r4 = parallel::reduce(four, v.size(), 0.0, map, plus, o);
+  ASSERT_TRUE(r1 == r4);
+  o.deterministic = false;
+  double r = parallel::reduce(four, v.size(), 0.0, map, plus, o);
+  ASSERT_DBL_NEAR_TOL(r, r1, 1e-9);
+}
+
+/*! @} */
+
+/*! @{ testing bulk operations
+ */
+CTEST(suite, test_parallel_arithmetic) {
+  parallel::Pool pool(4);
+  VecNArray<real, 3> a = ramp(nb_vectors), b(nb_vectors, 2), out, ref;
+  ASSERT_EQUAL(parallel::add(pool, a, b, out).status, SUCCESS);
+  a.add(b, ref);
+  VecN<real, 3> x, y;
+  for (std::size_t i = 0; i < nb_vectors; i += 997) {
+    out.get(i, x);
+    ref.get(i, y);
+    for (unsigned int k = 0; k < 3; k++) {
+      real s = 0, t = 0;
+      x.get(k, s);
+      y.get(k, t);
+      ASSERT_EQUAL(s, t);
+    }
+  }
+  ASSERT_EQUAL(parallel::multiply(pool, a, static_cast<real>(3), out).status,
+               SUCCESS);
+  out.get(nb_vectors - 1, x);
+  a.get(nb_vectors - 1, y);
+  real s = 0, t = 0;
+  x.get(1, s);
+  y.get(1, t);
+  ASSERT_EQUAL(s, 3 * t);
+  VecNArray<real, 3> shorter(10);
+  ASSERT_EQUAL(parallel::subtract(pool, a, shorter, out).status, SIZE_ERROR);
+  ASSERT_EQUAL(parallel::divide(pool, a, a, out).status, ARG_ERROR);
+  // shorter is all zeros, the sizes are checked first
+  ASSERT_EQUAL(parallel::divide(pool, a, shorter, out).status, SIZE_ERROR);
+  ASSERT_EQUAL(parallel::divide(pool, a, static_cast<real>(0), out).status,
+               ARG_ERROR);
+  ASSERT_EQUAL(parallel::divide(pool, a, b, out).status, SUCCESS);
+}
+CTEST(suite, test_parallel_apply_el) {
+  parallel::Pool pool(2);
+  VecNArray<real, 3> a(nb_vectors, 2), b(nb_vectors, 5), out;
+  parallel::apply_el(pool, a, b, [](real x, real y) { return x * y + 1; },
+                     out);
+  VecN<real, 3> v;
+  real t = 0;
+  out.get(nb_vectors / 2, v);
+  v.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(11));
+}
+CTEST(suite, test_parallel_reductions) {
+  parallel::Pool pool(4);
+  VecNArray<real, 3> a = ramp(nb_vectors), ones(nb_vectors, 1);
+  real d = 0;
+  ASSERT_EQUAL(parallel::dot(pool, a, ones, d).status, SUCCESS);
+  double ref = 0;
+  for (std::size_t i = 0; i < nb_vectors; i++) {
+    ref += static_cast<double>(i % 7) + static_cast<double>(i % 5) + 1 -
+           static_cast<double>(i % 3);
+  }
+  ASSERT_DBL_NEAR_TOL(d, ref, ref * 1e-5);
+
+  VecN<real, 3> lo, hi;
+  ASSERT_EQUAL(parallel::min(pool, a, lo).status, SUCCESS);
+  ASSERT_EQUAL(parallel::max(pool, a, hi).status, SUCCESS);
+  real t = 0;
+  lo.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(0));
+  lo.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(-2));
+  hi.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(6));
+  hi.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(5));
+  VecNArray<real, 3> empty;
+  ASSERT_EQUAL(parallel::min(pool, empty, lo).status, SIZE_ERROR);
+
+  std::vector<real> n;
+  VecNArray<real, 3> threes(1000, 3);
+  parallel::norms(pool, threes, n);
+  ASSERT_EQUAL(n.size(), 1000);
+  ASSERT_DBL_NEAR_TOL(n[999], std::sqrt(27.0), 1e-5);
+}
+CTEST(suite, test_parallel_first_touch) {
+  parallel::Pool pool(4);
+  VecNArray<real, 4> a;
+  ASSERT_EQUAL(parallel::first_touch(pool, a, nb_vectors,
+                                     static_cast<real>(7)).status,
+               SUCCESS);
+  std::size_t n = 0;
+  a.size(n);
+  ASSERT_EQUAL(n, nb_vectors);
+  VecN<real, 4> v;
+  real t = 0;
+  a.get(nb_vectors - 1, v);
+  v.get(3, t);
+  ASSERT_EQUAL(t, static_cast<real>(7));
+}
+
+CTEST(suite, test_parallel_fused) {
+  parallel::Pool pool(4);
+  VecNArray<real, 3> x = ramp(nb_vectors), y(nb_vectors, 2), out, ref;
+  ASSERT_EQUAL(parallel::axpy(pool, static_cast<real>(3), x, y, out).status,
+               SUCCESS);
+  ref = y;
+  ref.axpy(static_cast<real>(3), x);
+  VecN<real, 3> a, b;
+  for (std::size_t i = 0; i < nb_vectors; i += 991) {
+    out.get(i, a);
+    ref.get(i, b);
+    for (unsigned int k = 0; k < 3; k++) {
+      ASSERT_EQUAL(a.eval(k), b.eval(k));
+    }
+  }
+  // in place, the output is y
+  ASSERT_EQUAL(parallel::axpby(pool, static_cast<real>(1), x,
+                               static_cast<real>(2), y, y)
+                   .status,
+               SUCCESS);
+  y.get(nb_vectors - 1, a);
+  x.get(nb_vectors - 1, b);
+  ASSERT_EQUAL(a.eval(1), b.eval(1) + 4);
+  ASSERT_EQUAL(parallel::fma(pool, x, x, y, out).status, SUCCESS);
+  out.get(12, a);
+  ASSERT_EQUAL(a.eval(0), 5 * 5 + 5 + 4);
+  VecNArray<real, 3> shorter(10);
+  ASSERT_EQUAL(parallel::fma(pool, x, x, shorter, out).status, SIZE_ERROR);
+  ASSERT_EQUAL(parallel::axpy(pool, static_cast<real>(1), x, shorter, out)
+                   .status,
+               SIZE_ERROR);
+}
+
+/*! @} */
@@ -0,0 +1,89 @@
+// test file for VecN error policies
+#include "../vepp.hpp"
+#include <ctest.h>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+/*! @{ testing the checked policy is the default
+ */
+CTEST(suite, test_checked_is_default) {
+  bool same = std::is_same<VecN<real, 3>, VecNChecked<real, 3>>::value;
+  ASSERT_EQUAL(same, true);
+  VecN<real, 3> v(1);
+  real t = 0;
+  ASSERT_EQUAL(v.get(3, t).status, INDEX_ERROR);
+  ASSERT_EQUAL(v.set(3, t).status, INDEX_ERROR);
+}
+
+/*! @} */
+
+/*! @{ testing the throwing policy
+ */
+CTEST(suite, test_throw_get_index) {
+  VecNThrow<real, 3> v(1);
+  real t = 0;
+  bool thrown = false;
+  try {
+    v.get(3, t);
+  } catch (const StatusError &e) {
+    thrown = e.status == INDEX_ERROR;
+  }
+  ASSERT_EQUAL(thrown, true);
+  ASSERT_EQUAL(v.get(2, t).status, SUCCESS);
+  ASSERT_EQUAL(t, static_cast<real>(1));
+}
+CTEST(suite, test_throw_divide_zero) {
+  VecNThrow<real, 3> v(1);
+  VecNThrow<real, 3> out;
+  VecNThrow<real, 3> z(0);
+  bool thrown = false;
+  try {
+    v.divide(z, out);
+  } catch (const StatusError &e) {
+    thrown = e.status == ARG_ERROR;
+  }
+  ASSERT_EQUAL(thrown, true);
+}
+CTEST(suite, test_throw_size) {
+  VecNThrow<real, 3> v(1);
+  std::vector<real> in(2, 1);
+  std::vector<real> out;
+  bool thrown = false;
+  try {
+    v.add(in, out);
+  } catch (const StatusError &e) {
+    thrown = e.status == SIZE_ERROR;
+  }
+  ASSERT_EQUAL(thrown, true);
+}
+
+/*! @} */
+
+/*! @{ testing the unchecked and assert policies
+ */
+CTEST(suite, test_unchecked_arithmetic) {
+  VecNUnchecked<real, 3> v(2);
+  VecNUnchecked<real, 3> w(4);
+  VecNUnchecked<real, 3> out;
+  ASSERT_EQUAL(w.divide(v, out).status, SUCCESS);
+  real t = 0;
+  ASSERT_EQUAL(out.get(1, t).status, SUCCESS);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  real d = 0;
+  ASSERT_EQUAL(v.dot(w, d).status, SUCCESS);
+  ASSERT_EQUAL(d, static_cast<real>(24));
+}
+CTEST(suite, test_assert_valid_calls) {
+  VecNAssert<real, 3> v(2);
+  VecNAssert<real, 3> out;
+  ASSERT_EQUAL(v.multiply(3, out).status, SUCCESS);
+  real t = 0;
+  ASSERT_EQUAL(out.get(0, t).status, SUCCESS);
+  ASSERT_EQUAL(t, static_cast<real>(6));
+}
+
+/*! @} */
@@ -0,0 +1,190 @@
+// test file for quaternion
+#include "../vepp_quat.hpp"
+#include <ctest.h>
+#include <cmath>
+
+/*! @{
+ */
+
+typedef double real;
+using namespace vepp;
+
+static const real pi = 3.14159265358979323846;
+
+/** unit quaternion of a rotation around a fixed, non axis aligned axis*/
+static Quat<real> turn(real angle) {
+  Quat<real> q;
+  Quat<real>::from_axis_angle(VecN<real, 3>(std::array<real, 3>{1, 2, 2}),
+                              angle, q);
+  return q;
+}
+
+/*! @{ testing construction and the algebra
+ */
+CTEST(suite, test_quat_construct) {
+  Quat<real> id = Quat<real>::identity();
+  ASSERT_EQUAL(id.w(), 1);
+  ASSERT_EQUAL(id.x(), 0);
+  Quat<real> q(1, 2, 3, 4);
+  ASSERT_EQUAL(q.coeffs().eval(2), 3);
+  Quat<real> v(VecN<real, 4>(std::array<real, 4>{0, 0, 1, 0}));
+  ASSERT_EQUAL(v.z(), 1);
+  Quat<real> r;
+  ASSERT_EQUAL(Quat<real>::from_axis_angle(
+                   VecN<real, 3>(std::array<real, 3>{0, 0, 2}), pi / 2, r)
+                   .status,
+               SUCCESS);
+  ASSERT_DBL_NEAR_TOL(r.z(), std::sqrt(0.5), 1e-12);
+  ASSERT_DBL_NEAR_TOL(r.w(), std::sqrt(0.5), 1e-12);
+  ASSERT_EQUAL(
+      Quat<real>::from_axis_angle(VecN<real, 3>(0.0), pi, r).status,
+      ARG_ERROR);
+}
+CTEST(suite, test_quat_algebra) {
+  // i * j = k, j * i = -k
+  Quat<real> i(1, 0, 0, 0), j(0, 1, 0, 0), out;
+  ASSERT_EQUAL(i.multiply(j, out).status, SUCCESS);
+  ASSERT_EQUAL(out.z(), 1);
+  ASSERT_EQUAL(out.w(), 0);
+  j.multiply(i, out);
+  ASSERT_EQUAL(out.z(), -1);
+  // q * q^-1 = 1, in place
+  Quat<real> q(1, 2, 3, 4), inv;
+  ASSERT_EQUAL(q.inverse(inv).status, SUCCESS);
+  q.multiply(inv, q);
+  ASSERT_DBL_NEAR_TOL(q.w(), 1, 1e-12);
+  ASSERT_DBL_NEAR_TOL(q.x(), 0, 1e-12);
+  ASSERT_EQUAL(Quat<real>(0, 0, 0, 0).inverse(inv).status, ARG_ERROR);
+  Quat<real> c;
+  ASSERT_EQUAL(Quat<real>(1, 2, 3, 4).conjugate(c).status, SUCCESS);
+  ASSERT_EQUAL(c.x(), -1);
+  ASSERT_EQUAL(c.w(), 4);
+  real l = 0;
+  ASSERT_EQUAL(Quat<real>(1, 1, 1, 1).length(l).status, SUCCESS);
+  ASSERT_EQUAL(l, 2);
+  Quat<real> u;
+  ASSERT_EQUAL(Quat<real>(1, 1, 1, 1).normalize(u).status, SUCCESS);
+  ASSERT_EQUAL(u.y(), 0.5);
+}
+
+/*! @{ testing rotations
+ */
+CTEST(suite, test_quat_rotate) {
+  Quat<real> q;
+  Quat<real>::from_axis_angle(VecN<real, 3>(std::array<real, 3>{0, 0, 1}),
+                              pi / 2, q);
+  VecN<real, 3> v(std::array<real, 3>{1, 0, 0}), out;
+  ASSERT_EQUAL(q.rotate(v, out).status, SUCCESS);
+  ASSERT_DBL_NEAR_TOL(out.eval(0), 0, 1e-12);
+  ASSERT_DBL_NEAR_TOL(out.eval(1), 1, 1e-12);
+  // the same rotation as q v q*, in place
+  Quat<real> r = turn(0.7), conj, tmp;
+  VecN<real, 3> w(std::array<real, 3>{0.3, -1.2, 2.5});
+  r.conjugate(conj);
+  r.multiply(Quat<real>(0.3, -1.2, 2.5, 0), tmp);
+  tmp.multiply(conj, tmp);
+  r.rotate(w, w);
+  ASSERT_DBL_NEAR_TOL(w.eval(0), tmp.x(), 1e-12);
+  ASSERT_DBL_NEAR_TOL(w.eval(1), tmp.y(), 1e-12);
+  ASSERT_DBL_NEAR_TOL(w.eval(2), tmp.z(), 1e-12);
+  // and the same as the rotation matrix
+  MatNM<real, 3, 3> m;
+  ASSERT_EQUAL(r.to_matrix(m).status, SUCCESS);
+  VecN<real, 3> mw;
+  m.multiply(VecN<real, 3>(std::array<real, 3>{0.3, -1.2, 2.5}), mw);
+  for (unsigned int k = 0; k < 3; k++) {
+    ASSERT_DBL_NEAR_TOL(mw.eval(k), w.eval(k), 1e-12);
+  }
+}
+
+/*! @{ testing interpolation
+ */
+CTEST(suite, test_quat_interpolate) {
+  Quat<real> a = turn(0.2), b = turn(1.4), out;
+  ASSERT_EQUAL(a.slerp(b, 0.25, out).status, SUCCESS);
+  Quat<real> expect = turn(0.5);
+  ASSERT_DBL_NEAR_TOL(out.x(), expect.x(), 1e-12);
+  ASSERT_DBL_NEAR_TOL(out.w(), expect.w(), 1e-12);
+  // -b is the same rotation, the shorter arc gives the same result
+  Quat<real> nb(-b.x(), -b.y(), -b.z(), -b.w());
+  a.slerp(nb, 0.25, out);
+  ASSERT_DBL_NEAR_TOL(out.y(), expect.y(), 1e-12);
+  // nlerp has the right end points and unit length
+  ASSERT_EQUAL(a.nlerp(b, 1, out).status, SUCCESS);
+  ASSERT_DBL_NEAR_TOL(out.z(), b.z(), 1e-12);
+  a.nlerp(b, 0.5, out);
+  real l = 0;
+  out.length(l);
+  ASSERT_DBL_NEAR_TOL(l, 1, 1e-12);
+  // nearly equal inputs take the nlerp path
+  a.slerp(turn(0.2001), 0.5, out);
+  ASSERT_DBL_NEAR_TOL(out.w(), turn(0.20005).w(), 1e-9);
+}
+
+/*! @{ testing the batched operations against Quat
+ */
+CTEST(suite, test_quat_batch) {
+  // more than a register of each width plus a tail
+  const std::size_t n = 37;
+  VecNArray<real, 4> qa(n), qb(n);
+  VecNArray<real, 3> v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    Quat<real> a = turn(0.1 * i), b = turn(-0.05 * i);
+    qa.set(i, a.coeffs());
+    qb.set(i, b.coeffs());
+    v.set(i, VecN<real, 3>(std::array<real, 3>{real(i), 1, -2}));
+  }
+  VecNArray<real, 4> prod;
+  VecNArray<real, 3> rotated;
+  simd::isa_t best = simd::detect_isa();
+  for (int isa = simd::ISA_SCALAR; isa <= best; isa++) {
+    simd::set_isa(static_cast<simd::isa_t>(isa));
+    ASSERT_EQUAL(quat::multiply(qa, qb, prod).status, SUCCESS);
+    ASSERT_EQUAL(quat::rotate(qa, v, rotated).status, SUCCESS);
+    for (std::size_t i = 0; i < n; i++) {
+      VecN<real, 4> a, b, p;
+      VecN<real, 3> x, r, got;
+      qa.get(i, a);
+      qb.get(i, b);
+      prod.get(i, p);
+      v.get(i, x);
+      rotated.get(i, got);
+      Quat<real> expect;
+      Quat<real>(a).multiply(Quat<real>(b), expect);
+      Quat<real>(a).rotate(x, r);
+      for (unsigned int k = 0; k < 4; k++) {
+        ASSERT_DBL_NEAR_TOL(p.eval(k), expect.coeffs().eval(k), 1e-12);
+      }
+      for (unsigned int k = 0; k < 3; k++) {
+        ASSERT_DBL_NEAR_TOL(got.eval(k), r.eval(k), 1e-12);
+      }
+    }
+  }
+  simd::set_isa(best);
+  // one quaternion over the batch, in place
+  Quat<real> q = turn(0.9);
+  VecNArray<real, 3> w(v);
+  ASSERT_EQUAL(q.rotate(w, w).status, SUCCESS);
+  VecN<real, 3> x, r, got;
+  v.get(5, x);
+  w.get(5, got);
+  q.rotate(x, r);
+  ASSERT_DBL_NEAR_TOL(got.eval(1), r.eval(1), 1e-12);
+  // interpolation, in place
+  VecNArray<real, 4> s(qa);
+  ASSERT_EQUAL(quat::slerp(s, qb, real(0.5), s).status, SUCCESS);
+  ASSERT_EQUAL(quat::nlerp(qa, qb, real(0.5), prod).status, SUCCESS);
+  VecN<real, 4> a, b, sg, ng;
+  qa.get(9, a);
+  qb.get(9, b);
+  s.get(9, sg);
+  prod.get(9, ng);
+  Quat<real> se, ne;
+  Quat<real>(a).slerp(Quat<real>(b), 0.5, se);
+  Quat<real>(a).nlerp(Quat<real>(b), 0.5, ne);
+  ASSERT_DBL_NEAR_TOL(sg.eval(3), se.w(), 1e-12);
+  ASSERT_DBL_NEAR_TOL(ng.eval(0), ne.x(), 1e-12);
+  VecNArray<real, 4> shorter(n - 1);
+  ASSERT_EQUAL(quat::multiply(qa, shorter, prod).status, SIZE_ERROR);
+  ASSERT_EQUAL(quat::rotate(shorter, v, rotated).status, SIZE_ERROR);
+}
@@ -0,0 +1,247 @@
+// test file for the SIMD backend
+#include "../vepp.hpp"
+#include <ctest.h>
+#include <cmath>
+#include <cstdint>
+
+/*! @{
+ */
+
+using namespace vepp;
+
+/** deterministic pseudo random values, never zero so division is safe*/
+template <class T> static std::vector<T> sample(std::size_t n, unsigned int seed) {
+  std::vector<T> out(n);
+  std::uint32_t x = seed * 2654435761u + 1;
+  for (std::size_t i = 0; i < n; i++) {
+    x = x * 1664525u + 1013904223u;
+    int v = static_cast<int>((x >> 8) % 200) - 100;
+    out[i] = static_cast<T>(v == 0 ? 7 : v) / static_cast<T>(4);
+  }
+  return out;
+}
+template <> std::vector<std::int32_t> sample(std::size_t n, unsigned int seed) {
+  std::vector<std::int32_t> out(n);
+  std::uint32_t x = seed * 2654435761u + 1;
+  for (std::size_t i = 0; i < n; i++) {
+    x = x * 1664525u + 1013904223u;
+    int v = static_cast<int>((x >> 8) % 200) - 100;
+    out[i] = v == 0 ? 7 : v;
+  }
+  return out;
+}
+
+template <class T> static bool near(T expected, T actual, double tol) {
+  double e = static_cast<double>(expected);
+  double a = static_cast<double>(actual);
+  return std::fabs(e - a) <= tol * (1.0 + std::fabs(e));
+}
+
+/** runs every bulk kernel of the active instruction set over sizes and
+ * offsets that exercise the vector body and the scalar tail, true if all
+ * match the scalar reference within tol*/
+template <class T> static bool check_bulk(double tol) {
+  const simd::Kernels<T> ref = simd::scalar_kernels<T>();
+  for (std::size_t n = 0; n < 140; n += (n < 40 ? 1 : 13)) {
+    for (std::size_t offset = 0; offset < 3; offset++) {
+      std::vector<T> a = sample<T>(n + offset, 1 + n);
+      std::vector<T> b = sample<T>(n + offset, 100 + n);
+      std::vector<T> o(n + offset), r(n + offset);
+      const T *pa = a.data() + offset;
+      const T *pb = b.data() + offset;
+      T s = n > 0 ? pb[0] : static_cast<T>(3);
+      typedef void (*binary_fn)(const T *, const T *, T *, std::size_t);
+      typedef void (*scalar_fn)(const T *, T, T *, std::size_t);
+      binary_fn simd_bin[4] = {simd::add<T>, simd::subtract<T>,
+                               simd::multiply<T>, simd::divide<T>};
+      binary_fn ref_bin[4] = {ref.add, ref.subtract, ref.multiply, ref.divide};
+      scalar_fn simd_sc[4] = {simd::add<T>, simd::subtract<T>,
+                              simd::multiply<T>, simd::divide<T>};
+      scalar_fn ref_sc[4] = {ref.add_scalar, ref.subtract_scalar,
+                             ref.multiply_scalar, ref.divide_scalar};
+      for (int op = 0; op < 4; op++) {
+        simd_bin[op](pa, pb, o.data() + offset, n);
+        ref_bin[op](pa, pb, r.data() + offset, n);
+        for (std::size_t i = offset; i < n + offset; i++) {
+          if (!near(r[i], o[i], tol))
+            return false;
+        }
+        simd_sc[op](pa, s, o.data() + offset, n);
+        ref_sc[op](pa, s, r.data() + offset, n);
+        for (std::size_t i = offset; i < n + offset; i++) {
+          if (!near(r[i], o[i], tol))
+            return false;
+        }
+      }
+      if (!near(ref.dot(pa, pb, n), simd::dot(pa, pb, n), tol))
+        return false;
+      // fused kernels, the third operand is a reversed
+      std::vector<T> c(a.rbegin(), a.rend());
+      const T *pc = c.data() + offset;
+      simd::fma(pa, pb, pc, o.data() + offset, n);
+      ref.fma(pa, pb, pc, r.data() + offset, n);
+      for (std::size_t i = offset; i < n + offset; i++) {
+        if (!near(r[i], o[i], tol))
+          return false;
+      }
+      simd::axpy(s, pa, pb, o.data() + offset, n);
+      ref.axpy(s, pa, pb, r.data() + offset, n);
+      for (std::size_t i = offset; i < n + offset; i++) {
+        if (!near(r[i], o[i], tol))
+          return false;
+      }
+      simd::axpby(s, pa, s + 1, pb, o.data() + offset, n);
+      ref.axpby(s, pa, s + 1, pb, r.data() + offset, n);
+      for (std::size_t i = offset; i < n + offset; i++) {
+        if (!near(r[i], o[i], tol))
+          return false;
+      }
+      // 3 x 4 transform over four input lanes
+      std::vector<T> m = sample<T>(12, 7 + n);
+      std::vector<std::vector<T>> in(4), to(3), tr(3);
+      const T *pin[4];
+      T *pto[3], *ptr[3];
+      for (unsigned int k = 0; k < 4; k++) {
+        in[k] = sample<T>(n + offset, 200 + k);
+        pin[k] = in[k].data() + offset;
+      }
+      for (unsigned int r = 0; r < 3; r++) {
+        to[r].resize(n + offset);
+        tr[r].resize(n + offset);
+        pto[r] = to[r].data() + offset;
+        ptr[r] = tr[r].data() + offset;
+      }
+      simd::transform(m.data(), 3, 4, pin, pto, n);
+      ref.transform(m.data(), 3, 4, pin, ptr, n);
+      for (unsigned int r = 0; r < 3; r++) {
+        for (std::size_t i = 0; i < n; i++) {
+          if (!near(ptr[r][i], pto[r][i], tol))
+            return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+template <class T, unsigned int N> static bool check_fixed(double tol) {
+  std::vector<T> a = sample<T>(N, N);
+  std::vector<T> b = sample<T>(N, N + 50);
+  T ref = simd::scalar::dot(a.data(), b.data(), N);
+  return near(ref, simd::dot_n<T, N>(a.data(), b.data()), tol);
+}
+
+template <class T, unsigned int R, unsigned int C>
+static bool check_matvec(double tol) {
+  std::vector<T> m = sample<T>(R * C, R + C);
+  std::vector<T> v = sample<T>(C, R * C);
+  std::vector<T> out(R);
+  simd::matvec_n<T, R, C>(m.data(), v.data(), out.data());
+  for (unsigned int r = 0; r < R; r++) {
+    if (!near(simd::scalar::dot(m.data() + r * C, v.data(), C), out[r], tol))
+      return false;
+  }
+  return true;
+}
+
+template <class T, unsigned int R, unsigned int C, unsigned int K>
+static bool check_matmul(double tol) {
+  std::vector<T> a = sample<T>(R * C, R);
+  std::vector<T> b = sample<T>(C * K, K);
+  std::vector<T> out(R * K);
+  simd::matmul_n<T, R, C, K>(a.data(), b.data(), out.data());
+  for (unsigned int i = 0; i < R; i++) {
+    for (unsigned int j = 0; j < K; j++) {
+      T e = static_cast<T>(0);
+      for (unsigned int k = 0; k < C; k++) {
+        e += a[i * C + k] * b[k * K + j];
+      }
+      if (!near(e, out[i * K + j], tol))
+        return false;
+    }
+  }
+  return true;
+}
+
+template <class T> static bool check_fixed_sizes(double tol) {
+  return check_fixed<T, 1>(tol) && check_fixed<T, 2>(tol) &&
+         check_fixed<T, 3>(tol) && check_fixed<T, 4>(tol) &&
+         check_fixed<T, 5>(tol) && check_fixed<T, 7>(tol) &&
+         check_fixed<T, 8>(tol) && check_fixed<T, 16>(tol) &&
+         check_fixed<T, 64>(tol) && check_matvec<T, 3, 3>(tol) &&
+         check_matvec<T, 4, 4>(tol) && check_matvec<T, 2, 5>(tol) &&
+         check_matmul<T, 4, 4, 4>(tol) && check_matmul<T, 3, 5, 13>(tol);
+}
+
+/*! @{ testing every backend against the scalar reference
+ */
+CTEST(suite, test_simd_backends_float) {
+  simd::isa_t best = simd::detect_isa();
+  for (int isa = simd::ISA_SCALAR; isa <= best; isa++) {
+    simd::set_isa(static_cast<simd::isa_t>(isa));
+    ASSERT_EQUAL(check_bulk<float>(1e-5), true);
+  }
+  simd::set_isa(best);
+}
+CTEST(suite, test_simd_backends_double) {
+  simd::isa_t best = simd::detect_isa();
+  for (int isa = simd::ISA_SCALAR; isa <= best; isa++) {
+    simd::set_isa(static_cast<simd::isa_t>(isa));
+    ASSERT_EQUAL(check_bulk<double>(1e-12), true);
+  }
+  simd::set_isa(best);
+}
+CTEST(suite, test_simd_backends_int32) {
+  simd::isa_t best = simd::detect_isa();
+  for (int isa = simd::ISA_SCALAR; isa <= best; isa++) {
+    simd::set_isa(static_cast<simd::isa_t>(isa));
+    ASSERT_EQUAL(check_bulk<std::int32_t>(0), true);
+  }
+  simd::set_isa(best);
+}
+CTEST(suite, test_simd_set_isa_clamps) {
+  simd::isa_t best = simd::detect_isa();
+  ASSERT_EQUAL(simd::set_isa(simd::ISA_AVX512) <= best, true);
+  ASSERT_EQUAL(simd::set_isa(simd::ISA_SCALAR), simd::ISA_SCALAR);
+  simd::set_isa(best);
+  ASSERT_EQUAL(simd::active_isa(), best);
+}
+
+/*! @} */
+
+/*! @{ testing the fixed size dot products
+ */
+CTEST(suite, test_simd_fixed_dot) {
+  ASSERT_EQUAL(check_fixed_sizes<float>(1e-5), true);
+  ASSERT_EQUAL(check_fixed_sizes<double>(1e-12), true);
+  ASSERT_EQUAL(check_fixed_sizes<std::int32_t>(0), true);
+}
+CTEST(suite, test_simd_vecn_dot_padded) {
+  std::array<float, 3> a = {{1.5f, -2, 4}};
+  std::array<float, 3> b = {{2, 0.5f, -1}};
+  VecN<float, 3> va(a), vb(b);
+  float out = 0;
+  ASSERT_EQUAL(va.dot(vb, out).status, SUCCESS);
+  ASSERT_DBL_NEAR(-2.0, out);
+  std::vector<float> vbv(b.begin(), b.end());
+  ASSERT_EQUAL(va.dot(vbv, out).status, SUCCESS);
+  ASSERT_DBL_NEAR(-2.0, out);
+}
+#if VEPP_SIMD_X86
+CTEST(suite, test_simd_load_partial) {
+  // the loaded floats end the allocation, the other lanes read as zero
+  for (unsigned int n = 0; n < 4; n++) {
+    std::vector<float> v(n);
+    for (unsigned int i = 0; i < n; i++) {
+      v[i] = 1.5f + static_cast<float>(i);
+    }
+    float lanes[4] = {-1, -1, -1, -1};
+    _mm_storeu_ps(lanes, simd::load_partial_ps(v.data(), n));
+    for (unsigned int i = 0; i < 4; i++) {
+      ASSERT_EQUAL(lanes[i], i < n ? v[i] : 0.0f);
+    }
+  }
+}
+#endif
+
+/*! @} */
@@ -0,0 +1,158 @@
+// test file for the VecN storage layouts
+#include "../vepp_array.hpp"
+#include "../vepp_mat.hpp"
+#include <ctest.h>
+#include <cstdint>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+template <class V> static V ramp() {
+  std::array<typename V::value_type, V::dimension> arr;
+  for (unsigned int i = 0; i < V::dimension; i++) {
+    arr[i] = static_cast<typename V::value_type>(i + 1);
+  }
+  return V(arr);
+}
+
+template <class V> static bool padding_is_zero(const V &v) {
+  const typename V::value_type *p =
+      reinterpret_cast<const typename V::value_type *>(&v);
+  for (unsigned int i = V::dimension; i < V::lanes; i++) {
+    if (p[i] != static_cast<typename V::value_type>(0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*! @{ testing the layouts
+ */
+CTEST(suite, test_storage_layouts) {
+  ASSERT_EQUAL(sizeof(VecN<real, 3>), 3 * sizeof(real));
+  ASSERT_EQUAL(alignof(VecNAligned<real, 3, 16>), 16);
+  ASSERT_EQUAL(alignof(VecNAligned<real, 3, 32>), 32);
+  ASSERT_EQUAL(sizeof(VecNAligned<real, 3, 16>), 16);
+  ASSERT_EQUAL((VecNPadded<real, 3>::lanes), 4);
+  ASSERT_EQUAL((VecNPadded<real, 5>::lanes), 8);
+  ASSERT_EQUAL((VecNPadded<real, 4>::lanes), 4);
+  ASSERT_EQUAL(sizeof(VecNPadded<real, 3>), 16);
+  ASSERT_EQUAL(alignof(VecNPadded<real, 3>), 16);
+  ASSERT_EQUAL(alignof(VecNPadded<double, 3>), 32);
+  ASSERT_EQUAL(alignof(VecNPadded<double, 13>), 64);
+  ASSERT_EQUAL(sizeof(VecNCacheLine<real, 3>), 64);
+  ASSERT_EQUAL(alignof(VecNCacheLine<real, 3>), 64);
+  ASSERT_EQUAL(sizeof(VecNCacheLine<double, 9>), 128);
+  std::vector<VecNCacheLine<real, 3>> acc(4);
+  ASSERT_EQUAL(reinterpret_cast<std::uintptr_t>(&acc[1]) % 64, 0);
+}
+CTEST(suite, test_storage_padding_stays_zero) {
+  VecNPadded<real, 3> a;
+  ASSERT_TRUE(padding_is_zero(a));
+  VecNPadded<real, 3> b(5), c = ramp<VecNPadded<real, 3>>(), out;
+  ASSERT_TRUE(padding_is_zero(b));
+  b.add(3, out);
+  ASSERT_TRUE(padding_is_zero(out));
+  b.divide(c, out);
+  ASSERT_TRUE(padding_is_zero(out));
+  c.normalize(out);
+  ASSERT_TRUE(padding_is_zero(out));
+  out = b * c + 2;
+  ASSERT_TRUE(padding_is_zero(out));
+  std::vector<real> v(2, 1);
+  VecNPadded<real, 3> d(v);
+  ASSERT_TRUE(padding_is_zero(d));
+  VecNPadded<real, 5> e = ramp<VecNPadded<real, 5>>();
+  ASSERT_TRUE(padding_is_zero(e));
+}
+
+/*! @} */
+
+/*! @{ testing results against the packed layout
+ */
+template <class V> static void check_same_as_packed() {
+  typedef typename V::value_type T;
+  typedef VecN<T, V::dimension> P;
+  V a = ramp<V>(), b(static_cast<T>(2)), out;
+  P pa = ramp<P>(), pb(static_cast<T>(2)), pout;
+  T d = 0, pd = 0;
+  a.dot(b, d);
+  pa.dot(pb, pd);
+  ASSERT_EQUAL(d, pd);
+  a.length_squared(d);
+  pa.length_squared(pd);
+  ASSERT_EQUAL(d, pd);
+  a.multiply(b, out);
+  pa.multiply(pb, pout);
+  for (unsigned int i = 0; i < V::dimension; i++) {
+    T x = 0, y = 0;
+    out.get(i, x);
+    pout.get(i, y);
+    ASSERT_EQUAL(x, y);
+  }
+  unsigned int n = 0;
+  a.size(n);
+  ASSERT_EQUAL(n, V::dimension);
+}
+CTEST(suite, test_storage_same_results) {
+  check_same_as_packed<VecNAligned<real, 3, 16>>();
+  check_same_as_packed<VecNAligned<real, 8, 32>>();
+  check_same_as_packed<VecNPadded<real, 3>>();
+  check_same_as_packed<VecNPadded<real, 7>>();
+  check_same_as_packed<VecNPadded<double, 3>>();
+  check_same_as_packed<VecNPadded<std::int32_t, 3>>();
+  check_same_as_packed<VecNCacheLine<real, 3>>();
+  check_same_as_packed<VecNCacheLine<double, 5>>();
+}
+CTEST(suite, test_storage_cross) {
+  VecNPadded<real, 3> x = VecNPadded<real, 3>::base<0>();
+  VecNPadded<real, 3> y = VecNPadded<real, 3>::base<1>(), z;
+  x.cross(y, z);
+  real t = 0;
+  z.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(1));
+  ASSERT_TRUE(padding_is_zero(z));
+}
+CTEST(suite, test_storage_get_array) {
+  // only the N elements are copied out, not the padding lanes
+  std::array<real, 3> a{};
+  ASSERT_EQUAL((ramp<VecNPadded<real, 3>>().get(a).status), SUCCESS);
+  ASSERT_EQUAL(a[2], static_cast<real>(3));
+  std::array<double, 5> b{};
+  ASSERT_EQUAL((ramp<VecNCacheLine<double, 5>>().get(b).status), SUCCESS);
+  ASSERT_EQUAL(b[0], 1);
+  ASSERT_EQUAL(b[4], 5);
+}
+CTEST(suite, test_storage_containers) {
+  VecNArray<real, 3> arr(4, 1);
+  VecNPadded<real, 3> v = ramp<VecNPadded<real, 3>>();
+  arr.set(2, v);
+  VecNPadded<real, 3> w;
+  arr.get(2, w);
+  real t = 0;
+  w.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(3));
+  ASSERT_TRUE(padding_is_zero(w));
+  MatNM<real, 3, 3> m = MatNM<real, 3, 3>::identity();
+  VecNPadded<real, 3> out;
+  m.multiply(v, out);
+  out.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+}
+#if __cplusplus >= 201703L
+CTEST(suite, test_storage_constexpr) {
+  constexpr VecNPadded<real, 3> a(2);
+  constexpr real t = [](const VecNPadded<real, 3> &v) {
+    real d = 0;
+    v.dot(v, d);
+    return d;
+  }(a);
+  static_assert(t == 12, "constexpr dot over padded storage");
+  ASSERT_EQUAL(t, static_cast<real>(12));
+}
+#endif
+
+/*! @} */
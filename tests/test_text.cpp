@@ -0,0 +1,146 @@
+// test file for the text parser
+#include "../vepp_text.hpp"
+#include <ctest.h>
+#include <cstdio>
+#include <string>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+/** n lines "i, 2i, -i" with comments, blank lines and CR LF ends mixed
+ * in*/
+static std::string lines(std::size_t n) {
+  std::string s = "# x, y, z\n";
+  for (std::size_t i = 0; i < n; i++) {
+    s += std::to_string(i) + ", " + std::to_string(2 * i) + ",-" +
+         std::to_string(i) + (i % 3 == 0 ? "\r\n" : "\n");
+    if (i % 100 == 0) {
+      s += "\n";
+    }
+  }
+  return s;
+}
+
+static void check_lines(const VecNArray<real, 3> &out, std::size_t n) {
+  std::size_t count = 0;
+  out.size(count);
+  ASSERT_EQUAL(count, n);
+  VecN<real, 3> v;
+  for (std::size_t i = 0; i < n; i += 97) {
+    out.get(i, v);
+    ASSERT_EQUAL(v.eval(0), static_cast<real>(i));
+    ASSERT_EQUAL(v.eval(1), static_cast<real>(2 * i));
+    ASSERT_EQUAL(v.eval(2), -static_cast<real>(i));
+  }
+}
+
+/*! @{ testing the syntax
+ */
+CTEST(suite, test_text_syntax) {
+  const std::string s = "1,2,3\n"
+                        "  4 5\t6  \n"
+                        "+7 , 8.5e1,-9\n"
+                        "\n"
+                        "# comment\n"
+                        "1,,2,3\n"
+                        "1,2\n"
+                        "1,2,3,4\n"
+                        "1,x,3\n"
+                        "inf, 0x1, 1";
+  VecNArray<real, 3> out;
+  text::Stats st;
+  ASSERT_EQUAL(text::parse(s.data(), s.size(), out, st).status,
+               FORMAT_ERROR);
+  ASSERT_EQUAL(st.lines, 10);
+  ASSERT_EQUAL(st.vectors, 3);
+  ASSERT_EQUAL(st.malformed, 5);
+  ASSERT_EQUAL(st.first_malformed, 6);
+  VecN<real, 3> v;
+  out.get(1, v);
+  ASSERT_EQUAL(v.eval(2), 6);
+  out.get(2, v);
+  ASSERT_EQUAL(v.eval(0), 7);
+  ASSERT_EQUAL(v.eval(1), 85);
+  // whitespace only, integers
+  text::Format ws;
+  ws.delimiter = 0;
+  ws.comment = 0;
+  const std::string t = "1 2\n3 4\n";
+  VecNArray<int, 2> ints;
+  ASSERT_EQUAL(text::parse(t.data(), t.size(), ints, st, ws).status,
+               SUCCESS);
+  VecN<int, 2> w;
+  ints.get(1, w);
+  ASSERT_EQUAL(w.eval(0), 3);
+  const std::string c = "1,2\n";
+  ASSERT_EQUAL(text::parse(c.data(), c.size(), ints, st, ws).status,
+               FORMAT_ERROR);
+  // one sign only, after the plus from_chars would take the minus
+  const std::string signs = "+-5 1\n++5 1\n+5 -1\n";
+  ASSERT_EQUAL(text::parse(signs.data(), signs.size(), ints, st, ws).status,
+               FORMAT_ERROR);
+  ASSERT_EQUAL(st.malformed, 2);
+  ASSERT_EQUAL(st.first_malformed, 1);
+  ASSERT_EQUAL(st.vectors, 1);
+  ints.get(0, w);
+  ASSERT_EQUAL(w.eval(0), 5);
+  ASSERT_EQUAL(w.eval(1), -1);
+  VecNArray<real, 2> reals;
+  const std::string fsigns = "+-5.5 1\n";
+  ASSERT_EQUAL(text::parse(fsigns.data(), fsigns.size(), reals, st, ws).status,
+               FORMAT_ERROR);
+}
+
+/*! @{ testing parallel parsing against the serial one
+ */
+CTEST(suite, test_text_parallel) {
+  const std::size_t n = 100000;
+  std::string s = lines(n);
+  s += "bad line\n";
+  VecNArray<real, 3> serial, par;
+  text::Stats st, pst;
+  text::parse(s.data(), s.size(), serial, st);
+  parallel::Pool pool(3);
+  ASSERT_EQUAL(text::parse(pool, s.data(), s.size(), par, pst).status,
+               FORMAT_ERROR);
+  check_lines(par, n);
+  ASSERT_EQUAL(pst.lines, st.lines);
+  ASSERT_EQUAL(pst.vectors, n);
+  ASSERT_EQUAL(pst.malformed, 1);
+  ASSERT_EQUAL(pst.first_malformed, st.first_malformed);
+  ASSERT_EQUAL(pst.first_malformed, st.lines);
+}
+
+/*! @{ testing files read a chunk at a time
+ */
+CTEST(suite, test_text_file) {
+  const std::size_t n = 300000;
+  const std::string s = lines(n);
+  // larger than a chunk so lines straddle reads
+  ASSERT_TRUE(s.size() > text::chunk_bytes);
+  std::FILE *f = std::tmpfile();
+  std::fwrite(s.data(), 1, s.size(), f);
+  std::rewind(f);
+  VecNArray<real, 3> out;
+  text::Stats st;
+  ASSERT_EQUAL(text::parse(f, out, st).status, SUCCESS);
+  check_lines(out, n);
+  ASSERT_EQUAL(st.vectors, n);
+  std::rewind(f);
+  parallel::Pool pool(2);
+  ASSERT_EQUAL(text::parse(pool, f, out, st).status, SUCCESS);
+  check_lines(out, n);
+  std::fclose(f);
+  // a single line longer than a chunk, no final line feed
+  std::FILE *g = std::tmpfile();
+  std::string pad(text::chunk_bytes + 10, ' ');
+  pad += "0 0 0";
+  std::fwrite(pad.data(), 1, pad.size(), g);
+  std::rewind(g);
+  ASSERT_EQUAL(text::parse(g, out, st).status, SUCCESS);
+  check_lines(out, 1);
+  std::fclose(g);
+}
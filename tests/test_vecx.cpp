@@ -0,0 +1,260 @@
+// test file for the runtime dimension vector
+#include "../vepp_vecx.hpp"
+#define BUDGET_MAIN
+#include <budget.hpp>
+#include <ctest.h>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+typedef VecX<real, 8> Vec;
+
+static Vec ramp(std::size_t n) {
+  Vec v(n);
+  for (std::size_t i = 0; i < n; i++) {
+    v.set(i, static_cast<real>(i + 1));
+  }
+  return v;
+}
+
+/*! @{ testing storage
+ */
+CTEST(suite, test_vecx_constructors) {
+  Vec empty;
+  std::size_t n = 5;
+  ASSERT_EQUAL(empty.size(n).status, SUCCESS);
+  ASSERT_EQUAL(n, 0);
+  Vec small(4, 2);
+  ASSERT_EQUAL(small.allocated(), false);
+  Vec large(100, 3);
+  ASSERT_EQUAL(large.allocated(), true);
+  real t = 0;
+  large.get(99, t);
+  ASSERT_EQUAL(t, static_cast<real>(3));
+  ASSERT_EQUAL(large.get(100, t).status, INDEX_ERROR);
+  std::vector<real> sv(3, 7);
+  Vec from_vector(sv);
+  from_vector.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(7));
+}
+CTEST(suite, test_vecx_copy_move) {
+  Vec large = ramp(50);
+  Vec copy(large);
+  ASSERT_EQUAL(copy.allocated(), true);
+  ASSERT_TRUE(copy.elements() != large.elements());
+  const real *p = large.elements();
+  Vec moved(std::move(large));
+  ASSERT_TRUE(moved.elements() == p);
+  Vec small = ramp(3);
+  Vec small_moved(std::move(small));
+  ASSERT_EQUAL(small_moved.allocated(), false);
+  real t = 0;
+  small_moved.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(3));
+  copy = small_moved;
+  std::size_t n = 0;
+  copy.size(n);
+  ASSERT_EQUAL(n, 3);
+  copy = ramp(40);
+  copy.size(n);
+  ASSERT_EQUAL(n, 40);
+}
+CTEST(suite, test_vecx_resize) {
+  Vec v = ramp(3);
+  ASSERT_EQUAL(v.resize(20).status, SUCCESS);
+  real t = 1;
+  v.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(3));
+  v.get(19, t);
+  ASSERT_EQUAL(t, static_cast<real>(0));
+  ASSERT_EQUAL(v.allocated(), true);
+}
+
+/*! @} */
+
+/*! @{ testing VecN conversion
+ */
+CTEST(suite, test_vecx_borrow_vecn) {
+  VecN<real, 3> v(1);
+  Vec view = Vec::borrow(v);
+  ASSERT_EQUAL(view.borrowed(), true);
+  ASSERT_TRUE(view.elements() == v.elements());
+  view.set(1, 5);
+  real t = 0;
+  v.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(5));
+  // outputs write through to the VecN as well
+  view.multiply(2, view);
+  v.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(10));
+  ASSERT_EQUAL(view.resize(4).status, SIZE_ERROR);
+  Vec longer(4, 1);
+  ASSERT_EQUAL(longer.add(1, view).status, SIZE_ERROR);
+  Vec owned(view);
+  ASSERT_EQUAL(owned.borrowed(), false);
+}
+CTEST(suite, test_vecx_borrow_move_assign) {
+  // moving into a view writes through like copying, the view stays
+  VecN<real, 3> v(1);
+  Vec view = Vec::borrow(v);
+  view = Vec(3, 7);
+  ASSERT_EQUAL(view.borrowed(), true);
+  ASSERT_TRUE(view.elements() == v.elements());
+  real t = 0;
+  v.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(7));
+  // a size mismatch is a SIZE_ERROR and leaves the VecN alone
+  VecXThrow<real, 8> strict = VecXThrow<real, 8>::borrow(v);
+  status_t s = SUCCESS;
+  try {
+    strict = VecXThrow<real, 8>(4, 2);
+  } catch (const StatusError &e) {
+    s = e.status;
+  }
+  ASSERT_EQUAL(s, SIZE_ERROR);
+  ASSERT_EQUAL(strict.borrowed(), true);
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(7));
+}
+CTEST(suite, test_vecx_borrow_assign_size) {
+  // an assignment of the wrong size is never silently dropped
+  VecN<real, 3> v(1);
+  Vec view = Vec::borrow(v);
+  status_t s = SUCCESS;
+  try {
+    view = Vec(4, 2);
+  } catch (const StatusError &e) {
+    s = e.status;
+  }
+  ASSERT_EQUAL(s, SIZE_ERROR);
+  s = SUCCESS;
+  try {
+    view = Vec(2, 2);
+  } catch (const StatusError &e) {
+    s = e.status;
+  }
+  ASSERT_EQUAL(s, SIZE_ERROR);
+  VecXUnchecked<real, 8> loose = VecXUnchecked<real, 8>::borrow(v);
+  s = SUCCESS;
+  try {
+    loose = VecXUnchecked<real, 8>(4, 2);
+  } catch (const StatusError &e) {
+    s = e.status;
+  }
+  ASSERT_EQUAL(s, SIZE_ERROR);
+  // assign reports it instead
+  ASSERT_EQUAL(view.assign(Vec(4, 2)).status, SIZE_ERROR);
+  real t = 0;
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(1));
+  ASSERT_EQUAL(view.assign(Vec(3, 5)).status, SUCCESS);
+  v.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(5));
+  Vec owned(1, 0);
+  ASSERT_EQUAL(owned.assign(Vec(4, 2)).status, SUCCESS);
+  std::size_t n = 0;
+  owned.size(n);
+  ASSERT_EQUAL(n, 4);
+}
+CTEST(suite, test_vecx_vecn_copies) {
+  std::array<real, 3> arr = {{1, 2, 3}};
+  VecN<real, 3> v(arr);
+  Vec x(v);
+  ASSERT_EQUAL(x.borrowed(), false);
+  VecN<real, 3> back;
+  ASSERT_EQUAL(x.to_vecn(back).status, SUCCESS);
+  real t = 0;
+  back.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(3));
+  VecN<real, 4> wrong;
+  ASSERT_EQUAL(x.to_vecn(wrong).status, SIZE_ERROR);
+}
+
+/*! @} */
+
+/*! @{ testing arithmetic
+ */
+CTEST(suite, test_vecx_arithmetic) {
+  Vec a = ramp(20), b(20, 2), out;
+  real t = 0;
+  ASSERT_EQUAL(a.add(b, out).status, SUCCESS);
+  out.get(19, t);
+  ASSERT_EQUAL(t, static_cast<real>(22));
+  ASSERT_EQUAL(a.subtract(b, out).status, SUCCESS);
+  out.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(-1));
+  ASSERT_EQUAL(a.multiply(3, out).status, SUCCESS);
+  out.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(6));
+  ASSERT_EQUAL(a.divide(b, out).status, SUCCESS);
+  out.get(3, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  ASSERT_EQUAL(a.divide(0, out).status, ARG_ERROR);
+  Vec zeros(20);
+  ASSERT_EQUAL(a.divide(zeros, out).status, ARG_ERROR);
+  Vec shorter(5);
+  ASSERT_EQUAL(a.add(shorter, out).status, SIZE_ERROR);
+  ASSERT_EQUAL(a.apply_el(b, [](real x, real y) { return x * y + 1; }, out)
+                   .status,
+               SUCCESS);
+  out.get(4, t);
+  ASSERT_EQUAL(t, static_cast<real>(11));
+  // out may alias an operand
+  ASSERT_EQUAL(a.add(a, a).status, SUCCESS);
+  a.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(6));
+}
+CTEST(suite, test_vecx_geometry) {
+  Vec a = ramp(3);
+  real t = 0;
+  ASSERT_EQUAL(a.dot(a, t).status, SUCCESS);
+  ASSERT_EQUAL(t, static_cast<real>(14));
+  a.length(t);
+  ASSERT_DBL_NEAR_TOL(t, std::sqrt(14.0), 1e-6);
+  Vec n;
+  ASSERT_EQUAL(a.normalize(n).status, SUCCESS);
+  n.length(t);
+  ASSERT_DBL_NEAR_TOL(t, 1.0, 1e-6);
+  Vec zero(3);
+  ASSERT_EQUAL(zero.normalize(n).status, ARG_ERROR);
+  ASSERT_EQUAL(a.dot(Vec(4), t).status, SIZE_ERROR);
+}
+
+/*! @} */
+
+/*! @{ testing heap traffic
+ */
+CTEST(suite, test_vecx_inline_does_not_allocate) {
+  Vec a = ramp(8), b(8, 2), out(8);
+  real t = 0;
+  budget::Usage u = budget::measure(1000, [&]() {
+    a.add(b, out);
+    a.multiply(2, out);
+    a.dot(b, t);
+    a.normalize(out);
+    budget::keep(out);
+    budget::keep(t);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+  u = budget::measure(100, [&]() {
+    Vec tmp = ramp(8);
+    budget::keep(tmp);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+}
+CTEST(suite, test_vecx_outputs_are_reused) {
+  Vec a(1000, 1), b(1000, 2), out;
+  a.add(b, out);
+  budget::Usage u = budget::measure(100, [&]() {
+    a.add(b, out);
+    a.subtract(1, out);
+    a.divide(b, out);
+    budget::keep(out);
+  });
+  ASSERT_ALLOC_BUDGET(u, 0);
+}
+
+/*! @} */
@@ -1,6 +1,7 @@
-// test file for quaternion
+// test file for VecN
 #include "../vepp.hpp"
 #include <ctest.h>
+#include <cstring>
 
 /*! @{
  */
@@ -877,3 +878,122 @@ CTEST(suite, test_dot_vecn_t) {
 }
 
 /*! @} */
+
+/*! @{ testing the result record
+ */
+CTEST(suite, test_result_trivially_copyable) {
+  ASSERT_EQUAL(std::is_trivially_copyable<Result>::value, true);
+  VecN<real, 2> v;
+  unsigned int vsize = 5;
+  Result res = v.size(vsize);
+  Result cp;
+  std::memcpy(&cp, &res, sizeof(Result));
+  ASSERT_EQUAL(cp.status, SUCCESS);
+  ASSERT_STR("size", cp.fn_name);
+}
+CTEST(suite, test_info_m_call_name) {
+  VecN<real, 2> v;
+  real t = 0;
+  Result res;
+  INFO_M(v.get(0, t), res);
+  ASSERT_EQUAL(res.success, true);
+  ASSERT_STR("v.get(0, t)", res.call_name);
+  ASSERT_STR("get", res.fn_name);
+}
+
+/*! @} */
+
+/*! @{ testing element-wise kernels
+ */
+struct MaxFn {
+  real operator()(real a, real b) const { return a > b ? a : b; }
+};
+CTEST(suite, test_apply_el_functor_vecn) {
+  std::vector<real> inv;
+  inv.resize(3);
+  inv[0] = 1;
+  inv[1] = 5;
+  inv[2] = -2;
+  VecN<real, 3> v(inv);
+  VecN<real, 3> av(2);
+  VecN<real, 3> out;
+  auto result = v.apply_el(av, MaxFn(), out).status;
+  ASSERT_EQUAL(result, SUCCESS);
+  real t = 0;
+  out.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  out.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(5));
+  out.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+}
+CTEST(suite, test_apply_el_std_function_vector) {
+  VecN<real, 3> v(3);
+  std::vector<real> out;
+  std::function<real(real, real)> fn = [](real a, real b) { return a - b; };
+  auto result = v.apply_el(static_cast<real>(1), fn, out).status;
+  ASSERT_EQUAL(result, SUCCESS);
+  ASSERT_EQUAL(out.size(), static_cast<std::size_t>(3));
+  ASSERT_EQUAL(out[0], static_cast<real>(2));
+  ASSERT_EQUAL(out[2], static_cast<real>(2));
+}
+CTEST(suite, test_apply_el_aliased_output) {
+  VecN<real, 3> v(3);
+  auto result = v.add(v, v).status;
+  ASSERT_EQUAL(result, SUCCESS);
+  real t = 0;
+  v.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(6));
+}
+
+CTEST(suite, test_inplace_arithmetic) {
+  std::array<real, 3> arr = {{1, 2, 3}};
+  VecN<real, 3> v(arr), w(2);
+  real t = 0;
+  ASSERT_EQUAL(v.add_inplace(w).status, SUCCESS);
+  v.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(5));
+  ASSERT_EQUAL(v.subtract_inplace(w).status, SUCCESS);
+  ASSERT_EQUAL(v.multiply_inplace(static_cast<real>(4)).status, SUCCESS);
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(4));
+  ASSERT_EQUAL(v.add_inplace(static_cast<real>(1)).status, SUCCESS);
+  ASSERT_EQUAL(v.divide_inplace(static_cast<real>(0)).status, ARG_ERROR);
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(5));
+  ASSERT_EQUAL(v.divide_inplace(static_cast<real>(5)).status, SUCCESS);
+  v.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(1));
+}
+CTEST(suite, test_fused_updates) {
+  std::array<real, 3> px = {{1, 2, 3}};
+  std::array<real, 3> pv = {{0.5f, -1, 2}};
+  VecN<real, 3> pos(px), vel(pv), out;
+  real t = 0;
+  // pos += vel * dt
+  ASSERT_EQUAL(pos.axpy(static_cast<real>(2), vel).status, SUCCESS);
+  pos.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  pos.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(0));
+  ASSERT_EQUAL(pos.axpy(vel, vel).status, SUCCESS);
+  pos.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(11));
+  ASSERT_EQUAL(pos.axpby(static_cast<real>(1), vel, static_cast<real>(0.5))
+                   .status,
+               SUCCESS);
+  pos.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(7.5));
+  ASSERT_EQUAL(vel.fma(vel, pos, out).status, SUCCESS);
+  out.get(1, t);
+  ASSERT_EQUAL(t, static_cast<real>(0.5));
+  ASSERT_EQUAL(vel.fma(static_cast<real>(3), vel, out).status, SUCCESS);
+  out.get(0, t);
+  ASSERT_EQUAL(t, static_cast<real>(2));
+  // the output may be an operand
+  ASSERT_EQUAL(vel.fma(vel, vel, vel).status, SUCCESS);
+  vel.get(2, t);
+  ASSERT_EQUAL(t, static_cast<real>(6));
+}
+
+/*! @} */
@@ -0,0 +1,217 @@
+// test file for the non owning vector views
+#include "../vepp.hpp"
+#include <ctest.h>
+
+/*! @{
+ */
+
+typedef float real;
+using namespace vepp;
+
+/** two xyz points and a normal interleaved per record, as read from a
+ * vertex buffer*/
+static const unsigned int nb_records = 4;
+static const unsigned int record = 9;
+
+static std::vector<real> records() {
+  std::vector<real> buf(nb_records * record);
+  for (unsigned int i = 0; i < buf.size(); i++) {
+    buf[i] = static_cast<real>(i % 7 + 1);
+  }
+  return buf;
+}
+
+/*! @{ testing element access
+ */
+CTEST(suite, test_view_get_set) {
+  std::vector<real> buf = records();
+  ConstVecNView<real, 3> a(&buf[record]);
+  unsigned int n = 0;
+  ASSERT_EQUAL(a.size(n).status, SUCCESS);
+  ASSERT_EQUAL(n, 3);
+  real x = 0;
+  ASSERT_EQUAL(a.get(2, x).status, SUCCESS);
+  ASSERT_EQUAL(x, buf[record + 2]);
+  ASSERT_EQUAL(a.get(3, x).status, INDEX_ERROR);
+  // y components of every record, a strided view
+  VecNView<real, nb_records> ys(&buf[1], record);
+  ASSERT_EQUAL(ys.set(2, 42).status, SUCCESS);
+  ASSERT_EQUAL(buf[2 * record + 1], 42);
+  ASSERT_EQUAL(ys.set(nb_records, 42).status, INDEX_ERROR);
+}
+
+/*! @{ testing arithmetic over an interleaved buffer
+ */
+CTEST(suite, test_view_arithmetic) {
+  std::vector<real> buf = records();
+  const std::vector<real> orig = buf;
+  for (unsigned int r = 0; r < nb_records; r++) {
+    real *rec = &buf[r * record];
+    ConstVecNView<real, 3> a(rec), b(rec + 3);
+    VecNView<real, 3> out(rec + 6);
+    ASSERT_EQUAL(a.add(b, out).status, SUCCESS);
+    for (unsigned int i = 0; i < 3; i++) {
+      ASSERT_EQUAL(rec[6 + i], orig[r * record + i] + orig[r * record + 3 + i]);
+    }
+    ASSERT_EQUAL(a.subtract(b, out).status, SUCCESS);
+    ASSERT_EQUAL(rec[6], orig[r * record] - orig[r * record + 3]);
+    ASSERT_EQUAL(a.multiply(2, out).status, SUCCESS);
+    ASSERT_EQUAL(rec[7], 2 * orig[r * record + 1]);
+    ASSERT_EQUAL(a.divide(0, out).status, ARG_ERROR);
+    ASSERT_EQUAL(rec[7], 2 * orig[r * record + 1]);
+    ASSERT_EQUAL(a.divide(2, out).status, SUCCESS);
+    ASSERT_EQUAL(rec[8], orig[r * record + 2] / 2);
+  }
+  // the rest of the buffer is untouched
+  for (unsigned int r = 0; r < nb_records; r++) {
+    for (unsigned int i = 0; i < 6; i++) {
+      ASSERT_EQUAL(buf[r * record + i], orig[r * record + i]);
+    }
+  }
+}
+
+/*! @{ testing in place updates, the output overlaps an input
+ */
+CTEST(suite, test_view_in_place) {
+  real p[3] = {1, 2, 3};
+  real q[3] = {4, 5, 6};
+  VecNView<real, 3> a(p);
+  ASSERT_EQUAL(a.add(ConstVecNView<real, 3>(q), a).status, SUCCESS);
+  ASSERT_EQUAL(p[0], 5);
+  ASSERT_EQUAL(p[2], 9);
+  // the cross product reads every operand before it writes
+  real x[3] = {1, 0, 0};
+  real y[3] = {0, 1, 0};
+  VecNView<real, 3> vx(x);
+  ASSERT_EQUAL(vx.cross(ConstVecNView<real, 3>(y), vx).status, SUCCESS);
+  ASSERT_EQUAL(x[0], 0);
+  ASSERT_EQUAL(x[1], 0);
+  ASSERT_EQUAL(x[2], 1);
+}
+
+/*! @{ testing dot, cross and norms against VecN
+ */
+CTEST(suite, test_view_matches_vecn) {
+  std::vector<real> buf = records();
+  VecN<real, 3> a(std::array<real, 3>{buf[0], buf[1], buf[2]});
+  VecN<real, 3> b(std::array<real, 3>{buf[3], buf[4], buf[5]});
+  ConstVecNView<real, 3> va(&buf[0]), vb(&buf[3]);
+  real d = 0, dv = 0;
+  a.dot(b, d);
+  ASSERT_EQUAL(va.dot(vb, dv).status, SUCCESS);
+  ASSERT_EQUAL(d, dv);
+  // VecN converts to a view, views to a VecN copy
+  ASSERT_EQUAL(va.dot(b, dv).status, SUCCESS);
+  ASSERT_EQUAL(d, dv);
+  ASSERT_EQUAL(a.dot(vb, dv).status, SUCCESS);
+  ASSERT_EQUAL(d, dv);
+  VecN<real, 3> c, cv;
+  a.cross(b, c);
+  ASSERT_EQUAL(va.cross(vb, cv).status, SUCCESS);
+  for (unsigned int i = 0; i < 3; i++) {
+    ASSERT_EQUAL(c.eval(i), cv.eval(i));
+  }
+  real l = 0, lv = 0;
+  a.length(l);
+  ASSERT_EQUAL(va.length(lv).status, SUCCESS);
+  ASSERT_EQUAL(l, lv);
+  real n[3] = {0, 0, 0};
+  ASSERT_EQUAL(va.normalize(VecNView<real, 3>(n)).status, SUCCESS);
+  ASSERT_DBL_NEAR_TOL(n[0] * n[0] + n[1] * n[1] + n[2] * n[2], 1.0, 1e-6);
+  real z[3] = {0, 0, 0};
+  ConstVecNView<real, 3> vz(z);
+  ASSERT_EQUAL(vz.normalize(z).status, ARG_ERROR);
+}
+
+/*! @{ testing the kernels over strided views, computed in place
+ */
+CTEST(suite, test_view_strided_kernels) {
+  // x, y and z planes of two vectors, a = (1, 3, 5) and b = (2, 4, 6)
+  real soa[6] = {1, 2, 3, 4, 5, 6};
+  ConstVecNView<real, 3> a(&soa[0], 2), b(&soa[1], 2);
+  real d = 0;
+  ASSERT_EQUAL(a.dot(b, d).status, SUCCESS);
+  ASSERT_EQUAL(d, 44);
+  ASSERT_EQUAL(a.distance(b, d).status, SUCCESS);
+  ASSERT_DBL_NEAR_TOL(d, std::sqrt(3.0), 1e-6);
+  ASSERT_EQUAL(a.length_squared(d).status, SUCCESS);
+  ASSERT_EQUAL(d, 35);
+  // a zero in the divisor fails before anything is written
+  real z[3] = {1, 0, 1};
+  VecNView<real, 3> vb(&soa[1], 2);
+  ASSERT_EQUAL(a.divide(ConstVecNView<real, 3>(z), vb).status, ARG_ERROR);
+  ASSERT_EQUAL(soa[1], 2);
+  ASSERT_EQUAL(soa[3], 4);
+  ASSERT_EQUAL(a.divide(b, vb).status, SUCCESS);
+  ASSERT_DBL_NEAR_TOL(soa[1], 0.5, 1e-6);
+  ASSERT_DBL_NEAR_TOL(soa[5], 5.0 / 6.0, 1e-6);
+  VecNView<real, 3> va(&soa[0], 2);
+  ASSERT_EQUAL(a.normalize(va).status, SUCCESS);
+  ASSERT_DBL_NEAR_TOL(soa[0] * std::sqrt(35.0), 1.0, 1e-6);
+  ASSERT_DBL_NEAR_TOL(soa[4] * std::sqrt(35.0), 5.0, 1e-6);
+}
+
+/*! @{ testing structure of arrays views and expressions
+ */
+CTEST(suite, test_view_soa_expr) {
+  // x, y and z planes of four vectors
+  real soa[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  ConstVecNView<real, 3> v1(&soa[1], 4);
+  real out[6] = {0};
+  // writes every other element of out
+  VecNView<real, 3> o(out, 2);
+  o = v1 + v1 * 2.0f;
+  ASSERT_EQUAL(out[0], 6);
+  ASSERT_EQUAL(out[1], 0);
+  ASSERT_EQUAL(out[2], 18);
+  ASSERT_EQUAL(out[4], 30);
+  VecN<real, 3> copy = v1 - 1.0f;
+  ASSERT_EQUAL(copy.eval(2), 9);
+  VecN<real, 3> w(1.0f);
+  ASSERT_EQUAL(w.view().add(v1, w).status, SUCCESS);
+  ASSERT_EQUAL(w.eval(1), 7);
+  auto fn = [](real a, real b) { return a > b ? a : b; };
+  ASSERT_EQUAL(v1.apply_el(5.0f, fn, o).status, SUCCESS);
+  ASSERT_EQUAL(out[0], 5);
+  ASSERT_EQUAL(out[2], 6);
+}
+
+/*! @{ testing compound assignment through a view
+ */
+CTEST(suite, test_view_compound) {
+  // position and velocity interleaved per particle
+  real buf[12] = {0, 0, 0, 1, 2, 3, 1, 1, 1, -1, 0, 1};
+  for (unsigned int r = 0; r < 2; r++) {
+    VecNView<real, 3> pos(&buf[r * 6]);
+    pos += ConstVecNView<real, 3>(&buf[r * 6 + 3]) * 0.5f;
+    pos *= 2.0f;
+  }
+  ASSERT_EQUAL(buf[0], 1);
+  ASSERT_EQUAL(buf[2], 3);
+  ASSERT_EQUAL(buf[6], 1);
+  ASSERT_EQUAL(buf[8], 3);
+  ASSERT_EQUAL(buf[3], 1);
+}
+
+/*! @{ testing view to view assignment and rebind
+ */
+CTEST(suite, test_view_assign_rebind) {
+  real a[3] = {1, 2, 3};
+  real b[3] = {7, 8, 9};
+  VecNView<real, 3> va(a), vb(b);
+  // like an expression, another view is written through
+  va = vb;
+  ASSERT_EQUAL(a[0], 7);
+  ASSERT_EQUAL(a[2], 9);
+  ASSERT_TRUE(va.elements() == a);
+  b[1] = 5;
+  ASSERT_EQUAL(a[1], 8);
+  // rebind moves the handle and writes nothing
+  va.rebind(vb);
+  ASSERT_TRUE(va.elements() == b);
+  ASSERT_EQUAL(a[1], 8);
+  va.set(0, 4);
+  ASSERT_EQUAL(b[0], 4);
+  va.rebind(a + 1, 1);
+  ASSERT_EQUAL(va.eval(0), 8);
+}
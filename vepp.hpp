@@ -38,14 +38,50 @@ SOFTWARE.
 #ifndef VEPP_HPP
 #define VEPP_HPP
 #include <array>
+#include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <iostream>
 #include <math.h>
+#include <memory>
 #include <ostream>
+#include <stdexcept>
 #include <stdio.h>
+#include <string>
+#include <type_traits>
 #include <vector>
 
+#include "vepp_instrument.hpp"
+#if defined(VEPP_ASYNC_LOG)
+#include "vepp_log.hpp"
+#endif
+#include "vepp_simd.hpp"
+
+/** constexpr support
+
+  VEPP_CONSTEXPR marks what can run in constant expressions. It is only
+  enabled from C++17 on, which is the first standard where std::array
+  element writes and lambdas are constexpr, and expands to nothing for
+  older standards. VEPP_IS_CONSTANT_EVALUATED lets a method leave its
+  intrinsics path during constant evaluation. VEPP_INSTRUMENT_TIMING
+  needs a scope guard in every method, which C++17 does not allow in a
+  constexpr function, so timed builds give up constexpr.
+ */
+#if __cplusplus >= 201703L && !defined(VEPP_INSTRUMENT_TIMING)
+#define VEPP_CONSTEXPR constexpr
+#else
+#define VEPP_CONSTEXPR
+#endif
+
+#if defined(__cpp_lib_is_constant_evaluated)
+#define VEPP_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) && (__GNUC__ >= 9 || defined(__clang__))
+#define VEPP_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define VEPP_IS_CONSTANT_EVALUATED() false
+#endif
+
 namespace vepp {
 
 enum status_t : std::uint8_t {
@@ -54,68 +90,317 @@ enum status_t : std::uint8_t {
   INDEX_ERROR = 3,
   ARG_ERROR = 4,
   NOT_CALLED = 5,
-  NOT_IMPLEMENTED = 6
+  NOT_IMPLEMENTED = 6,
+  IO_ERROR = 7,
+  FORMAT_ERROR = 8,
+  /** one past the last status, not a status*/
+  STATUS_COUNT
 };
 
-/** VecN operator flags*/
+static_assert(instrument::nb_status == STATUS_COUNT,
+              "instrument::nb_status must count every status_t");
+
+/** VecN operator flags
+
+  Result is a trivially copyable record: the string fields only point to
+  static storage (__FILE__, __FUNCTION__ and stringified calls), so
+  building, copying or returning a Result never allocates.
+
+  It is 32 bytes, more than the two registers a return value gets, so it
+  is returned through the caller's stack slot: a few stores and no
+  allocation. A 16 byte {status, line, location} record would need one
+  static location per call site, and the constexpr methods cannot own a
+  static before C++23. CHECK_M and INFO_M also set the call text, line
+  and file of their own call site on the returned record.
+ */
 struct Result {
   status_t status = NOT_CALLED;
-  unsigned int line_info = 0;
-  std::string file_name = "";
-  std::string fn_name = "";
-  std::string call_name = "";
-
   bool success = false;
+  unsigned int line_info = 0;
+  const char *file_name = "";
+  const char *fn_name = "";
+  const char *call_name = "";
 
-  Result() {}
-  Result(unsigned int l, const std::string &f, const std::string &fn,
-         status_t s)
-      : status(s), line_info(l), file_name(f), fn_name(fn),
-        success(s == SUCCESS) {}
-  Result(unsigned int l, const char *f, const char *fn, status_t s)
-      : status(s), line_info(l), file_name(f), fn_name(fn),
-        success(s == SUCCESS) {}
+  VEPP_CONSTEXPR Result() {}
+  VEPP_CONSTEXPR Result(unsigned int l, const char *f, const char *fn, status_t s)
+      : status(s), success(s == SUCCESS), line_info(l), file_name(f),
+        fn_name(fn) {}
 };
 
-std::ostream &operator<<(std::ostream &out, const Result &flag) {
-  switch (flag.status) {
-  case SUCCESS: {
-    out << "SUCCESS";
-    break;
-  }
-  case INDEX_ERROR: {
-    out << "INDEX_ERROR";
-    break;
-  }
-  case ARG_ERROR: {
-    out << "ARG_ERROR";
+static_assert(std::is_trivially_copyable<Result>::value,
+              "Result must stay trivially copyable");
+static_assert(sizeof(Result) <= 4 * sizeof(void *),
+              "Result must stay within four words");
+
+inline const char *status_name(status_t status) {
+  switch (status) {
+  case SUCCESS:
+    return "SUCCESS";
+  case INDEX_ERROR:
+    return "INDEX_ERROR";
+  case ARG_ERROR:
+    return "ARG_ERROR";
+  case SIZE_ERROR:
+    return "SIZE_ERROR";
+  case NOT_CALLED:
+    return "NOT_CALLED";
+  case NOT_IMPLEMENTED:
+    return "NOT_IMPLEMENTED";
+  case IO_ERROR:
+    return "IO_ERROR";
+  case FORMAT_ERROR:
+    return "FORMAT_ERROR";
+  case STATUS_COUNT:
     break;
   }
-  case SIZE_ERROR: {
-    out << "SIZE_ERROR";
-    break;
+  return "UNKNOWN";
+}
+
+inline std::ostream &operator<<(std::ostream &out, const Result &flag) {
+  out << status_name(flag.status);
+  return out;
+}
+
+/** exception thrown by VecN under ThrowPolicy*/
+class StatusError : public std::runtime_error {
+public:
+  status_t status;
+  explicit StatusError(status_t s)
+      : std::runtime_error(std::string("vepp: ") + status_name(s)),
+        status(s) {}
+};
+
+/** VecN error policies
+
+  A policy decides what happens when a precondition of a VecN method
+  (index bounds, argument sizes, zero division) does not hold.
+  `enabled` tells whether the precondition is checked at all and
+  `fail` returns true if the failure should be reported through the
+  returned Result.
+ */
+struct CheckedPolicy {
+  static const bool enabled = true;
+  static VEPP_CONSTEXPR bool fail(status_t) { return true; }
+};
+
+/** failures throw a StatusError, the returned Result is always SUCCESS*/
+struct ThrowPolicy {
+  static const bool enabled = true;
+  static bool fail(status_t s) { throw StatusError(s); }
+};
+
+/** failures assert in debug builds, nothing is checked with NDEBUG*/
+struct AssertPolicy {
+#ifdef NDEBUG
+  static const bool enabled = false;
+#else
+  static const bool enabled = true;
+#endif
+  static bool fail(status_t) {
+    assert(!"vepp: VecN precondition failed");
+    return false;
   }
-  case NOT_CALLED: {
-    out << "NOT_CALLED";
-    break;
+};
+
+/** nothing is checked, methods compile down to plain array access*/
+struct UncheckedPolicy {
+  static const bool enabled = false;
+  static VEPP_CONSTEXPR bool fail(status_t) { return false; }
+};
+
+/** applies an error policy to a precondition, true when the call has to
+ * stop and report the failure through its Result*/
+template <class Policy>
+VEPP_CONSTEXPR bool policy_fails(bool ok, status_t s) {
+  if (Policy::enabled && !ok) {
+    VEPP_PROBE_FAIL(s);
+    return Policy::fail(s);
   }
-  case NOT_IMPLEMENTED: {
-    out << "NOT_IMPLEMENTED";
-    break;
+  return false;
+}
+
+/** counts s in the instrument failure counters unless it is SUCCESS, for
+ * the I/O and parsing calls whose status is computed rather than checked
+ * against a precondition*/
+inline status_t probe_status(status_t s) {
+  if (s != SUCCESS) {
+    VEPP_PROBE_FAIL(s);
   }
+  return s;
+}
+
+/** expression templates
+
+  VecExpr is the base of every vector expression. The arithmetic
+  operators only build expression nodes that hold their operands; the
+  whole expression is evaluated element by element in one loop when it
+  is assigned to a VecN, so no intermediate VecN is created. Operators
+  do not check their arguments (a zero division gives inf/nan as with
+  plain arithmetic), the Result returning methods remain the checked API.
+ */
+template <class E> struct VecExpr {
+  VEPP_CONSTEXPR const E &self() const { return static_cast<const E &>(*this); }
+};
+
+/** VecN storage layouts
+
+  Packed keeps the N elements as they are and is the default. Aligned<A>
+  aligns them to A bytes. Padded rounds the number of lanes up to a power
+  of two, aligns the vector to its size (at most 64 bytes) and keeps the
+  extra lanes zero, so reductions can run over full registers without a
+  tail. CacheLine gives a vector its own 64 byte line(s), for per thread
+  accumulators that must not share a line.
+ */
+namespace storage {
+struct Packed {};
+template <unsigned int Align> struct Aligned {
+  static_assert(Align != 0 && (Align & (Align - 1)) == 0,
+                "alignment must be a power of two");
+};
+struct Padded {};
+struct CacheLine {};
+
+/** smallest power of two not below n*/
+template <unsigned int n, unsigned int p = 1, bool done = (p >= n)>
+struct pow2_ceil {
+  static const unsigned int value = pow2_ceil<n, p * 2>::value;
+};
+template <unsigned int n, unsigned int p> struct pow2_ceil<n, p, true> {
+  static const unsigned int value = p;
+};
+
+template <class T, unsigned int N, class S> struct traits;
+template <class T, unsigned int N> struct traits<T, N, Packed> {
+  static const unsigned int lanes = N;
+  static const std::size_t alignment = alignof(T);
+};
+template <class T, unsigned int N, unsigned int A>
+struct traits<T, N, Aligned<A>> {
+  static const unsigned int lanes = N;
+  static const std::size_t alignment = A < alignof(T) ? alignof(T) : A;
+};
+template <class T, unsigned int N> struct traits<T, N, Padded> {
+  static const unsigned int lanes = pow2_ceil<N>::value;
+  static const std::size_t bytes = lanes * sizeof(T);
+  static const std::size_t alignment =
+      bytes > 64 ? 64 : (bytes < alignof(T) ? alignof(T) : bytes);
+};
+template <class T, unsigned int N> struct traits<T, N, CacheLine> {
+  static const unsigned int lanes = N;
+  static const std::size_t alignment = 64;
+};
+} // namespace storage
+
+template <class T, unsigned int N, class Policy, class Storage> class VecN;
+template <class T, unsigned int N, class Policy> class ConstVecNView;
+template <class T, unsigned int N, class Policy> class VecNView;
+
+/** expression operands are stored by value except VecN which is
+ * referenced*/
+template <class E> struct expr_ref { typedef const E type; };
+template <class T, unsigned int N, class Policy, class Storage>
+struct expr_ref<VecN<T, N, Policy, Storage>> {
+  typedef const VecN<T, N, Policy, Storage> &type;
+};
+
+namespace ops {
+struct Add {
+  template <class T> static VEPP_CONSTEXPR T apply(T a, T b) { return a + b; }
+};
+struct Subtract {
+  template <class T> static VEPP_CONSTEXPR T apply(T a, T b) { return a - b; }
+};
+struct Multiply {
+  template <class T> static VEPP_CONSTEXPR T apply(T a, T b) { return a * b; }
+};
+struct Divide {
+  template <class T> static VEPP_CONSTEXPR T apply(T a, T b) { return a / b; }
+};
+
+/** a * b + c, rounded once for float and double when the target has a
+ * fast fused multiply-add (-mfma, -march=native), so the compiler does
+ * not have to be allowed to contract the expression*/
+template <class T> VEPP_CONSTEXPR T fmadd(T a, T b, T c) {
+#if defined(__FP_FAST_FMA) && defined(__FP_FAST_FMAF)
+  if ((std::is_same<T, float>::value || std::is_same<T, double>::value) &&
+      !VEPP_IS_CONSTANT_EVALUATED()) {
+    return static_cast<T>(std::fma(a, b, c));
   }
-  return out;
+#endif
+  return a * b + c;
 }
+} // namespace ops
+
+/** scalar operand broadcast to every element*/
+template <class T, unsigned int N>
+class VecScalar : public VecExpr<VecScalar<T, N>> {
+  T value;
+
+public:
+  typedef T value_type;
+  static const unsigned int dimension = N;
+  VEPP_CONSTEXPR explicit VecScalar(T v) : value(v) {}
+  VEPP_CONSTEXPR T eval(unsigned int) const { return value; }
+};
+
+/** element-wise binary operation node*/
+template <class L, class R, class Op>
+class VecBinExpr : public VecExpr<VecBinExpr<L, R, Op>> {
+  typename expr_ref<L>::type lhs;
+  typename expr_ref<R>::type rhs;
+
+public:
+  typedef typename L::value_type value_type;
+  static const unsigned int dimension = L::dimension;
+  static_assert(L::dimension == R::dimension,
+                "vector expression operands differ in dimension");
+  static_assert(
+      std::is_same<typename L::value_type, typename R::value_type>::value,
+      "vector expression operands differ in value type");
+
+  VEPP_CONSTEXPR VecBinExpr(const L &l, const R &r) : lhs(l), rhs(r) {}
+  VEPP_CONSTEXPR value_type eval(unsigned int i) const {
+    return Op::apply(lhs.eval(i), rhs.eval(i));
+  }
+};
+
+template <class T, unsigned int N, class Policy = CheckedPolicy,
+          class Storage = storage::Packed>
+class VecN : public VecExpr<VecN<T, N, Policy, Storage>> {
+  typedef storage::traits<T, N, Storage> layout;
+
+  /** holds the vector data, lanes past N are zero*/
+  alignas(layout::alignment) std::array<T, layout::lanes> data;
 
-template <class T, unsigned int N> class VecN {
-  /** holds the vector data*/
-  std::array<T, N> data;
+  /** lanes fill whole 16 byte registers from an aligned address*/
+  static const bool aligned_lanes =
+      layout::alignment >= 16 && (layout::lanes * sizeof(T)) % 16 == 0;
+
+  VEPP_CONSTEXPR void store(const std::array<T, N> &arr) {
+    for (unsigned int i = 0; i < N; i++) {
+      data[i] = arr[i];
+    }
+  }
+  void clear_padding() {
+    for (unsigned int i = N; i < layout::lanes; i++) {
+      data[i] = static_cast<T>(0);
+    }
+  }
 
 public:
+  typedef T value_type;
+  static const unsigned int dimension = N;
+
+  /** number of stored lanes, N plus the zero padding*/
+  static const unsigned int lanes = layout::lanes;
+
   /*! Tested */
-  VecN() {}
+  /** zero, an output built by default never holds indeterminate values*/
+  VEPP_CONSTEXPR VecN() : data() {}
   /*! Tested */
-  VecN(const std::vector<T> &vd) {
+  template <class A = std::allocator<T>>
+  VecN(const std::vector<T, A> &vd) {
+    clear_padding();
     int nb_s = vd.size() - N;
     if (nb_s > 0) {
       // vector size is bigger than current vector
@@ -133,36 +418,72 @@ public:
       }
     }
   } /*! Tested */
-  VecN(const std::array<T, N> &arr) : data(arr) {}
-  VecN(T s) {
+  VEPP_CONSTEXPR VecN(const std::array<T, N> &arr) : data() { store(arr); }
+  VEPP_CONSTEXPR VecN(T s) : data() {
     for (unsigned int i = 0; i < N; i++) {
       data[i] = static_cast<T>(s);
     }
   }
+  /** evaluates a vector expression in a single loop*/
+  template <class E> VEPP_CONSTEXPR VecN(const VecExpr<E> &e) : data() {
+    static_assert(E::dimension == N, "expression dimension differs");
+    const E &expr = e.self();
+    for (unsigned int i = 0; i < N; i++) {
+      data[i] = expr.eval(i);
+    }
+  }
+  template <class E> VEPP_CONSTEXPR VecN &operator=(const VecExpr<E> &e) {
+    static_assert(E::dimension == N, "expression dimension differs");
+    const E &expr = e.self();
+    std::array<T, N> out{};
+    for (unsigned int i = 0; i < N; i++) {
+      out[i] = expr.eval(i);
+    }
+    store(out);
+    return *this;
+  }
+  /** unchecked element read used by vector expressions*/
+  VEPP_CONSTEXPR T eval(unsigned int i) const { return data[i]; }
+  /** contiguous storage of the N elements, for zero copy views*/
+  VEPP_CONSTEXPR const T *elements() const { return data.data(); }
+  VEPP_CONSTEXPR T *elements() { return data.data(); }
+  /** non owning views of the N elements*/
+  ConstVecNView<T, N, Policy> view() const {
+    return ConstVecNView<T, N, Policy>(data.data());
+  }
+  VecNView<T, N, Policy> view() { return VecNView<T, N, Policy>(data.data()); }
   /*! Tested */
-  Result size(unsigned int &out) const {
-    out = static_cast<unsigned int>(data.size());
+  VEPP_CONSTEXPR Result size(unsigned int &out) const {
+    out = N;
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
   /*! Tested */
-  Result get(unsigned int index, T &out) const {
-    if (index >= data.size()) {
+  VEPP_CONSTEXPR Result get(unsigned int index, T &out) const {
+    VEPP_PROBE(OP_GET);
+    if (policy_fails<Policy>(index < N, INDEX_ERROR)) {
       Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
       return vflag;
     }
-    out = data[index];
+    // through the pointer: GCC 12 folds the identical get of another N
+    // into this one and then checks index against that N's array
+    out = data.data()[index];
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
-  Result get(std::array<T, N> &out) const {
-    out = data;
+  VEPP_CONSTEXPR Result get(std::array<T, N> &out) const {
+    VEPP_PROBE(OP_GET);
+    // data holds lanes >= N values, the padding is not copied
+    for (unsigned int i = 0; i < N; i++) {
+      out[i] = data[i];
+    }
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
   /*! Tested */
-  Result set(unsigned int index, T el) {
-    if (index >= data.size()) {
+  VEPP_CONSTEXPR Result set(unsigned int index, T el) {
+    VEPP_PROBE(OP_SET);
+    if (policy_fails<Policy>(index < N, INDEX_ERROR)) {
       Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
       return vflag;
     }
@@ -172,18 +493,18 @@ public:
     return vflag;
   }
   /*! Tested */
+  template <class A>
   static Result base(unsigned int nb_dimensions, unsigned int base_order,
-                     std::vector<T> &out) {
-    if (base_order >= nb_dimensions) {
+                     std::vector<T, A> &out) {
+    VEPP_PROBE(OP_BASE);
+    if (policy_fails<Policy>(base_order < nb_dimensions, ARG_ERROR)) {
 
       Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
       return vflag;
     }
     //
-    if (out.size() != nb_dimensions) {
-      out.clear();
-      out.resize(static_cast<std::size_t>(nb_dimensions));
-    }
+    // every element is written below, resize keeps the capacity
+    out.resize(static_cast<std::size_t>(nb_dimensions));
     for (unsigned int i = 0; i < nb_dimensions; i++) {
       out[i] = static_cast<T>(0);
     }
@@ -193,67 +514,113 @@ public:
     return vflag;
   }
   /*! Tested */
-  static Result base(unsigned int base_order, VecN<T, N> &vout) {
-    std::vector<T> out;
-    Result result =
-        VecN<T, N>::base(static_cast<unsigned int>(N), base_order, out);
-    if (result.status != SUCCESS)
-      return result;
-    vout = VecN<T, N>(out);
+  static VEPP_CONSTEXPR Result base(unsigned int base_order,
+                                    VecN<T, N, Policy, Storage> &vout) {
+    VEPP_PROBE(OP_BASE);
+    if (policy_fails<Policy>(base_order < N, ARG_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    for (unsigned int i = 0; i < N; i++) {
+      vout.data[i] = static_cast<T>(0);
+    }
+    vout.data[base_order] = static_cast<T>(1);
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
-  Result apply_el(T v, const std::function<T(T, T)> &fn,
-                  std::vector<T> &out) const {
-    if (out.size() != data.size()) {
-      out.resize(data.size());
+  /** basis vector of order K, the order is checked at compile time*/
+  template <unsigned int K>
+  static VEPP_CONSTEXPR VecN<T, N, Policy, Storage> base() {
+    VEPP_PROBE(OP_BASE);
+    static_assert(K < N, "basis order out of range");
+    VecN<T, N, Policy, Storage> vout(static_cast<T>(0));
+    vout.data[K] = static_cast<T>(1);
+    return vout;
+  }
+  /** element-wise kernels
+
+    The templated overloads take any callable with a T(T, T) signature so
+    lambdas and functors get inlined into the loop. The std::function
+    overloads remain for operations chosen at runtime. std::vector
+    outputs take any allocator, ie an ArenaAllocator of vepp_memory.hpp,
+    and are only resized when their size is not N.
+   */
+  template <class Fn, class A>
+  Result apply_el(T v, const Fn &fn, std::vector<T, A> &out) const {
+    VEPP_PROBE(OP_APPLY_EL);
+    if (out.size() != N) {
+      out.resize(N);
     }
-    for (unsigned int i = 0; i < data.size(); i++) {
+    for (unsigned int i = 0; i < N; i++) {
       out[i] = fn(data[i], v);
     }
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
-  Result apply_el(const std::vector<T> &v, const std::function<T(T, T)> &fn,
-                  std::vector<T> &out) const {
-    if (v.size() != data.size()) {
+  template <class Fn, class A, class B>
+  Result apply_el(const std::vector<T, A> &v, const Fn &fn,
+                  std::vector<T, B> &out) const {
+    VEPP_PROBE(OP_APPLY_EL);
+    if (policy_fails<Policy>(v.size() == N, SIZE_ERROR)) {
       Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
       return vflag;
     }
-    if (data.size() != out.size()) {
-      out.resize(data.size());
+    if (out.size() != N) {
+      out.resize(N);
     }
-    for (unsigned int i = 0; i < data.size(); i++) {
+    for (unsigned int i = 0; i < N; i++) {
       out[i] = fn(data[i], v[i]);
     }
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
-  Result apply_el(T v, const std::function<T(T, T)> &fn,
-                  VecN<T, N> &vout) const {
-    std::vector<T> out;
-    Result result = apply_el(v, fn, out);
-    if (result.status != SUCCESS) {
-      return result;
+  template <class Fn>
+  VEPP_CONSTEXPR Result apply_el(T v, const Fn &fn,
+                                 VecN<T, N, Policy, Storage> &vout) const {
+    VEPP_PROBE(OP_APPLY_EL);
+    for (unsigned int i = 0; i < N; i++) {
+      vout.data[i] = fn(data[i], v);
     }
-    vout = VecN<T, N>(out);
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
-  Result apply_el(const VecN<T, N> &v, const std::function<T(T, T)> &fn,
-                  VecN<T, N> &vout) const {
-
-    for (unsigned int i = 0; i < data.size(); i++) {
-      T tout = static_cast<T>(0);
-      v.get(i, tout);
-      vout.set(i, fn(data[i], tout));
+  template <class Fn>
+  VEPP_CONSTEXPR Result apply_el(const VecN<T, N, Policy, Storage> &v,
+                                 const Fn &fn,
+                                 VecN<T, N, Policy, Storage> &vout) const {
+    VEPP_PROBE(OP_APPLY_EL);
+    // computing into a local array lets the loop vectorize even if vout
+    // aliases one of the operands
+    std::array<T, N> out{};
+    for (unsigned int i = 0; i < N; i++) {
+      out[i] = fn(data[i], v.data[i]);
     }
+    vout.store(out);
 
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
+  Result apply_el(T v, const std::function<T(T, T)> &fn,
+                  std::vector<T> &out) const {
+    return apply_el<std::function<T(T, T)>, std::allocator<T>>(v, fn, out);
+  }
+  Result apply_el(const std::vector<T> &v, const std::function<T(T, T)> &fn,
+                  std::vector<T> &out) const {
+    typedef std::allocator<T> A;
+    return apply_el<std::function<T(T, T)>, A, A>(v, fn, out);
+  }
+  Result apply_el(T v, const std::function<T(T, T)> &fn,
+                  VecN<T, N, Policy, Storage> &vout) const {
+    return apply_el<std::function<T(T, T)>>(v, fn, vout);
+  }
+  Result apply_el(const VecN<T, N, Policy, Storage> &v,
+                  const std::function<T(T, T)> &fn,
+                  VecN<T, N, Policy, Storage> &vout) const {
+    return apply_el<std::function<T(T, T)>>(v, fn, vout);
+  }
   /*! Tested */
-  Result add(T v, std::vector<T> &out) const {
+  template <class A> Result add(T v, std::vector<T, A> &out) const {
+    VEPP_PROBE(OP_ADD);
     auto fn = [](T thisel, T argel) { return thisel + argel; };
     auto res = apply_el(v, fn, out);
     Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
@@ -261,7 +628,8 @@ public:
   }
 
   /*! Tested */
-  Result add(T v, VecN<T, N> &vout) const {
+  VEPP_CONSTEXPR Result add(T v, VecN<T, N, Policy, Storage> &vout) const {
+    VEPP_PROBE(OP_ADD);
     auto fn = [](T thisel, T argel) { return thisel + argel; };
     auto res = apply_el(v, fn, vout);
 
@@ -269,7 +637,9 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result add(const std::vector<T> &v, std::vector<T> &out) const {
+  template <class A = std::allocator<T>, class B>
+  Result add(const std::vector<T, A> &v, std::vector<T, B> &out) const {
+    VEPP_PROBE(OP_ADD);
     auto fn = [](T thisel, T argel) { return thisel + argel; };
     auto res = apply_el(v, fn, out);
 
@@ -277,7 +647,9 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result add(const VecN<T, N> &v, VecN<T, N> &out) const {
+  VEPP_CONSTEXPR Result add(const VecN<T, N, Policy, Storage> &v,
+                              VecN<T, N, Policy, Storage> &out) const {
+    VEPP_PROBE(OP_ADD);
     auto fn = [](T thisel, T argel) { return thisel + argel; };
     auto res = apply_el(v, fn, out);
 
@@ -285,7 +657,8 @@ public:
     return vflag;
   }
   //
-  Result subtract(T v, std::vector<T> &out) const {
+  template <class A> Result subtract(T v, std::vector<T, A> &out) const {
+    VEPP_PROBE(OP_SUBTRACT);
     auto fn = [](T thisel, T argel) { return thisel - argel; };
     auto res = apply_el(v, fn, out);
 
@@ -293,7 +666,8 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result subtract(T v, VecN<T, N> &vout) const {
+  VEPP_CONSTEXPR Result subtract(T v, VecN<T, N, Policy, Storage> &vout) const {
+    VEPP_PROBE(OP_SUBTRACT);
     auto fn = [](T thisel, T argel) { return thisel - argel; };
     auto res = apply_el(v, fn, vout);
 
@@ -301,7 +675,9 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result subtract(const std::vector<T> &v, std::vector<T> &out) const {
+  template <class A = std::allocator<T>, class B>
+  Result subtract(const std::vector<T, A> &v, std::vector<T, B> &out) const {
+    VEPP_PROBE(OP_SUBTRACT);
     auto fn = [](T thisel, T argel) { return thisel - argel; };
     auto res = apply_el(v, fn, out);
 
@@ -309,7 +685,9 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result subtract(const VecN<T, N> &v, VecN<T, N> &out) const {
+  VEPP_CONSTEXPR Result subtract(const VecN<T, N, Policy, Storage> &v,
+                              VecN<T, N, Policy, Storage> &out) const {
+    VEPP_PROBE(OP_SUBTRACT);
     auto fn = [](T thisel, T argel) { return thisel - argel; };
     auto res = apply_el(v, fn, out);
 
@@ -317,7 +695,8 @@ public:
     return vflag;
   }
   //
-  Result multiply(T v, std::vector<T> &out) const {
+  template <class A> Result multiply(T v, std::vector<T, A> &out) const {
+    VEPP_PROBE(OP_MULTIPLY);
     auto fn = [](T thisel, T argel) { return thisel * argel; };
     auto res = apply_el(v, fn, out);
 
@@ -325,7 +704,8 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result multiply(T v, VecN<T, N> &vout) const {
+  VEPP_CONSTEXPR Result multiply(T v, VecN<T, N, Policy, Storage> &vout) const {
+    VEPP_PROBE(OP_MULTIPLY);
     auto fn = [](T thisel, T argel) { return thisel * argel; };
     auto res = apply_el(v, fn, vout);
 
@@ -333,7 +713,9 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result multiply(const std::vector<T> &v, std::vector<T> &out) const {
+  template <class A = std::allocator<T>, class B>
+  Result multiply(const std::vector<T, A> &v, std::vector<T, B> &out) const {
+    VEPP_PROBE(OP_MULTIPLY);
     auto fn = [](T thisel, T argel) { return thisel * argel; };
     auto res = apply_el(v, fn, out);
 
@@ -341,7 +723,9 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result multiply(const VecN<T, N> &v, VecN<T, N> &out) const {
+  VEPP_CONSTEXPR Result multiply(const VecN<T, N, Policy, Storage> &v,
+                              VecN<T, N, Policy, Storage> &out) const {
+    VEPP_PROBE(OP_MULTIPLY);
     auto fn = [](T thisel, T argel) { return thisel * argel; };
     auto res = apply_el(v, fn, out);
 
@@ -350,8 +734,9 @@ public:
   }
 
   //
-  Result divide(T v, std::vector<T> &out) const {
-    if (v == static_cast<T>(0)) {
+  template <class A> Result divide(T v, std::vector<T, A> &out) const {
+    VEPP_PROBE(OP_DIVIDE);
+    if (policy_fails<Policy>(v != static_cast<T>(0), ARG_ERROR)) {
       Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
       return vflag;
     }
@@ -363,9 +748,10 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result divide(T v, VecN<T, N> &vout) const {
+  VEPP_CONSTEXPR Result divide(T v, VecN<T, N, Policy, Storage> &vout) const {
+    VEPP_PROBE(OP_DIVIDE);
     // check for zero division
-    if (v == static_cast<T>(0)) {
+    if (policy_fails<Policy>(v != static_cast<T>(0), ARG_ERROR)) {
       Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
       return vflag;
     }
@@ -376,9 +762,11 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result divide(const std::vector<T> &v, std::vector<T> &out) const {
-    for (unsigned int j = 0; j < v.size(); j++) {
-      if (v[j] == static_cast<T>(0)) {
+  template <class A = std::allocator<T>, class B>
+  Result divide(const std::vector<T, A> &v, std::vector<T, B> &out) const {
+    VEPP_PROBE(OP_DIVIDE);
+    for (unsigned int j = 0; Policy::enabled && j < v.size(); j++) {
+      if (policy_fails<Policy>(v[j] != static_cast<T>(0), ARG_ERROR)) {
         Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
         return vflag;
       }
@@ -390,14 +778,12 @@ public:
     return vflag;
   }
   /*! Tested */
-  Result divide(const VecN<T, N> &v, VecN<T, N> &out) const {
-    unsigned int vsize = 0;
-    v.size(vsize);
+  VEPP_CONSTEXPR Result divide(const VecN<T, N, Policy, Storage> &v,
+                              VecN<T, N, Policy, Storage> &out) const {
+    VEPP_PROBE(OP_DIVIDE);
     // check zero division
-    for (unsigned int j = 0; j < vsize; j++) {
-      T vout = static_cast<T>(0);
-      v.get(j, vout);
-      if (vout == static_cast<T>(0)) {
+    for (unsigned int j = 0; Policy::enabled && j < N; j++) {
+      if (policy_fails<Policy>(v.data[j] != static_cast<T>(0), ARG_ERROR)) {
 
         Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
         return vflag;
@@ -409,78 +795,740 @@ public:
     Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
     return vflag;
   }
-  Result dot(const T &v, T &out) const {
+  /** in place forms, the vector is both the left operand and the output*/
+  /*! Tested */
+  VEPP_CONSTEXPR Result add_inplace(T v) {
+    auto res = add(v, *this);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /*! Tested */
+  VEPP_CONSTEXPR Result add_inplace(const VecN<T, N, Policy, Storage> &v) {
+    auto res = add(v, *this);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result subtract_inplace(T v) {
+    auto res = subtract(v, *this);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /*! Tested */
+  VEPP_CONSTEXPR Result
+  subtract_inplace(const VecN<T, N, Policy, Storage> &v) {
+    auto res = subtract(v, *this);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /*! Tested */
+  VEPP_CONSTEXPR Result multiply_inplace(T v) {
+    auto res = multiply(v, *this);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result
+  multiply_inplace(const VecN<T, N, Policy, Storage> &v) {
+    auto res = multiply(v, *this);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /*! Tested */
+  VEPP_CONSTEXPR Result divide_inplace(T v) {
+    auto res = divide(v, *this);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result divide_inplace(const VecN<T, N, Policy, Storage> &v) {
+    auto res = divide(v, *this);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /** fused updates, each element is rounded once where the target has a
+   * fused multiply-add. axpy sets the vector to a * x + itself*/
+  /*! Tested */
+  VEPP_CONSTEXPR Result axpy(T a, const VecN<T, N, Policy, Storage> &x) {
+    VEPP_PROBE(OP_AXPY);
+    for (unsigned int i = 0; i < N; i++) {
+      data[i] = ops::fmadd(a, x.data[i], data[i]);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** same with one coefficient per element*/
+  /*! Tested */
+  VEPP_CONSTEXPR Result axpy(const VecN<T, N, Policy, Storage> &a,
+                             const VecN<T, N, Policy, Storage> &x) {
+    VEPP_PROBE(OP_AXPY);
+    for (unsigned int i = 0; i < N; i++) {
+      data[i] = ops::fmadd(a.data[i], x.data[i], data[i]);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** sets the vector to a * x + b * itself*/
+  /*! Tested */
+  VEPP_CONSTEXPR Result axpby(T a, const VecN<T, N, Policy, Storage> &x,
+                              T b) {
+    VEPP_PROBE(OP_AXPY);
+    for (unsigned int i = 0; i < N; i++) {
+      data[i] = ops::fmadd(a, x.data[i], b * data[i]);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** out = this * b + c, element-wise*/
+  /*! Tested */
+  VEPP_CONSTEXPR Result fma(const VecN<T, N, Policy, Storage> &b,
+                            const VecN<T, N, Policy, Storage> &c,
+                            VecN<T, N, Policy, Storage> &out) const {
+    VEPP_PROBE(OP_FMA);
+    std::array<T, N> arr{};
+    for (unsigned int i = 0; i < N; i++) {
+      arr[i] = ops::fmadd(data[i], b.data[i], c.data[i]);
+    }
+    out.store(arr);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result fma(T b, const VecN<T, N, Policy, Storage> &c,
+                            VecN<T, N, Policy, Storage> &out) const {
+    VEPP_PROBE(OP_FMA);
+    std::array<T, N> arr{};
+    for (unsigned int i = 0; i < N; i++) {
+      arr[i] = ops::fmadd(data[i], b, c.data[i]);
+    }
+    out.store(arr);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** compound operators evaluate the expression straight into the vector
+   * and, like the other operators, do not check their arguments*/
+  template <class E> VEPP_CONSTEXPR VecN &operator+=(const VecExpr<E> &e) {
+    return *this = *this + e.self();
+  }
+  template <class E> VEPP_CONSTEXPR VecN &operator-=(const VecExpr<E> &e) {
+    return *this = *this - e.self();
+  }
+  template <class E> VEPP_CONSTEXPR VecN &operator*=(const VecExpr<E> &e) {
+    return *this = *this * e.self();
+  }
+  template <class E> VEPP_CONSTEXPR VecN &operator/=(const VecExpr<E> &e) {
+    return *this = *this / e.self();
+  }
+  VEPP_CONSTEXPR VecN &operator+=(T s) { return *this = *this + s; }
+  VEPP_CONSTEXPR VecN &operator-=(T s) { return *this = *this - s; }
+  VEPP_CONSTEXPR VecN &operator*=(T s) { return *this = *this * s; }
+  VEPP_CONSTEXPR VecN &operator/=(T s) { return *this = *this / s; }
+  VEPP_CONSTEXPR Result dot(const T &v, T &out) const {
+    VEPP_PROBE(OP_DOT);
     out = static_cast<T>(0);
-    for (unsigned int i = 0; i < data.size(); i++) {
+    for (unsigned int i = 0; i < N; i++) {
       out += data[i] * v;
     }
 
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
-  Result dot(const std::vector<T> &v, T &out) const {
-    if (v.size() != data.size()) {
+  template <class A = std::allocator<T>>
+  Result dot(const std::vector<T, A> &v, T &out) const {
+    VEPP_PROBE(OP_DOT);
+    if (policy_fails<Policy>(v.size() == N, SIZE_ERROR)) {
       Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
       return vflag;
     }
-    out = static_cast<T>(0);
-    for (unsigned int i = 0; i < data.size(); i++) {
-      out += data[i] * v[i];
+    out = simd::dot_n<T, N>(data.data(), v.data());
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result dot(const VecN<T, N, Policy, Storage> &v,
+                            T &out) const {
+    VEPP_PROBE(OP_DOT);
+    if (VEPP_IS_CONSTANT_EVALUATED()) {
+      out = static_cast<T>(0);
+      for (unsigned int i = 0; i < N; i++) {
+        out += data[i] * v.data[i];
+      }
+    } else {
+      // the padding lanes are zero and add nothing
+      out = simd::dot_lanes_n<T, lanes, aligned_lanes>(data.data(),
+                                                      v.data.data());
     }
 
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
-  Result dot(const VecN<T, N> &v, T &out) const {
+  /** dot product accumulated in Acc, ie double for float vectors or
+   * float for the 16 bit floats of vepp_half.hpp*/
+  template <class Acc>
+  VEPP_CONSTEXPR Result dot(const VecN<T, N, Policy, Storage> &v,
+                            Acc &out) const {
+    VEPP_PROBE(OP_DOT);
+    Acc acc = static_cast<Acc>(0);
+    for (unsigned int i = 0; i < N; i++) {
+      acc += static_cast<Acc>(data[i]) * static_cast<Acc>(v.data[i]);
+    }
+    out = acc;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
 
-    unsigned int vsize = 0;
-    v.size(vsize);
-    // check size
-    if (vsize != data.size()) {
+  /** cross product, only defined for N = 3 and N = 7*/
+  template <class A = std::allocator<T>, class B>
+  Result cross(const std::vector<T, A> &v, std::vector<T, B> &out) const {
+    VEPP_PROBE(OP_CROSS);
+    if (policy_fails<Policy>(v.size() == N, SIZE_ERROR)) {
       Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
       return vflag;
     }
+    std::array<T, N> arr{};
+    cross_el(v.data(), arr);
+    out.assign(arr.begin(), arr.end());
 
-    out = static_cast<T>(0);
-    for (unsigned int i = 0; i < data.size(); i++) {
-      T tout = static_cast<T>(0);
-      v.get(i, tout);
-      out += data[i] * tout;
-    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result cross(const VecN<T, N, Policy, Storage> &v,
+                              VecN<T, N, Policy, Storage> &out) const {
+    VEPP_PROBE(OP_CROSS);
+    // out may alias an operand, the local array keeps the inputs intact
+    std::array<T, N> arr{};
+    cross_el(v.data.data(), arr);
+    out.store(arr);
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** scalar triple product this . (b x c), only defined for N = 3*/
+  VEPP_CONSTEXPR Result triple(const VecN<T, N, Policy, Storage> &b,
+                               const VecN<T, N, Policy, Storage> &c,
+                               T &out) const {
+    VEPP_PROBE(OP_TRIPLE);
+    static_assert(N == 3, "triple product is only defined for N = 3");
+    out = data[0] * (b.data[1] * c.data[2] - b.data[2] * c.data[1]) +
+          data[1] * (b.data[2] * c.data[0] - b.data[0] * c.data[2]) +
+          data[2] * (b.data[0] * c.data[1] - b.data[1] * c.data[0]);
 
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
+  VEPP_CONSTEXPR Result length_squared(T &out) const {
+    VEPP_PROBE(OP_LENGTH);
+    dot(*this, out);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result length(T &out) const {
+    VEPP_PROBE(OP_LENGTH);
+    T sq = static_cast<T>(0);
+    dot(*this, sq);
+    out = static_cast<T>(std::sqrt(sq));
 
-  Result cross(const std::vector<T> &v, std::vector<T> &out) const {
-    Result vflag(__LINE__, __FILE__, __FUNCTION__, NOT_IMPLEMENTED);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
-  Result cross(const VecN<T, N> &v, VecN<T, N> &out) const {
-    Result vflag(__LINE__, __FILE__, __FUNCTION__, NOT_IMPLEMENTED);
+  /** length accumulated in Acc*/
+  template <class Acc> Result length(Acc &out) const {
+    VEPP_PROBE(OP_LENGTH);
+    Acc sq = static_cast<Acc>(0);
+    dot(*this, sq);
+    out = static_cast<Acc>(std::sqrt(sq));
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** euclidean distance, accumulated in one pass without a difference
+   * vector*/
+  Result distance(const VecN<T, N, Policy, Storage> &v, T &out) const {
+    VEPP_PROBE(OP_DISTANCE);
+    T sq = static_cast<T>(0);
+    for (unsigned int i = 0; i < N; i++) {
+      T d = data[i] - v.data[i];
+      sq += d * d;
+    }
+    out = static_cast<T>(std::sqrt(sq));
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** unit vector in the same direction, a zero vector is an ARG_ERROR*/
+  Result normalize(VecN<T, N, Policy, Storage> &vout) const {
+    VEPP_PROBE(OP_NORMALIZE);
+    T sq = static_cast<T>(0);
+    dot(*this, sq);
+    if (policy_fails<Policy>(sq != static_cast<T>(0), ARG_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    T inv = static_cast<T>(1) / static_cast<T>(std::sqrt(sq));
+    for (unsigned int i = 0; i < N; i++) {
+      vout.data[i] = data[i] * inv;
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  template <class A> Result normalize(std::vector<T, A> &out) const {
+    VEPP_PROBE(OP_NORMALIZE);
+    if (out.size() != N) {
+      out.resize(N);
+    }
+    T sq = static_cast<T>(0);
+    dot(*this, sq);
+    if (policy_fails<Policy>(sq != static_cast<T>(0), ARG_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    T inv = static_cast<T>(1) / static_cast<T>(std::sqrt(sq));
+    for (unsigned int i = 0; i < N; i++) {
+      out[i] = data[i] * inv;
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
 
 private:
-  Result n_n_matrix(unsigned int n, std::vector<std::vector<T>> &out) const {
-    std::vector<std::vector<T>> mat;
-    mat.resize(n);
-    for (unsigned int i = 0; i < n; i++) {
-      std::vector<T> row;
-      row.resize(n);
-      mat[i] = row;
-      for (unsigned int j = 0; j < n; j++) {
-        mat[i][j] = static_cast<T>(0);
+  /** cross product components for N = 3 and for the seven dimensional
+   * product built on e_i x e_(i+1) = e_(i+3), indices modulo 7*/
+  VEPP_CONSTEXPR void cross_el(const T *b, std::array<T, N> &out) const {
+    static_assert(N == 3 || N == 7,
+                  "cross product is only defined for N = 3 and N = 7");
+    if (N == 3) {
+      out[0] = data[1] * b[2] - data[2] * b[1];
+      out[1] = data[2] * b[0] - data[0] * b[2];
+      out[2] = data[0] * b[1] - data[1] * b[0];
+    } else {
+      for (unsigned int i = 0; i < N; i++) {
+        const unsigned int i1 = (i + 1) % N, i2 = (i + 2) % N,
+                           i3 = (i + 3) % N, i4 = (i + 4) % N,
+                           i5 = (i + 5) % N, i6 = (i + 6) % N;
+        out[i] = data[i1] * b[i3] - data[i3] * b[i1] + data[i2] * b[i6] -
+                 data[i6] * b[i2] + data[i4] * b[i5] - data[i5] * b[i4];
+      }
+    }
+  }
+};
+
+/** non owning vector views
+
+  ConstVecNView and VecNView read and write N elements in memory owned by
+  someone else (an mmap'd file, a staging buffer, a packet) without
+  copying it into a VecN first. stride is the distance in elements between
+  two consecutive components: 1 for a packed xyz triple, the number of
+  vectors for a structure of arrays. The views are cheap handles passed by
+  value; a VecN converts to either one, so every method below accepts
+  views and VecN as inputs and outputs. The methods and expression
+  assignments compute directly over the viewed elements: the output may be
+  one of the inputs, element i being read before it is written, but not an
+  input shifted by some elements.
+ */
+template <class T, unsigned int N, class Policy = CheckedPolicy>
+class ConstVecNView : public VecExpr<ConstVecNView<T, N, Policy>> {
+protected:
+  const T *ptr;
+  std::ptrdiff_t stride;
+
+  typedef VecN<T, N, Policy> vec;
+
+  /** copies the viewed elements out, used by cross whose N is 3 or 7*/
+  vec load() const {
+    std::array<T, N> arr{};
+    for (unsigned int i = 0; i < N; i++) {
+      arr[i] = ptr[i * stride];
+    }
+    return vec(arr);
+  }
+
+public:
+  typedef T value_type;
+  static const unsigned int dimension = N;
+
+  VEPP_CONSTEXPR ConstVecNView(const T *p, std::ptrdiff_t s = 1)
+      : ptr(p), stride(s) {}
+  template <class P, class S>
+  VEPP_CONSTEXPR ConstVecNView(const VecN<T, N, P, S> &v)
+      : ptr(v.elements()), stride(1) {}
+  template <class P>
+  VEPP_CONSTEXPR ConstVecNView(const ConstVecNView<T, N, P> &v)
+      : ptr(v.elements()), stride(v.step()) {}
+
+  /** unchecked element read used by vector expressions*/
+  VEPP_CONSTEXPR T eval(unsigned int i) const { return ptr[i * stride]; }
+  VEPP_CONSTEXPR const T *elements() const { return ptr; }
+  VEPP_CONSTEXPR std::ptrdiff_t step() const { return stride; }
+
+  /*! Tested */
+  Result size(unsigned int &out) const {
+    out = N;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result get(unsigned int index, T &out) const {
+    if (policy_fails<Policy>(index < N, INDEX_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    out = ptr[index * stride];
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  template <class Fn>
+  Result apply_el(T v, const Fn &fn, VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_APPLY_EL);
+    T *o = out.elements();
+    const std::ptrdiff_t os = out.step();
+    for (unsigned int i = 0; i < N; i++) {
+      o[i * os] = fn(ptr[i * stride], v);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  template <class Fn>
+  Result apply_el(const ConstVecNView &v, const Fn &fn,
+                  VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_APPLY_EL);
+    T *o = out.elements();
+    const std::ptrdiff_t os = out.step();
+    for (unsigned int i = 0; i < N; i++) {
+      o[i * os] = fn(ptr[i * stride], v.ptr[i * v.stride]);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result add(T v, VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_ADD);
+    auto fn = [](T thisel, T argel) { return thisel + argel; };
+    auto res = apply_el(v, fn, out);
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /*! Tested */
+  Result add(const ConstVecNView &v, VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_ADD);
+    auto fn = [](T thisel, T argel) { return thisel + argel; };
+    auto res = apply_el(v, fn, out);
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  Result subtract(T v, VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_SUBTRACT);
+    auto fn = [](T thisel, T argel) { return thisel - argel; };
+    auto res = apply_el(v, fn, out);
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /*! Tested */
+  Result subtract(const ConstVecNView &v, VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_SUBTRACT);
+    auto fn = [](T thisel, T argel) { return thisel - argel; };
+    auto res = apply_el(v, fn, out);
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /*! Tested */
+  Result multiply(T v, VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_MULTIPLY);
+    auto fn = [](T thisel, T argel) { return thisel * argel; };
+    auto res = apply_el(v, fn, out);
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  Result multiply(const ConstVecNView &v, VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_MULTIPLY);
+    auto fn = [](T thisel, T argel) { return thisel * argel; };
+    auto res = apply_el(v, fn, out);
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /*! Tested */
+  Result divide(T v, VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_DIVIDE);
+    if (policy_fails<Policy>(v != static_cast<T>(0), ARG_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    auto fn = [](T thisel, T argel) { return thisel / argel; };
+    auto res = apply_el(v, fn, out);
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  Result divide(const ConstVecNView &v, VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_DIVIDE);
+    // checked before anything is written, out may be the divisor
+    for (unsigned int j = 0; Policy::enabled && j < N; j++) {
+      if (policy_fails<Policy>(v.ptr[j * v.stride] != static_cast<T>(0),
+                               ARG_ERROR)) {
+        Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+        return vflag;
       }
     }
-    out = mat;
+    auto fn = [](T thisel, T argel) { return thisel / argel; };
+    auto res = apply_el(v, fn, out);
 
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  /*! Tested */
+  Result dot(const ConstVecNView &v, T &out) const {
+    VEPP_PROBE(OP_DOT);
+    if (stride == 1 && v.stride == 1) {
+      out = simd::dot_n<T, N>(ptr, v.ptr);
+    } else {
+      out = static_cast<T>(0);
+      for (unsigned int i = 0; i < N; i++) {
+        out += ptr[i * stride] * v.ptr[i * v.stride];
+      }
+    }
     Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
     return vflag;
   }
+  /*! Tested */
+  Result cross(const ConstVecNView &v, VecNView<T, N, Policy> out) const {
+    // every component reads both operands, so the three or seven elements
+    // are loaded before out is written
+    vec o;
+    auto res = load().cross(v.load(), o);
+    out.store(o);
+
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+    return vflag;
+  }
+  Result triple(const ConstVecNView &b, const ConstVecNView &c, T &out) const {
+    VEPP_PROBE(OP_TRIPLE);
+    static_assert(N == 3, "triple product is only defined for N = 3");
+    const T b0 = b.eval(0), b1 = b.eval(1), b2 = b.eval(2);
+    const T c0 = c.eval(0), c1 = c.eval(1), c2 = c.eval(2);
+    out = eval(0) * (b1 * c2 - b2 * c1) + eval(1) * (b2 * c0 - b0 * c2) +
+          eval(2) * (b0 * c1 - b1 * c0);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result length_squared(T &out) const {
+    VEPP_PROBE(OP_LENGTH);
+    dot(*this, out);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result length(T &out) const {
+    VEPP_PROBE(OP_LENGTH);
+    T sq = static_cast<T>(0);
+    dot(*this, sq);
+    out = static_cast<T>(std::sqrt(sq));
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result distance(const ConstVecNView &v, T &out) const {
+    VEPP_PROBE(OP_DISTANCE);
+    T sq = static_cast<T>(0);
+    for (unsigned int i = 0; i < N; i++) {
+      T d = ptr[i * stride] - v.ptr[i * v.stride];
+      sq += d * d;
+    }
+    out = static_cast<T>(std::sqrt(sq));
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result normalize(VecNView<T, N, Policy> out) const {
+    VEPP_PROBE(OP_NORMALIZE);
+    T sq = static_cast<T>(0);
+    dot(*this, sq);
+    if (policy_fails<Policy>(sq != static_cast<T>(0), ARG_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    T inv = static_cast<T>(1) / static_cast<T>(std::sqrt(sq));
+    T *o = out.elements();
+    const std::ptrdiff_t os = out.step();
+    for (unsigned int i = 0; i < N; i++) {
+      o[i * os] = ptr[i * stride] * inv;
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+};
+
+template <class T, unsigned int N, class Policy = CheckedPolicy>
+class VecNView : public ConstVecNView<T, N, Policy> {
+  friend class ConstVecNView<T, N, Policy>;
+
+  typedef ConstVecNView<T, N, Policy> base_view;
+
+  /** the base keeps a const pointer, the view was built from a mutable one*/
+  T *target() const { return const_cast<T *>(this->ptr); }
+
+  template <class P, class S> void store(const VecN<T, N, P, S> &v) const {
+    T *p = target();
+    for (unsigned int i = 0; i < N; i++) {
+      p[i * this->stride] = v.eval(i);
+    }
+  }
+
+public:
+  VEPP_CONSTEXPR VecNView(T *p, std::ptrdiff_t s = 1) : base_view(p, s) {}
+  template <class P, class S>
+  VEPP_CONSTEXPR VecNView(VecN<T, N, P, S> &v) : base_view(v.elements()) {}
+  VEPP_CONSTEXPR VecNView(const VecNView &) = default;
+
+  /*! Tested */
+  /** assigning another view or an expression writes it through the view,
+   * rebind moves the handle*/
+  VecNView &operator=(const VecNView &v) {
+    return *this = static_cast<const base_view &>(v);
+  }
+  template <class E> VecNView &operator=(const VecExpr<E> &e) {
+    static_assert(E::dimension == N, "expression dimension differs");
+    // expressions are element wise, element i of the view is read by the
+    // expression before it is written
+    T *p = target();
+    for (unsigned int i = 0; i < N; i++) {
+      p[i * this->stride] = e.self().eval(i);
+    }
+    return *this;
+  }
+  /*! Tested */
+  /** points the view at other elements, nothing is written*/
+  VecNView &rebind(T *p, std::ptrdiff_t s = 1) {
+    this->ptr = p;
+    this->stride = s;
+    return *this;
+  }
+  VecNView &rebind(const VecNView &v) { return rebind(v.elements(), v.step()); }
+  /** compound assignments update the viewed elements in place*/
+  template <class E> VecNView &operator+=(const VecExpr<E> &e) {
+    return *this = *this + e.self();
+  }
+  template <class E> VecNView &operator-=(const VecExpr<E> &e) {
+    return *this = *this - e.self();
+  }
+  template <class E> VecNView &operator*=(const VecExpr<E> &e) {
+    return *this = *this * e.self();
+  }
+  template <class E> VecNView &operator/=(const VecExpr<E> &e) {
+    return *this = *this / e.self();
+  }
+  VecNView &operator+=(T s) { return *this = *this + s; }
+  VecNView &operator-=(T s) { return *this = *this - s; }
+  VecNView &operator*=(T s) { return *this = *this * s; }
+  VecNView &operator/=(T s) { return *this = *this / s; }
+
+  T *elements() const { return target(); }
+  /*! Tested */
+  Result set(unsigned int index, T el) const {
+    if (policy_fails<Policy>(index < N, INDEX_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    target()[index * this->stride] = el;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+};
+
+/** vector expression operators*/
+template <class L, class R>
+VEPP_CONSTEXPR VecBinExpr<L, R, ops::Add>
+operator+(const VecExpr<L> &l, const VecExpr<R> &r) {
+  return VecBinExpr<L, R, ops::Add>(l.self(), r.self());
+}
+template <class L, class R>
+VEPP_CONSTEXPR VecBinExpr<L, R, ops::Subtract>
+operator-(const VecExpr<L> &l, const VecExpr<R> &r) {
+  return VecBinExpr<L, R, ops::Subtract>(l.self(), r.self());
+}
+template <class L, class R>
+VEPP_CONSTEXPR VecBinExpr<L, R, ops::Multiply>
+operator*(const VecExpr<L> &l, const VecExpr<R> &r) {
+  return VecBinExpr<L, R, ops::Multiply>(l.self(), r.self());
+}
+template <class L, class R>
+VEPP_CONSTEXPR VecBinExpr<L, R, ops::Divide>
+operator/(const VecExpr<L> &l, const VecExpr<R> &r) {
+  return VecBinExpr<L, R, ops::Divide>(l.self(), r.self());
+}
+
+/** scalar forms, the scalar is broadcast to every element*/
+template <class E> struct scalar_expr {
+  typedef VecScalar<typename E::value_type, E::dimension> type;
 };
 
-bool CHECK(Result res) { return res.status == SUCCESS; }
+template <class E>
+VEPP_CONSTEXPR VecBinExpr<E, typename scalar_expr<E>::type, ops::Add>
+operator+(const VecExpr<E> &l, typename E::value_type s) {
+  typedef typename scalar_expr<E>::type S;
+  return VecBinExpr<E, S, ops::Add>(l.self(), S(s));
+}
+template <class E>
+VEPP_CONSTEXPR VecBinExpr<typename scalar_expr<E>::type, E, ops::Add>
+operator+(typename E::value_type s, const VecExpr<E> &r) {
+  typedef typename scalar_expr<E>::type S;
+  return VecBinExpr<S, E, ops::Add>(S(s), r.self());
+}
+template <class E>
+VEPP_CONSTEXPR VecBinExpr<E, typename scalar_expr<E>::type, ops::Subtract>
+operator-(const VecExpr<E> &l, typename E::value_type s) {
+  typedef typename scalar_expr<E>::type S;
+  return VecBinExpr<E, S, ops::Subtract>(l.self(), S(s));
+}
+template <class E>
+VEPP_CONSTEXPR VecBinExpr<typename scalar_expr<E>::type, E, ops::Subtract>
+operator-(typename E::value_type s, const VecExpr<E> &r) {
+  typedef typename scalar_expr<E>::type S;
+  return VecBinExpr<S, E, ops::Subtract>(S(s), r.self());
+}
+template <class E>
+VEPP_CONSTEXPR VecBinExpr<E, typename scalar_expr<E>::type, ops::Multiply>
+operator*(const VecExpr<E> &l, typename E::value_type s) {
+  typedef typename scalar_expr<E>::type S;
+  return VecBinExpr<E, S, ops::Multiply>(l.self(), S(s));
+}
+template <class E>
+VEPP_CONSTEXPR VecBinExpr<typename scalar_expr<E>::type, E, ops::Multiply>
+operator*(typename E::value_type s, const VecExpr<E> &r) {
+  typedef typename scalar_expr<E>::type S;
+  return VecBinExpr<S, E, ops::Multiply>(S(s), r.self());
+}
+template <class E>
+VEPP_CONSTEXPR VecBinExpr<E, typename scalar_expr<E>::type, ops::Divide>
+operator/(const VecExpr<E> &l, typename E::value_type s) {
+  typedef typename scalar_expr<E>::type S;
+  return VecBinExpr<E, S, ops::Divide>(l.self(), S(s));
+}
+template <class E>
+VEPP_CONSTEXPR VecBinExpr<typename scalar_expr<E>::type, E, ops::Divide>
+operator/(typename E::value_type s, const VecExpr<E> &r) {
+  typedef typename scalar_expr<E>::type S;
+  return VecBinExpr<S, E, ops::Divide>(S(s), r.self());
+}
+
+/** VecN aliases for each error policy*/
+template <class T, unsigned int N, class Storage = storage::Packed>
+using VecNChecked = VecN<T, N, CheckedPolicy, Storage>;
+template <class T, unsigned int N, class Storage = storage::Packed>
+using VecNThrow = VecN<T, N, ThrowPolicy, Storage>;
+template <class T, unsigned int N, class Storage = storage::Packed>
+using VecNAssert = VecN<T, N, AssertPolicy, Storage>;
+template <class T, unsigned int N, class Storage = storage::Packed>
+using VecNUnchecked = VecN<T, N, UncheckedPolicy, Storage>;
+
+/** VecN aliases for each storage layout*/
+template <class T, unsigned int N, unsigned int Align,
+          class Policy = CheckedPolicy>
+using VecNAligned = VecN<T, N, Policy, storage::Aligned<Align>>;
+template <class T, unsigned int N, class Policy = CheckedPolicy>
+using VecNPadded = VecN<T, N, Policy, storage::Padded>;
+template <class T, unsigned int N, class Policy = CheckedPolicy>
+using VecNCacheLine = VecN<T, N, Policy, storage::CacheLine>;
+
+inline bool CHECK(Result res) { return res.status == SUCCESS; }
 
 #define CHECK_M(call, res)                                                     \
   do {                                                                         \
@@ -490,12 +1538,16 @@ bool CHECK(Result res) { return res.status == SUCCESS; }
     res.file_name = __FILE__;                                                  \
   } while (0)
 
-Result INFO(Result res) {
+inline Result INFO(Result res) {
   res.line_info = __LINE__;
   res.file_name = __FILE__;
   if (res.status != SUCCESS) {
+#if defined(VEPP_ASYNC_LOG)
+    async_log::post(res.status, res.fn_name, res.file_name, res.line_info);
+#else
     std::cerr << res << " at " << res.fn_name << " :: " << res.file_name
               << " :: " << res.line_info << std::endl;
+#endif
   }
   return res;
 }
@@ -509,11 +1561,15 @@ Result INFO(Result res) {
     res.file_name = __FILE__;                                                  \
   } while (0)
 
-Result INFO_VERBOSE(Result res) {
+inline Result INFO_VERBOSE(Result res) {
   res.line_info = __LINE__;
   res.file_name = __FILE__;
+#if defined(VEPP_ASYNC_LOG)
+  async_log::post(res.status, res.fn_name, res.file_name, res.line_info);
+#else
   std::cerr << res << " at " << res.fn_name << " :: " << res.file_name
             << " :: " << res.line_info << std::endl;
+#endif
   return res;
 }
 #define INFO_VERBOSE_M(call, res)                                              \
@@ -0,0 +1,568 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_ARRAY_HPP
+#define VEPP_ARRAY_HPP
+#include "vepp.hpp"
+#include "vepp_memory.hpp"
+#include <cstddef>
+
+namespace vepp {
+
+/** Structure of arrays container for many N dimensional vectors
+
+  Component k of every vector is stored contiguously in lane k and every
+  lane is 64 byte aligned. Bulk arithmetic runs the SIMD kernels of
+  vepp_simd.hpp over each lane. Bulk operations report
+  a single Result for the whole batch, and count a failure in the
+  instrument counters like a VecN method.
+ */
+template <class T, unsigned int N> class VecNArray {
+public:
+  typedef std::vector<T, AlignedAllocator<T, 64>> lane_type;
+
+private:
+  /** one lane per component*/
+  std::array<lane_type, N> lanes;
+  /** number of vectors*/
+  std::size_t count;
+
+  /** the bulk operations write every element of out*/
+  void fit(VecNArray<T, N> &out) const {
+    if (out.count != count) {
+      out.resize_for_overwrite(count);
+    }
+  }
+
+public:
+  /*! Tested */
+  VecNArray() : count(0) {}
+  /*! Tested */
+  explicit VecNArray(std::size_t n) : count(n) {
+    for (unsigned int k = 0; k < N; k++) {
+      lanes[k].assign(n, static_cast<T>(0));
+    }
+  }
+  VecNArray(std::size_t n, T s) : count(n) {
+    for (unsigned int k = 0; k < N; k++) {
+      lanes[k].assign(n, s);
+    }
+  }
+  /*! Tested */
+  Result size(std::size_t &out) const {
+    out = count;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** new vectors are zero*/
+  Result resize(std::size_t n) {
+    for (unsigned int k = 0; k < N; k++) {
+      lanes[k].resize(n);
+      for (std::size_t i = count; i < n; i++) {
+        lanes[k][i] = static_cast<T>(0);
+      }
+    }
+    count = n;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** new vectors are left uninitialized and their memory untouched, for
+   * callers that write every element next*/
+  Result resize_for_overwrite(std::size_t n) {
+    for (unsigned int k = 0; k < N; k++) {
+      lanes[k].resize(n);
+    }
+    count = n;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** contiguous storage of component k*/
+  Result lane(unsigned int k, T *&out) {
+    if (k >= N) {
+      VEPP_PROBE_FAIL(INDEX_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    // through the pointer, see VecN::get
+    out = lanes.data()[k].data();
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result lane(unsigned int k, const T *&out) const {
+    if (k >= N) {
+      VEPP_PROBE_FAIL(INDEX_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    // through the pointer, see VecN::get
+    out = lanes.data()[k].data();
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  template <class P, class S>
+  Result get(std::size_t index, VecN<T, N, P, S> &out) const {
+    if (index >= count) {
+      VEPP_PROBE_FAIL(INDEX_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    std::array<T, N> arr;
+    for (unsigned int k = 0; k < N; k++) {
+      arr[k] = lanes[k][index];
+    }
+    out = VecN<T, N, P, S>(arr);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  template <class P, class S>
+  Result set(std::size_t index, const VecN<T, N, P, S> &v) {
+    if (index >= count) {
+      VEPP_PROBE_FAIL(INDEX_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    for (unsigned int k = 0; k < N; k++) {
+      lanes[k][index] = v.eval(k);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  template <class P, class S>
+  Result from_aos(const std::vector<VecN<T, N, P, S>> &in) {
+    resize_for_overwrite(in.size());
+    for (unsigned int k = 0; k < N; k++) {
+      T *o = lanes[k].data();
+      for (std::size_t i = 0; i < count; i++) {
+        o[i] = in[i].eval(k);
+      }
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  template <class P, class S>
+  Result to_aos(std::vector<VecN<T, N, P, S>> &out) const {
+    if (out.size() != count) {
+      out.resize(count);
+    }
+    for (std::size_t i = 0; i < count; i++) {
+      std::array<T, N> arr;
+      for (unsigned int k = 0; k < N; k++) {
+        arr[k] = lanes[k][i];
+      }
+      out[i] = VecN<T, N, P, S>(arr);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** reads n interleaved vectors, ie x0 y0 z0 x1 y1 z1 ...*/
+  Result from_aos(const T *in, std::size_t n) {
+    resize_for_overwrite(n);
+    for (unsigned int k = 0; k < N; k++) {
+      T *o = lanes[k].data();
+      for (std::size_t i = 0; i < n; i++) {
+        o[i] = in[i * N + k];
+      }
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** writes the vectors interleaved, out must hold size * N elements*/
+  Result to_aos(T *out) const {
+    for (unsigned int k = 0; k < N; k++) {
+      const T *a = lanes[k].data();
+      for (std::size_t i = 0; i < count; i++) {
+        out[i * N + k] = a[i];
+      }
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** bulk element-wise kernels*/
+  template <class Fn>
+  Result apply_el(T v, const Fn &fn, VecNArray<T, N> &out) const {
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      const T *a = lanes[k].data();
+      T *o = out.lanes[k].data();
+      for (std::size_t i = 0; i < count; i++) {
+        o[i] = fn(a[i], v);
+      }
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  template <class Fn>
+  Result apply_el(const VecNArray<T, N> &v, const Fn &fn,
+                  VecNArray<T, N> &out) const {
+    if (v.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      const T *a = lanes[k].data();
+      const T *b = v.lanes[k].data();
+      T *o = out.lanes[k].data();
+      for (std::size_t i = 0; i < count; i++) {
+        o[i] = fn(a[i], b[i]);
+      }
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result add(T v, VecNArray<T, N> &out) const {
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::add(lanes[k].data(), v, out.lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result add(const VecNArray<T, N> &v, VecNArray<T, N> &out) const {
+    if (v.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::add(lanes[k].data(), v.lanes[k].data(),
+                out.lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result subtract(T v, VecNArray<T, N> &out) const {
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::subtract(lanes[k].data(), v, out.lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result subtract(const VecNArray<T, N> &v, VecNArray<T, N> &out) const {
+    if (v.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::subtract(lanes[k].data(), v.lanes[k].data(),
+                     out.lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result multiply(T v, VecNArray<T, N> &out) const {
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::multiply(lanes[k].data(), v, out.lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result multiply(const VecNArray<T, N> &v, VecNArray<T, N> &out) const {
+    if (v.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::multiply(lanes[k].data(), v.lanes[k].data(),
+                     out.lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result divide(T v, VecNArray<T, N> &out) const {
+    if (v == static_cast<T>(0)) {
+      VEPP_PROBE_FAIL(ARG_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::divide(lanes[k].data(), v, out.lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result divide(const VecNArray<T, N> &v, VecNArray<T, N> &out) const {
+    if (v.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    // one zero anywhere in the batch fails the whole batch
+    for (unsigned int k = 0; k < N; k++) {
+      const T *b = v.lanes[k].data();
+      bool has_zero = false;
+      for (std::size_t i = 0; i < v.count; i++) {
+        has_zero |= b[i] == static_cast<T>(0);
+      }
+      if (has_zero) {
+        VEPP_PROBE_FAIL(ARG_ERROR);
+        Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+        return vflag;
+      }
+    }
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::divide(lanes[k].data(), v.lanes[k].data(),
+                   out.lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** in place forms, the array is both the left operand and the output*/
+  /*! Tested */
+  Result add_inplace(T v) { return add(v, *this); }
+  /*! Tested */
+  Result add_inplace(const VecNArray<T, N> &v) { return add(v, *this); }
+  Result subtract_inplace(T v) { return subtract(v, *this); }
+  Result subtract_inplace(const VecNArray<T, N> &v) {
+    return subtract(v, *this);
+  }
+  /*! Tested */
+  Result multiply_inplace(T v) { return multiply(v, *this); }
+  Result multiply_inplace(const VecNArray<T, N> &v) {
+    return multiply(v, *this);
+  }
+  Result divide_inplace(T v) { return divide(v, *this); }
+  /*! Tested */
+  Result divide_inplace(const VecNArray<T, N> &v) { return divide(v, *this); }
+  /** fused updates over every lane in one pass: axpy sets the array to
+   * a * x + itself, axpby to a * x + b * itself*/
+  /*! Tested */
+  Result axpy(T a, const VecNArray<T, N> &x) {
+    if (x.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    for (unsigned int k = 0; k < N; k++) {
+      simd::axpy(a, x.lanes[k].data(), lanes[k].data(), lanes[k].data(),
+                 count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** same with one coefficient per element*/
+  /*! Tested */
+  Result axpy(const VecNArray<T, N> &a, const VecNArray<T, N> &x) {
+    if (a.count != count || x.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    for (unsigned int k = 0; k < N; k++) {
+      simd::fma(a.lanes[k].data(), x.lanes[k].data(), lanes[k].data(),
+                lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result axpby(T a, const VecNArray<T, N> &x, T b) {
+    if (x.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    for (unsigned int k = 0; k < N; k++) {
+      simd::axpby(a, x.lanes[k].data(), b, lanes[k].data(), lanes[k].data(),
+                  count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** out = this * b + c, element-wise*/
+  /*! Tested */
+  Result fma(const VecNArray<T, N> &b, const VecNArray<T, N> &c,
+             VecNArray<T, N> &out) const {
+    if (b.count != count || c.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::fma(lanes[k].data(), b.lanes[k].data(), c.lanes[k].data(),
+                out.lanes[k].data(), count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result fma(T b, const VecNArray<T, N> &c, VecNArray<T, N> &out) const {
+    if (c.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    fit(out);
+    for (unsigned int k = 0; k < N; k++) {
+      simd::axpy(b, lanes[k].data(), c.lanes[k].data(), out.lanes[k].data(),
+                 count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** out[i] is the dot product of the i-th vectors of both arrays*/
+  /*! Tested */
+  template <class A>
+  Result dot(const VecNArray<T, N> &v, std::vector<T, A> &out) const {
+    if (v.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    if (out.size() != count) {
+      out.resize(count);
+    }
+    // single pass over the batch, the loop over components is unrolled
+    const T *a[N];
+    const T *b[N];
+    for (unsigned int k = 0; k < N; k++) {
+      a[k] = lanes[k].data();
+      b[k] = v.lanes[k].data();
+    }
+    T *o = out.data();
+    for (std::size_t i = 0; i < count; i++) {
+      T acc = static_cast<T>(0);
+      for (unsigned int k = 0; k < N; k++) {
+        acc += a[k][i] * b[k][i];
+      }
+      o[i] = acc;
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** out[i] is the dot product of the i-th vector with v*/
+  /*! Tested */
+  template <class P, class S, class A>
+  Result dot(const VecN<T, N, P, S> &v, std::vector<T, A> &out) const {
+    if (out.size() != count) {
+      out.resize(count);
+    }
+    const T *a[N];
+    T s[N];
+    for (unsigned int k = 0; k < N; k++) {
+      a[k] = lanes[k].data();
+      s[k] = v.eval(k);
+    }
+    T *o = out.data();
+    for (std::size_t i = 0; i < count; i++) {
+      T acc = static_cast<T>(0);
+      for (unsigned int k = 0; k < N; k++) {
+        acc += a[k][i] * s[k];
+      }
+      o[i] = acc;
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** same accumulated in Acc. Blocks of both arrays are converted to Acc
+   * with the bulk kernels (F16C for half storage) and then multiplied*/
+  /*! Tested */
+  template <class Acc, class A>
+  Result dot(const VecNArray<T, N> &v, std::vector<Acc, A> &out) const {
+    if (v.count != count) {
+      VEPP_PROBE_FAIL(SIZE_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    if (out.size() != count) {
+      out.resize(count);
+    }
+    const std::size_t block = 256;
+    Acc x[block], y[block];
+    Acc *o = out.data();
+    for (std::size_t i = 0; i < count; i += block) {
+      const std::size_t len = count - i < block ? count - i : block;
+      for (unsigned int k = 0; k < N; k++) {
+        simd::convert(lanes[k].data() + i, x, len);
+        simd::convert(v.lanes[k].data() + i, y, len);
+        Acc *oi = o + i;
+        if (k == 0) {
+          for (std::size_t j = 0; j < len; j++) {
+            oi[j] = x[j] * y[j];
+          }
+        } else {
+          for (std::size_t j = 0; j < len; j++) {
+            oi[j] += x[j] * y[j];
+          }
+        }
+      }
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** converts every element to U, ie between float and the 16 bit floats
+   * of vepp_half.hpp*/
+  /*! Tested */
+  template <class U> Result convert(VecNArray<U, N> &out) const {
+    std::size_t n = 0;
+    out.size(n);
+    if (n != count) {
+      out.resize_for_overwrite(count);
+    }
+    for (unsigned int k = 0; k < N; k++) {
+      U *o = nullptr;
+      out.lane(k, o);
+      simd::convert(lanes[k].data(), o, count);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+};
+
+} // namespace vepp
+
+#endif
@@ -0,0 +1,726 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_DATASET_HPP
+#define VEPP_DATASET_HPP
+#include "vepp.hpp"
+#include "vepp_array.hpp"
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** Binary vector datasets
+
+  A dataset file is a 64 byte Header followed by the elements, either
+  interleaved (AOS: x0 y0 z0 x1 ...) or one lane per component (SOA) with
+  every lane starting on a 64 byte boundary. Numbers are stored in the
+  byte order of the host and the header records it. The header keeps the
+  element type, N, the count and a checksum of the elements.
+
+  Reader maps the file and hands out ConstVecNView over the mapping, so
+  opening a dataset costs the same for a thousand vectors or a billion,
+  pages are read when first touched, and no vector is copied or
+  allocated. Writer streams batches to the file through a bounded buffer;
+  the header is written last, so a file whose writer never closed it
+  does not open. SOA files need their capacity up front since every lane
+  has a fixed place in the file.
+
+  These use the POSIX file and mmap calls.
+ */
+namespace vepp {
+namespace dataset {
+
+enum layout_t : std::uint8_t { AOS = 0, SOA = 1 };
+
+/** element kinds recorded in the header*/
+enum kind_t : std::uint8_t {
+  KIND_FLOAT = 1,
+  KIND_SIGNED = 2,
+  KIND_UNSIGNED = 3
+};
+
+template <class T> struct element {
+  static_assert(std::is_arithmetic<T>::value,
+                "dataset elements have to be arithmetic types");
+  static const std::uint8_t kind =
+      std::is_floating_point<T>::value
+          ? KIND_FLOAT
+          : (std::is_signed<T>::value ? KIND_SIGNED : KIND_UNSIGNED);
+};
+
+static const char magic[8] = {'V', 'E', 'P', 'P', 'V', 'E', 'C', 'S'};
+static const std::uint32_t version = 1;
+static const std::uint32_t byte_order = 0x01020304u;
+static const std::uint32_t alignment = 64;
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  /** byte_order as written by the host*/
+  std::uint32_t byte_order;
+  std::uint8_t kind;
+  std::uint8_t element_size;
+  std::uint8_t layout;
+  std::uint8_t reserved0;
+  std::uint32_t dimension;
+  std::uint64_t count;
+  /** offset of the first element from the start of the file*/
+  std::uint64_t data_offset;
+  /** bytes from the start of a lane to the start of the next, SOA only*/
+  std::uint64_t lane_stride;
+  std::uint32_t alignment;
+  std::uint32_t reserved1;
+  std::uint64_t checksum;
+};
+static_assert(sizeof(Header) == 64, "the dataset header is 64 bytes");
+
+/** FNV-1a over 64 bit words. Words go round robin to four streams so
+ * the multiplications overlap, a trailing partial word is zero padded and
+ * the streams and the byte count are folded into one hash. Updating in
+ * pieces gives the same hash as a single update*/
+class Checksum {
+public:
+  static const std::uint64_t basis = 14695981039346656037ull;
+  static const std::uint64_t prime = 1099511628211ull;
+
+private:
+  std::uint64_t h[4];
+  std::uint64_t words;
+  std::uint64_t bytes;
+  unsigned char tail[8];
+  unsigned int tail_size;
+
+  static std::uint64_t load(const unsigned char *p) {
+    std::uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+  }
+  void word(std::uint64_t w) {
+    std::uint64_t &s = h[words % 4];
+    s = (s ^ w) * prime;
+    words++;
+  }
+
+public:
+  Checksum() : words(0), bytes(0), tail_size(0) {
+    for (unsigned int k = 0; k < 4; k++) {
+      h[k] = basis;
+    }
+  }
+  void update(const void *data, std::size_t n) {
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    bytes += n;
+    if (tail_size != 0) {
+      std::size_t take = 8 - tail_size < n ? 8 - tail_size : n;
+      std::memcpy(tail + tail_size, p, take);
+      tail_size += static_cast<unsigned int>(take);
+      p += take;
+      n -= take;
+      if (tail_size < 8) {
+        return;
+      }
+      word(load(tail));
+      tail_size = 0;
+    }
+    for (; n >= 8 && words % 4 != 0; p += 8, n -= 8) {
+      word(load(p));
+    }
+    std::uint64_t h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3];
+    const std::size_t blocks = n / 32;
+    for (std::size_t b = 0; b < blocks; b++, p += 32) {
+      h0 = (h0 ^ load(p)) * prime;
+      h1 = (h1 ^ load(p + 8)) * prime;
+      h2 = (h2 ^ load(p + 16)) * prime;
+      h3 = (h3 ^ load(p + 24)) * prime;
+    }
+    h[0] = h0;
+    h[1] = h1;
+    h[2] = h2;
+    h[3] = h3;
+    words += 4 * blocks;
+    n -= 32 * blocks;
+    for (; n >= 8; p += 8, n -= 8) {
+      word(load(p));
+    }
+    std::memcpy(tail, p, n);
+    tail_size = static_cast<unsigned int>(n);
+  }
+  std::uint64_t value() const {
+    Checksum c(*this);
+    if (c.tail_size != 0) {
+      std::memset(c.tail + c.tail_size, 0, 8 - c.tail_size);
+      c.word(load(c.tail));
+    }
+    std::uint64_t out = basis;
+    for (unsigned int k = 0; k < 4; k++) {
+      out = (out ^ c.h[k]) * prime;
+    }
+    return (out ^ bytes) * prime;
+  }
+};
+
+/** checksum of a dataset: the hashes of its lanes folded in order, an
+ * AOS file is a single lane*/
+inline std::uint64_t fold(const Checksum *lanes, unsigned int n) {
+  std::uint64_t out = Checksum::basis;
+  for (unsigned int k = 0; k < n; k++) {
+    out = (out ^ lanes[k].value()) * Checksum::prime;
+  }
+  return out;
+}
+
+/** writes n bytes at offset, retrying partial and interrupted writes*/
+inline bool write_at(int fd, const void *data, std::size_t n,
+                     std::uint64_t offset) {
+  const char *p = static_cast<const char *>(data);
+  while (n > 0) {
+    ssize_t w = ::pwrite(fd, p, n, static_cast<off_t>(offset));
+    if (w < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    p += w;
+    n -= static_cast<std::size_t>(w);
+    offset += static_cast<std::uint64_t>(w);
+  }
+  return true;
+}
+
+/** Memory mapped read only dataset of N dimensional vectors of T*/
+template <class T, unsigned int N, class Policy = CheckedPolicy>
+class Reader {
+  int fd;
+  void *map;
+  std::size_t map_size;
+  Header header;
+  const T *base;
+
+  Reader(const Reader &) = delete;
+  Reader &operator=(const Reader &) = delete;
+
+  /** rejects a header that does not describe a complete dataset of the
+   * mapped size*/
+  status_t check() const {
+    const Header &h = header;
+    if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 ||
+        h.version != version || h.byte_order != byte_order ||
+        h.layout > SOA || h.element_size == 0 || h.dimension == 0 ||
+        h.data_offset < sizeof(Header) || h.data_offset % sizeof(T) != 0) {
+      return FORMAT_ERROR;
+    }
+    if (h.kind != element<T>::kind || h.element_size != sizeof(T) ||
+        h.dimension != N) {
+      return ARG_ERROR;
+    }
+    if (h.data_offset > map_size) {
+      return FORMAT_ERROR;
+    }
+    const std::uint64_t avail = map_size - h.data_offset;
+    if (h.layout == AOS) {
+      if (h.count > avail / (sizeof(T) * N)) {
+        return FORMAT_ERROR;
+      }
+    } else {
+      if (h.lane_stride % sizeof(T) != 0 ||
+          h.count > h.lane_stride / sizeof(T) ||
+          (N > 1 && h.lane_stride > avail / (N - 1)) ||
+          h.count * sizeof(T) > avail - (N - 1) * h.lane_stride) {
+        return FORMAT_ERROR;
+      }
+    }
+    return SUCCESS;
+  }
+
+public:
+  Reader() : fd(-1), map(nullptr), map_size(0), header(), base(nullptr) {}
+  Reader(Reader &&r) : Reader() { swap(r); }
+  Reader &operator=(Reader &&r) {
+    swap(r);
+    return *this;
+  }
+  ~Reader() { close(); }
+
+  void swap(Reader &r) {
+    std::swap(fd, r.fd);
+    std::swap(map, r.map);
+    std::swap(map_size, r.map_size);
+    std::swap(header, r.header);
+    std::swap(base, r.base);
+  }
+
+  /*! Tested */
+  /** maps path, IO_ERROR when it cannot be opened or mapped, FORMAT_ERROR
+   * when it is not a complete dataset and ARG_ERROR when its elements are
+   * not N dimensional vectors of T*/
+  Result open(const char *path) {
+    close();
+    fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) {
+      close();
+      VEPP_PROBE_FAIL(IO_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, IO_ERROR);
+      return vflag;
+    }
+    if (static_cast<std::uint64_t>(st.st_size) < sizeof(Header)) {
+      close();
+      VEPP_PROBE_FAIL(FORMAT_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, FORMAT_ERROR);
+      return vflag;
+    }
+    map_size = static_cast<std::size_t>(st.st_size);
+    map = ::mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+      map = nullptr;
+      close();
+      VEPP_PROBE_FAIL(IO_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, IO_ERROR);
+      return vflag;
+    }
+    std::memcpy(&header, map, sizeof(Header));
+    status_t s = check();
+    if (s != SUCCESS) {
+      close();
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, probe_status(s));
+      return vflag;
+    }
+    base = reinterpret_cast<const T *>(static_cast<const char *>(map) +
+                                       header.data_offset);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result close() {
+    if (map != nullptr) {
+      ::munmap(map, map_size);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    fd = -1;
+    map = nullptr;
+    map_size = 0;
+    header = Header();
+    base = nullptr;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** hints the kernel that the dataset is about to be read front to
+   * back*/
+  Result advise_sequential() const {
+    if (map != nullptr) {
+      ::madvise(map, map_size, MADV_SEQUENTIAL);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result size(std::size_t &out) const {
+    out = static_cast<std::size_t>(header.count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result layout(layout_t &out) const {
+    out = static_cast<layout_t>(header.layout);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** view of vector i over the mapping, valid until close*/
+  Result get(std::size_t i, ConstVecNView<T, N, Policy> &out) const {
+    if (i >= header.count) {
+      VEPP_PROBE_FAIL(INDEX_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    if (header.layout == AOS) {
+      out = ConstVecNView<T, N, Policy>(base + i * N);
+    } else {
+      out = ConstVecNView<T, N, Policy>(
+          base + i, static_cast<std::ptrdiff_t>(header.lane_stride /
+                                                sizeof(T)));
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** copy of vector i*/
+  template <class P, class S>
+  Result get(std::size_t i, VecN<T, N, P, S> &out) const {
+    ConstVecNView<T, N, Policy> v(base);
+    Result res = get(i, v);
+    if (res.status == SUCCESS) {
+      out = v;
+    }
+    return res;
+  }
+  /*! Tested */
+  /** component k of every vector of a SOA dataset, for the bulk kernels*/
+  Result lane(unsigned int k, const T *&out) const {
+    if (k >= N || header.layout != SOA) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__,
+                   probe_status(k >= N ? INDEX_ERROR : ARG_ERROR));
+      return vflag;
+    }
+    out = base + k * (header.lane_stride / sizeof(T));
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** interleaved elements of an AOS dataset*/
+  Result elements(const T *&out) const {
+    if (header.layout != AOS) {
+      VEPP_PROBE_FAIL(ARG_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    out = base;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** copies the dataset into a VecNArray*/
+  Result read(VecNArray<T, N> &out) const {
+    const std::size_t n = static_cast<std::size_t>(header.count);
+    if (header.layout == AOS) {
+      return out.from_aos(base, n);
+    }
+    out.resize_for_overwrite(n);
+    for (unsigned int k = 0; k < N; k++) {
+      T *o = nullptr;
+      out.lane(k, o);
+      std::memcpy(o, base + k * (header.lane_stride / sizeof(T)),
+                  n * sizeof(T));
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** reads every element and compares with the stored checksum,
+   * FORMAT_ERROR on a mismatch. Opening does not verify, it would touch
+   * the whole file*/
+  Result verify() const {
+    Checksum sums[N];
+    const std::size_t n = static_cast<std::size_t>(header.count);
+    unsigned int lanes = 1;
+    if (header.layout == AOS) {
+      sums[0].update(base, n * N * sizeof(T));
+    } else {
+      lanes = N;
+      for (unsigned int k = 0; k < N; k++) {
+        sums[k].update(base + k * (header.lane_stride / sizeof(T)),
+                       n * sizeof(T));
+      }
+    }
+    status_t s = fold(sums, lanes) == header.checksum ? SUCCESS
+                                                      : FORMAT_ERROR;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, probe_status(s));
+    return vflag;
+  }
+};
+
+/** Streaming dataset writer
+
+  Batches are appended as they come and nothing but a bounded staging
+  buffer is kept in memory. close writes the header with the final count
+  and checksum.
+ */
+template <class T, unsigned int N> class Writer {
+public:
+  /** bytes staged before an AOS write*/
+  static const std::size_t buffer_bytes = 1 << 20;
+
+private:
+  int fd;
+  layout_t lay;
+  std::uint64_t count;
+  std::uint64_t capacity;
+  std::uint64_t lane_stride;
+  Checksum sums[N];
+  std::vector<T> stage;
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  static std::uint64_t data_offset() { return alignment; }
+
+  /** writes the staged AOS elements*/
+  bool flush() {
+    if (stage.empty()) {
+      return true;
+    }
+    const std::size_t bytes = stage.size() * sizeof(T);
+    const std::uint64_t offset =
+        data_offset() + (count - stage.size() / N) * N * sizeof(T);
+    if (!write_at(fd, stage.data(), bytes, offset)) {
+      return false;
+    }
+    sums[0].update(stage.data(), bytes);
+    stage.clear();
+    return true;
+  }
+  /** n vectors given lane by lane*/
+  status_t put_lanes(const T *const *lanes, std::size_t n) {
+    if (lay == AOS) {
+      for (std::size_t i = 0; i < n; i++) {
+        for (unsigned int k = 0; k < N; k++) {
+          stage.push_back(lanes[k][i]);
+        }
+        count++;
+        if (stage.size() * sizeof(T) >= buffer_bytes && !flush()) {
+          return IO_ERROR;
+        }
+      }
+      return SUCCESS;
+    }
+    if (n > capacity - count) {
+      return SIZE_ERROR;
+    }
+    for (unsigned int k = 0; k < N; k++) {
+      const std::uint64_t offset =
+          data_offset() + k * lane_stride + count * sizeof(T);
+      if (!write_at(fd, lanes[k], n * sizeof(T), offset)) {
+        return IO_ERROR;
+      }
+      sums[k].update(lanes[k], n * sizeof(T));
+    }
+    count += n;
+    return SUCCESS;
+  }
+  /** n interleaved vectors*/
+  status_t put(const T *in, std::size_t n) {
+    if (lay == SOA) {
+      if (n > capacity - count) {
+        return SIZE_ERROR;
+      }
+      // regrouped into lanes a block at a time
+      const std::size_t block = 4096;
+      std::vector<T> tmp(N * (n < block ? n : block));
+      for (std::size_t i0 = 0; i0 < n; i0 += block) {
+        const std::size_t m = n - i0 < block ? n - i0 : block;
+        const T *lanes[N];
+        for (unsigned int k = 0; k < N; k++) {
+          T *l = tmp.data() + k * m;
+          for (std::size_t i = 0; i < m; i++) {
+            l[i] = in[(i0 + i) * N + k];
+          }
+          lanes[k] = l;
+        }
+        status_t s = put_lanes(lanes, m);
+        if (s != SUCCESS) {
+          return s;
+        }
+      }
+      return SUCCESS;
+    }
+    if (n * N * sizeof(T) >= buffer_bytes) {
+      // large batches skip the staging buffer
+      if (!flush()) {
+        return IO_ERROR;
+      }
+      const std::uint64_t offset = data_offset() + count * N * sizeof(T);
+      if (!write_at(fd, in, n * N * sizeof(T), offset)) {
+        return IO_ERROR;
+      }
+      sums[0].update(in, n * N * sizeof(T));
+      count += n;
+      return SUCCESS;
+    }
+    stage.insert(stage.end(), in, in + n * N);
+    count += n;
+    if (stage.size() * sizeof(T) >= buffer_bytes && !flush()) {
+      return IO_ERROR;
+    }
+    return SUCCESS;
+  }
+
+public:
+  Writer() : fd(-1), lay(AOS), count(0), capacity(0), lane_stride(0) {}
+  ~Writer() { close(); }
+
+  /*! Tested */
+  /** creates or truncates path. An SOA file holds at most capacity
+   * vectors, ARG_ERROR without one*/
+  Result open(const char *path, layout_t layout = AOS,
+              std::size_t cap = 0) {
+    close();
+    if (layout == SOA && cap == 0) {
+      VEPP_PROBE_FAIL(ARG_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    // a zeroed header until close, an unfinished file does not open
+    Header h = Header();
+    if (fd < 0 || !write_at(fd, &h, sizeof(h), 0)) {
+      discard();
+      VEPP_PROBE_FAIL(IO_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, IO_ERROR);
+      return vflag;
+    }
+    lay = layout;
+    count = 0;
+    capacity = cap;
+    lane_stride = 0;
+    if (layout == SOA) {
+      const std::uint64_t bytes = capacity * sizeof(T);
+      lane_stride = (bytes + alignment - 1) / alignment * alignment;
+    }
+    for (unsigned int k = 0; k < N; k++) {
+      sums[k] = Checksum();
+    }
+    stage.clear();
+    stage.reserve(buffer_bytes / sizeof(T) + N);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** n interleaved vectors, ie x0 y0 z0 x1 y1 z1 ...*/
+  Result append(const T *in, std::size_t n) {
+    status_t s = fd < 0 ? ARG_ERROR : put(in, n);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, probe_status(s));
+    return vflag;
+  }
+  /*! Tested */
+  Result append(const VecNArray<T, N> &batch) {
+    if (fd < 0) {
+      VEPP_PROBE_FAIL(ARG_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    std::size_t n = 0;
+    batch.size(n);
+    const T *lanes[N];
+    for (unsigned int k = 0; k < N; k++) {
+      batch.lane(k, lanes[k]);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__,
+                 probe_status(put_lanes(lanes, n)));
+    return vflag;
+  }
+  /*! Tested */
+  template <class P, class S>
+  Result append(const std::vector<VecN<T, N, P, S>> &batch) {
+    if (fd < 0) {
+      VEPP_PROBE_FAIL(ARG_ERROR);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    status_t s = SUCCESS;
+    if (lay == SOA && batch.size() > capacity - count) {
+      s = SIZE_ERROR;
+    }
+    const std::size_t block = 4096;
+    std::vector<T> tmp;
+    for (std::size_t i0 = 0; s == SUCCESS && i0 < batch.size(); i0 += block) {
+      const std::size_t m =
+          batch.size() - i0 < block ? batch.size() - i0 : block;
+      tmp.resize(m * N);
+      for (std::size_t i = 0; i < m; i++) {
+        for (unsigned int k = 0; k < N; k++) {
+          tmp[i * N + k] = batch[i0 + i].eval(k);
+        }
+      }
+      s = put(tmp.data(), m);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, probe_status(s));
+    return vflag;
+  }
+  /*! Tested */
+  Result size(std::size_t &out) const {
+    out = static_cast<std::size_t>(count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** writes the remaining elements and the header*/
+  Result close() {
+    if (fd < 0) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+      return vflag;
+    }
+    bool ok = flush();
+    Header h = Header();
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.byte_order = byte_order;
+    h.kind = element<T>::kind;
+    h.element_size = sizeof(T);
+    h.layout = lay;
+    h.dimension = N;
+    h.count = count;
+    h.data_offset = data_offset();
+    h.lane_stride = lane_stride;
+    h.alignment = alignment;
+    h.checksum = fold(sums, lay == AOS ? 1 : N);
+    if (lay == SOA) {
+      // lanes past count are holes, the file still covers every lane
+      const std::uint64_t end = data_offset() + N * lane_stride;
+      ok = ok && ::ftruncate(fd, static_cast<off_t>(end)) == 0;
+    }
+    ok = ok && write_at(fd, &h, sizeof(h), 0);
+    ok = ::close(fd) == 0 && ok;
+    fd = -1;
+    stage.clear();
+    Result vflag(__LINE__, __FILE__, __FUNCTION__,
+                 probe_status(ok ? SUCCESS : IO_ERROR));
+    return vflag;
+  }
+
+private:
+  void discard() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+    fd = -1;
+  }
+};
+
+} // namespace dataset
+} // namespace vepp
+
+#endif
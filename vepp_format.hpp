@@ -0,0 +1,298 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_FORMAT_HPP
+#define VEPP_FORMAT_HPP
+#include "vepp.hpp"
+#include "vepp_array.hpp"
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+/** Text output
+
+  format writes vectors into a caller provided buffer with std::to_chars:
+  by default every number is the shortest text that reads back to the
+  same value, so a dump parsed with text::parse gives the vectors back
+  bit for bit. Nothing is allocated and no stream is involved. Any vector
+  expression can be written, VecN and the views included. Elements that
+  are neither integers nor floating point, half and bfloat16, are
+  written through float.
+
+  Writer batches formatted vectors into a large buffer and hands it to a
+  FILE * a megabyte at a time. operator<< uses the same kernel.
+ */
+namespace vepp {
+namespace text {
+
+/** output syntax*/
+struct Style {
+  /** between two elements*/
+  const char *separator;
+  /** before the first element and after the last*/
+  const char *open;
+  const char *close;
+  /** after each vector of a batch or a Writer*/
+  const char *line_end;
+  /** significant digits, -1 for the shortest text that reads back
+   * exactly*/
+  int precision;
+
+  Style()
+      : separator(", "), open(""), close(""), line_end("\n"),
+        precision(-1) {}
+};
+
+/** a Style with the string lengths taken once*/
+struct Pieces {
+  const char *separator, *open, *close, *line_end;
+  std::size_t separator_size, open_size, close_size, line_end_size;
+  int precision;
+
+  explicit Pieces(const Style &s)
+      : separator(s.separator), open(s.open), close(s.close),
+        line_end(s.line_end), separator_size(std::strlen(s.separator)),
+        open_size(std::strlen(s.open)), close_size(std::strlen(s.close)),
+        line_end_size(std::strlen(s.line_end)), precision(s.precision) {}
+};
+
+/** the writers below return the end of what they wrote, or nullptr when
+ * it does not fit before e*/
+inline char *put_text(char *p, char *e, const char *s, std::size_t n) {
+  if (p == nullptr || static_cast<std::size_t>(e - p) < n) {
+    return nullptr;
+  }
+  std::memcpy(p, s, n);
+  return p + n;
+}
+template <class T>
+char *put_number(char *p, char *e, T v, int, std::true_type) {
+  std::to_chars_result r = std::to_chars(p, e, v);
+  return r.ec == std::errc() ? r.ptr : nullptr;
+}
+template <class T>
+char *put_number(char *p, char *e, T v, int precision, std::false_type) {
+  std::to_chars_result r =
+      precision < 0
+          ? std::to_chars(p, e, v)
+          : std::to_chars(p, e, v, std::chars_format::general, precision);
+  return r.ec == std::errc() ? r.ptr : nullptr;
+}
+template <class T> char *put_number(char *p, char *e, T v, int precision) {
+  if (p == nullptr) {
+    return nullptr;
+  }
+  typedef typename std::conditional<std::is_arithmetic<T>::value, T,
+                                    float>::type U;
+  return put_number(p, e, static_cast<U>(v), precision,
+                    std::is_integral<U>());
+}
+template <class E>
+char *put_vector(char *p, char *e, const VecExpr<E> &v, const Pieces &s) {
+  const E &x = v.self();
+  p = put_text(p, e, s.open, s.open_size);
+  for (unsigned int i = 0; i < E::dimension; i++) {
+    if (i > 0) {
+      p = put_text(p, e, s.separator, s.separator_size);
+    }
+    p = put_number(p, e, x.eval(i), s.precision);
+  }
+  return put_text(p, e, s.close, s.close_size);
+}
+
+/*! Tested */
+/** writes v into buf[0, size), SIZE_ERROR when it does not fit*/
+template <class E>
+Result format(const VecExpr<E> &v, char *buf, std::size_t size,
+              std::size_t &written, const Style &s = Style()) {
+  char *end = put_vector(buf, buf + size, v, Pieces(s));
+  if (end == nullptr) {
+    written = 0;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  written = static_cast<std::size_t>(end - buf);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+/*! Tested */
+/** writes vectors next, next + 1, ... of a, each followed by the line
+ * end, while they fit in buf[0, size) and moves next past them. Called
+ * again with a fresh buffer until next reaches the size of a; SIZE_ERROR
+ * only when not even vector next fits*/
+template <class T, unsigned int N>
+Result format(const VecNArray<T, N> &a, std::size_t &next, char *buf,
+              std::size_t size, std::size_t &written,
+              const Style &s = Style()) {
+  const Pieces pc(s);
+  std::size_t n = 0;
+  a.size(n);
+  const T *lanes[N];
+  for (unsigned int k = 0; k < N; k++) {
+    a.lane(k, lanes[k]);
+  }
+  char *p = buf, *e = buf + size;
+  const std::size_t first = next;
+  for (; next < n; next++) {
+    char *q = put_text(p, e, pc.open, pc.open_size);
+    for (unsigned int k = 0; k < N; k++) {
+      if (k > 0) {
+        q = put_text(q, e, pc.separator, pc.separator_size);
+      }
+      q = put_number(q, e, lanes[k][next], pc.precision);
+    }
+    q = put_text(q, e, pc.close, pc.close_size);
+    q = put_text(q, e, pc.line_end, pc.line_end_size);
+    if (q == nullptr) {
+      break;
+    }
+    p = q;
+  }
+  written = static_cast<std::size_t>(p - buf);
+  status_t st = next == first && next < n ? SIZE_ERROR : SUCCESS;
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, st);
+  return vflag;
+}
+
+/** Buffered text output to a FILE *, one vector per line*/
+class Writer {
+public:
+  static const std::size_t buffer_bytes = 1 << 20;
+
+private:
+  std::FILE *out;
+  Pieces pieces;
+  std::vector<char> buf;
+  std::size_t used;
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+public:
+  explicit Writer(std::FILE *f, const Style &s = Style())
+      : out(f), pieces(s), buf(buffer_bytes), used(0) {}
+  ~Writer() { flush(); }
+
+  /*! Tested */
+  template <class E> Result write(const VecExpr<E> &v) {
+    for (int attempt = 0; attempt < 2; attempt++) {
+      char *b = buf.data() + used, *e = buf.data() + buf.size();
+      char *end = put_text(put_vector(b, e, v, pieces), e, pieces.line_end,
+                           pieces.line_end_size);
+      if (end != nullptr) {
+        used = static_cast<std::size_t>(end - buf.data());
+        Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+        return vflag;
+      }
+      if (flush().status != SUCCESS) {
+        Result vflag(__LINE__, __FILE__, __FUNCTION__, IO_ERROR);
+        return vflag;
+      }
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  /*! Tested */
+  template <class T, unsigned int N> Result write(const VecNArray<T, N> &a) {
+    std::size_t n = 0, next = 0;
+    a.size(n);
+    Style s;
+    s.separator = pieces.separator;
+    s.open = pieces.open;
+    s.close = pieces.close;
+    s.line_end = pieces.line_end;
+    s.precision = pieces.precision;
+    while (next < n) {
+      std::size_t w = 0;
+      Result res =
+          format(a, next, buf.data() + used, buf.size() - used, w, s);
+      used += w;
+      if (res.status != SUCCESS && used == 0) {
+        return res;
+      }
+      if (next < n && flush().status != SUCCESS) {
+        Result vflag(__LINE__, __FILE__, __FUNCTION__, IO_ERROR);
+        return vflag;
+      }
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** hands the buffered text to the FILE, IO_ERROR when it fails*/
+  Result flush() {
+    status_t s = SUCCESS;
+    if (used != 0 && std::fwrite(buf.data(), 1, used, out) != used) {
+      s = IO_ERROR;
+    }
+    used = 0;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, s);
+    return vflag;
+  }
+};
+
+} // namespace text
+
+/*! Tested */
+/** writes a vector or expression as (x, y, z)*/
+template <class E>
+std::ostream &operator<<(std::ostream &out, const VecExpr<E> &v) {
+  text::Style s;
+  s.open = "(";
+  s.close = ")";
+  const text::Pieces pc(s);
+  char small[256];
+  char *end = text::put_vector(small, small + sizeof(small), v, pc);
+  if (end != nullptr) {
+    return out.write(small, end - small);
+  }
+  std::vector<char> big(2 * sizeof(small));
+  while ((end = text::put_vector(big.data(), big.data() + big.size(), v,
+                                 pc)) == nullptr) {
+    big.resize(2 * big.size());
+  }
+  return out.write(big.data(), end - big.data());
+}
+
+} // namespace vepp
+
+#endif
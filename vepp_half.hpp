@@ -0,0 +1,331 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_HALF_HPP
+#define VEPP_HALF_HPP
+#include "vepp.hpp"
+#include "vepp_simd.hpp"
+#include <cstdint>
+#include <cstring>
+
+/** 16 bit floating point storage
+
+  half is IEEE binary16 (5 exponent bits, 10 mantissa bits) and bfloat16
+  keeps the 8 exponent bits of float with 7 mantissa bits. Both are
+  storage types: they convert to float for every operation, so
+  VecN<half, N> and VecNArray<half, N> compute in float and round the
+  result back, and dot products should be accumulated in float or double
+  with the dot<Acc> overloads. Conversions round to nearest even. Bulk
+  conversions use F16C when the CPU has it and the active instruction set
+  is at least AVX2, the portable bit manipulation otherwise.
+ */
+namespace vepp {
+
+struct half {
+  std::uint16_t bits;
+
+  half() = default;
+  half(float f) : bits(from_float(f)) {}
+  operator float() const { return to_float(bits); }
+
+  half &operator+=(float v) { return *this = half(to_float(bits) + v); }
+  half &operator-=(float v) { return *this = half(to_float(bits) - v); }
+  half &operator*=(float v) { return *this = half(to_float(bits) * v); }
+  half &operator/=(float v) { return *this = half(to_float(bits) / v); }
+
+  static half from_bits(std::uint16_t b) {
+    half h;
+    h.bits = b;
+    return h;
+  }
+  static std::uint16_t from_float(float f) {
+    std::uint32_t x = 0;
+    std::memcpy(&x, &f, sizeof(x));
+    const std::uint32_t sign = (x >> 16) & 0x8000u;
+    x &= 0x7fffffffu;
+    std::uint32_t out = 0;
+    if (x >= 0x47800000u) {
+      // too large for binary16, or already inf or nan
+      out = x > 0x7f800000u ? 0x7e00u : 0x7c00u;
+    } else if (x < 0x38800000u) {
+      // subnormal or zero: adding 0.5 lines the 10 mantissa bits up at
+      // the bottom of the float and lets the FPU round to nearest even
+      float a = 0;
+      std::memcpy(&a, &x, sizeof(a));
+      a += 0.5f;
+      std::memcpy(&out, &a, sizeof(out));
+      out -= 0x3f000000u;
+    } else {
+      const std::uint32_t odd = (x >> 13) & 1u;
+      // rebias the exponent from 127 to 15 and round to nearest even
+      x += 0xc8000fffu + odd;
+      out = x >> 13;
+    }
+    return static_cast<std::uint16_t>(sign | out);
+  }
+  static float to_float(std::uint16_t h) {
+    const std::uint32_t exp_mask = 0x7c00u << 13;
+    std::uint32_t x = (static_cast<std::uint32_t>(h) & 0x7fffu) << 13;
+    const std::uint32_t exp = x & exp_mask;
+    x += (127u - 15u) << 23;
+    float f = 0;
+    if (exp == exp_mask) {
+      // inf or nan
+      x += (128u - 16u) << 23;
+    } else if (exp == 0) {
+      // subnormal, renormalized by the FPU
+      x += 1u << 23;
+      std::memcpy(&f, &x, sizeof(f));
+      f -= 6.103515625e-05f; // 2^-14
+      std::memcpy(&x, &f, sizeof(x));
+    }
+    x |= (static_cast<std::uint32_t>(h) & 0x8000u) << 16;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+  }
+};
+
+struct bfloat16 {
+  std::uint16_t bits;
+
+  bfloat16() = default;
+  bfloat16(float f) : bits(from_float(f)) {}
+  operator float() const { return to_float(bits); }
+
+  bfloat16 &operator+=(float v) {
+    return *this = bfloat16(to_float(bits) + v);
+  }
+  bfloat16 &operator-=(float v) {
+    return *this = bfloat16(to_float(bits) - v);
+  }
+  bfloat16 &operator*=(float v) {
+    return *this = bfloat16(to_float(bits) * v);
+  }
+  bfloat16 &operator/=(float v) {
+    return *this = bfloat16(to_float(bits) / v);
+  }
+
+  static bfloat16 from_bits(std::uint16_t b) {
+    bfloat16 h;
+    h.bits = b;
+    return h;
+  }
+  static std::uint16_t from_float(float f) {
+    std::uint32_t x = 0;
+    std::memcpy(&x, &f, sizeof(x));
+    if ((x & 0x7fffffffu) > 0x7f800000u) {
+      // keep nan a quiet nan, rounding could turn it into inf
+      return static_cast<std::uint16_t>((x >> 16) | 0x40u);
+    }
+    x += 0x7fffu + ((x >> 16) & 1u);
+    return static_cast<std::uint16_t>(x >> 16);
+  }
+  static float to_float(std::uint16_t h) {
+    const std::uint32_t x = static_cast<std::uint32_t>(h) << 16;
+    float f = 0;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+  }
+};
+
+static_assert(sizeof(half) == 2 && sizeof(bfloat16) == 2,
+              "16 bit floats must not be padded");
+
+namespace simd {
+
+/** portable bulk conversions*/
+namespace scalar {
+template <class H> void widen(const H *in, float *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = H::to_float(in[i].bits);
+  }
+}
+template <class H> void narrow(const float *in, H *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i].bits = H::from_float(in[i]);
+  }
+}
+} // namespace scalar
+
+#if VEPP_SIMD_X86
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx,f16c"))),           \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx,f16c")
+#endif
+namespace f16c {
+
+inline void widen(const half *in, float *out, std::size_t n) {
+  const std::uint16_t *h = &in->bits;
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(h + i));
+    _mm256_storeu_ps(out + i, _mm256_cvtph_ps(v));
+  }
+  scalar::widen(in + i, out + i, n - i);
+}
+inline void narrow(const float *in, half *out, std::size_t n) {
+  std::uint16_t *h = &out->bits;
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i v = _mm256_cvtps_ph(_mm256_loadu_ps(in + i),
+                                _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(h + i), v);
+  }
+  scalar::narrow(in + i, out + i, n - i);
+}
+
+} // namespace f16c
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+/** true when the F16C conversions are used*/
+inline bool use_f16c() {
+  static const bool has =
+      (__builtin_cpu_init(), __builtin_cpu_supports("f16c") != 0);
+  return has && active_isa() >= ISA_AVX2;
+}
+
+#else
+
+inline bool use_f16c() { return false; }
+
+#endif
+
+template <> struct converter<half, float> {
+  static void apply(const half *in, float *out, std::size_t n) {
+#if VEPP_SIMD_X86
+    if (use_f16c()) {
+      f16c::widen(in, out, n);
+      return;
+    }
+#endif
+    scalar::widen(in, out, n);
+  }
+};
+template <> struct converter<float, half> {
+  static void apply(const float *in, half *out, std::size_t n) {
+#if VEPP_SIMD_X86
+    if (use_f16c()) {
+      f16c::narrow(in, out, n);
+      return;
+    }
+#endif
+    scalar::narrow(in, out, n);
+  }
+};
+template <> struct converter<bfloat16, float> {
+  static void apply(const bfloat16 *in, float *out, std::size_t n) {
+    scalar::widen(in, out, n);
+  }
+};
+template <> struct converter<float, bfloat16> {
+  static void apply(const float *in, bfloat16 *out, std::size_t n) {
+    scalar::narrow(in, out, n);
+  }
+};
+
+/** dot products of 16 bit floats: blocks are widened to float, float
+ * accumulation uses the bulk dot kernel*/
+template <class Acc, class H> struct widening_half_dot {
+  static Acc apply(const H *a, const H *b, std::size_t n) {
+    const std::size_t block = 256;
+    float x[block], y[block];
+    Acc out = static_cast<Acc>(0);
+    for (std::size_t i = 0; i < n; i += block) {
+      const std::size_t len = n - i < block ? n - i : block;
+      convert(a + i, x, len);
+      convert(b + i, y, len);
+      out += widening_dot<Acc, float>::apply(x, y, len);
+    }
+    return out;
+  }
+};
+template <class Acc> struct widening_dot<Acc, half>
+    : widening_half_dot<Acc, half> {};
+template <class Acc> struct widening_dot<Acc, bfloat16>
+    : widening_half_dot<Acc, bfloat16> {};
+/** accumulating in the storage type would lose most of the sum*/
+template <> struct widening_dot<half, half> {
+  static half apply(const half *a, const half *b, std::size_t n) {
+    return half(widening_half_dot<float, half>::apply(a, b, n));
+  }
+};
+template <> struct widening_dot<bfloat16, bfloat16> {
+  static bfloat16 apply(const bfloat16 *a, const bfloat16 *b,
+                        std::size_t n) {
+    return bfloat16(widening_half_dot<float, bfloat16>::apply(a, b, n));
+  }
+};
+
+/** fixed size dot products of VecN<half, N>, accumulated in float*/
+template <unsigned int N> struct fixed<half, N> {
+  static half dot(const half *a, const half *b) {
+    float out = 0;
+    for (unsigned int i = 0; i < N; i++) {
+      out += static_cast<float>(a[i]) * static_cast<float>(b[i]);
+    }
+    return half(out);
+  }
+};
+template <unsigned int N> struct fixed<bfloat16, N> {
+  static bfloat16 dot(const bfloat16 *a, const bfloat16 *b) {
+    float out = 0;
+    for (unsigned int i = 0; i < N; i++) {
+      out += static_cast<float>(a[i]) * static_cast<float>(b[i]);
+    }
+    return bfloat16(out);
+  }
+};
+
+} // namespace simd
+
+/** VecN aliases for 16 bit storage*/
+template <unsigned int N, class Policy = CheckedPolicy>
+using VecNHalf = VecN<half, N, Policy>;
+template <unsigned int N, class Policy = CheckedPolicy>
+using VecNBFloat16 = VecN<bfloat16, N, Policy>;
+
+} // namespace vepp
+
+#endif
@@ -0,0 +1,304 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_INSTRUMENT_HPP
+#define VEPP_INSTRUMENT_HPP
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+#if defined(VEPP_INSTRUMENT_TIMING)
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+#endif
+
+/** Opt-in instrumentation
+
+  Defining VEPP_INSTRUMENT makes every VecN method count its calls and
+  every failed precondition count its status_t. VEPP_INSTRUMENT_TIMING
+  also accumulates time stamp counter ticks per method. Without these
+  macros VEPP_PROBE expands to nothing and nothing is counted.
+
+  Counters live in a block per thread that only its thread writes, with
+  relaxed atomic loads and stores, so counting takes no lock and no
+  locked instruction. snapshot() sums the blocks of every thread that
+  ever counted something. Counts are per method entry: a method built
+  on another one also counts the inner call, ie add counts an apply_el.
+ */
+namespace vepp {
+
+enum status_t : std::uint8_t;
+inline const char *status_name(status_t status);
+
+namespace instrument {
+
+enum op_t : std::uint8_t {
+  OP_GET,
+  OP_SET,
+  OP_BASE,
+  OP_APPLY_EL,
+  OP_ADD,
+  OP_SUBTRACT,
+  OP_MULTIPLY,
+  OP_DIVIDE,
+  OP_DOT,
+  OP_CROSS,
+  OP_TRIPLE,
+  OP_LENGTH,
+  OP_DISTANCE,
+  OP_NORMALIZE,
+  OP_AXPY,
+  OP_FMA,
+  OP_COUNT
+};
+
+inline const char *op_name(op_t op) {
+  static const char *const names[OP_COUNT] = {
+      "get",      "set",      "base", "apply_el", "add",
+      "subtract", "multiply", "divide", "dot",    "cross",
+      "triple",   "length",   "distance", "normalize", "axpy",
+      "fma"};
+  return op < OP_COUNT ? names[op] : "unknown";
+}
+
+/** status_t values index the failure counters, vepp.hpp checks that this
+ * is its STATUS_COUNT*/
+static const unsigned int nb_status = 9;
+
+#if defined(VEPP_INSTRUMENT)
+static const bool enabled = true;
+#else
+static const bool enabled = false;
+#endif
+
+/** counters of one thread*/
+struct ThreadCounters {
+  std::atomic<std::uint64_t> calls[OP_COUNT];
+  std::atomic<std::uint64_t> ticks[OP_COUNT];
+  std::atomic<std::uint64_t> failures[nb_status];
+  ThreadCounters *next;
+
+  ThreadCounters() : next(nullptr) {
+    for (unsigned int i = 0; i < OP_COUNT; i++) {
+      calls[i].store(0, std::memory_order_relaxed);
+      ticks[i].store(0, std::memory_order_relaxed);
+    }
+    for (unsigned int i = 0; i < nb_status; i++) {
+      failures[i].store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+/** every thread block, blocks are never freed so the counts of finished
+ * threads stay in the snapshots*/
+inline std::atomic<ThreadCounters *> &registry() {
+  static std::atomic<ThreadCounters *> head(nullptr);
+  return head;
+}
+
+inline ThreadCounters &local() {
+  thread_local ThreadCounters *mine = nullptr;
+  if (mine == nullptr) {
+    mine = new ThreadCounters();
+    ThreadCounters *head = registry().load(std::memory_order_relaxed);
+    do {
+      mine->next = head;
+    } while (!registry().compare_exchange_weak(head, mine,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+  }
+  return *mine;
+}
+
+/** only the owning thread writes a counter, a plain load and store is
+ * enough and keeps the lock prefix out of the hot path*/
+inline void bump(std::atomic<std::uint64_t> &c, std::uint64_t v) {
+  c.store(c.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+inline void hit(op_t op) { bump(local().calls[op], 1); }
+inline void fail(status_t s) {
+  bump(local().failures[static_cast<unsigned int>(s) % nb_status], 1);
+}
+
+#if defined(VEPP_INSTRUMENT_TIMING)
+inline std::uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/** counts a call and accumulates its ticks when the scope ends*/
+class Probe {
+  op_t op;
+  std::uint64_t start;
+
+public:
+  explicit Probe(op_t o) : op(o), start(ticks()) { hit(o); }
+  ~Probe() { bump(local().ticks[op], ticks() - start); }
+};
+#endif
+
+/** counts summed over every thread*/
+struct Snapshot {
+  std::uint64_t calls[OP_COUNT];
+  std::uint64_t ticks[OP_COUNT];
+  std::uint64_t failures[nb_status];
+
+  std::uint64_t total_failures() const {
+    std::uint64_t n = 0;
+    for (unsigned int i = 0; i < nb_status; i++) {
+      n += failures[i];
+    }
+    return n;
+  }
+};
+
+inline Snapshot snapshot() {
+  Snapshot s;
+  for (unsigned int i = 0; i < OP_COUNT; i++) {
+    s.calls[i] = 0;
+    s.ticks[i] = 0;
+  }
+  for (unsigned int i = 0; i < nb_status; i++) {
+    s.failures[i] = 0;
+  }
+  for (ThreadCounters *t = registry().load(std::memory_order_acquire);
+       t != nullptr; t = t->next) {
+    for (unsigned int i = 0; i < OP_COUNT; i++) {
+      s.calls[i] += t->calls[i].load(std::memory_order_relaxed);
+      s.ticks[i] += t->ticks[i].load(std::memory_order_relaxed);
+    }
+    for (unsigned int i = 0; i < nb_status; i++) {
+      s.failures[i] += t->failures[i].load(std::memory_order_relaxed);
+    }
+  }
+  return s;
+}
+
+/** zeroes every counter, counts of threads running meanwhile may be
+ * lost*/
+inline void reset() {
+  for (ThreadCounters *t = registry().load(std::memory_order_acquire);
+       t != nullptr; t = t->next) {
+    for (unsigned int i = 0; i < OP_COUNT; i++) {
+      t->calls[i].store(0, std::memory_order_relaxed);
+      t->ticks[i].store(0, std::memory_order_relaxed);
+    }
+    for (unsigned int i = 0; i < nb_status; i++) {
+      t->failures[i].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+/** human readable table of the non zero counters*/
+inline void write(std::ostream &out, const Snapshot &s) {
+  out << "vepp calls:\n";
+  for (unsigned int i = 0; i < OP_COUNT; i++) {
+    if (s.calls[i] == 0)
+      continue;
+    out << "  " << op_name(static_cast<op_t>(i)) << " " << s.calls[i]
+        << " calls";
+    if (s.ticks[i] != 0) {
+      out << " " << s.ticks[i] << " ticks";
+    }
+    out << "\n";
+  }
+  out << "vepp failures:\n";
+  for (unsigned int i = 0; i < nb_status; i++) {
+    if (s.failures[i] == 0)
+      continue;
+    out << "  " << status_name(static_cast<status_t>(i)) << " "
+        << s.failures[i] << "\n";
+  }
+}
+
+/** one counter per line in the csv layout of perf stat -x, (value, unit,
+ * event name) so the output can go through the same scripts*/
+inline void write_perf_stat(std::ostream &out, const Snapshot &s) {
+  for (unsigned int i = 0; i < OP_COUNT; i++) {
+    const char *name = op_name(static_cast<op_t>(i));
+    out << s.calls[i] << ",,vepp." << name << ".calls\n";
+    out << s.ticks[i] << ",ticks,vepp." << name << ".ticks\n";
+  }
+  for (unsigned int i = 0; i < nb_status; i++) {
+    const char *name = status_name(static_cast<status_t>(i));
+    if (std::strcmp(name, "UNKNOWN") == 0 || std::strcmp(name, "SUCCESS") == 0)
+      continue;
+    out << s.failures[i] << ",,vepp.failures." << name << "\n";
+  }
+}
+
+} // namespace instrument
+} // namespace vepp
+
+/** probes used inside the vepp methods*/
+#if defined(VEPP_INSTRUMENT_TIMING)
+#define VEPP_PROBE(op)                                                         \
+  ::vepp::instrument::Probe vepp_probe_(::vepp::instrument::op)
+#elif defined(VEPP_INSTRUMENT)
+#define VEPP_PROBE(op)                                                         \
+  do {                                                                         \
+    if (!VEPP_IS_CONSTANT_EVALUATED())                                         \
+      ::vepp::instrument::hit(::vepp::instrument::op);                         \
+  } while (0)
+#else
+#define VEPP_PROBE(op)                                                         \
+  do {                                                                         \
+  } while (0)
+#endif
+
+#if defined(VEPP_INSTRUMENT)
+#define VEPP_PROBE_FAIL(status)                                                \
+  do {                                                                         \
+    if (!VEPP_IS_CONSTANT_EVALUATED())                                         \
+      ::vepp::instrument::fail(status);                                        \
+  } while (0)
+#else
+#define VEPP_PROBE_FAIL(status)                                                \
+  do {                                                                         \
+  } while (0)
+#endif
+
+#endif
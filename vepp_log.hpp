@@ -0,0 +1,394 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_LOG_HPP
+#define VEPP_LOG_HPP
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+/** Asynchronous diagnostics
+
+  post() writes a compact record (status, function, file, line) into a
+  ring buffer of the calling thread and returns. The strings are only
+  pointers to static storage, nothing is formatted or allocated on the
+  caller side. A background thread drains the rings, merges repeated
+  identical records, enforces a rate limit and does the formatting.
+
+  A ring has a single producer, its thread, and a single consumer, the
+  sink thread, so it only needs an acquire/release pair per record. A
+  full ring drops the record and counts it. The sink sleeps on a
+  condition variable while every ring is empty, a record that makes a ring
+  non empty wakes it. The ring of a thread is freed by the sink once the
+  thread has exited and its records are written. With VEPP_ASYNC_LOG
+  defined INFO and INFO_VERBOSE go through post() instead of std::cerr.
+ */
+namespace vepp {
+
+enum status_t : std::uint8_t;
+inline const char *status_name(status_t status);
+
+namespace async_log {
+
+struct Record {
+  const char *fn_name;
+  const char *file_name;
+  std::uint32_t line_info;
+  status_t status;
+
+  bool same(const Record &r) const {
+    return status == r.status && line_info == r.line_info &&
+           fn_name == r.fn_name && file_name == r.file_name;
+  }
+};
+
+/** single producer single consumer ring of one thread*/
+struct Ring {
+  static const std::uint32_t capacity = 1024;
+  Record records[capacity];
+  alignas(64) std::atomic<std::uint32_t> head;
+  alignas(64) std::atomic<std::uint32_t> tail;
+  std::atomic<std::uint64_t> dropped;
+  /** set when the thread of the ring exits*/
+  std::atomic<bool> retired;
+  /** consumer side copy of dropped already reported*/
+  std::uint64_t reported;
+  Ring *next;
+
+  Ring()
+      : head(0), tail(0), dropped(0), retired(false), reported(0),
+        next(nullptr) {}
+
+  /** false when the ring is full, first tells whether the consumer had
+   * taken every earlier record, ie it may be asleep and needs a wake up*/
+  bool push(const Record &r, bool &first) {
+    std::uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == capacity) {
+      dropped.store(dropped.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+      first = false;
+      return false;
+    }
+    records[t % capacity] = r;
+    tail.store(t + 1, std::memory_order_release);
+    // pairs with the fence of Sink::run: either the sink sees this record
+    // before it sleeps or this load sees that it took the earlier ones
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    first = head.load(std::memory_order_relaxed) == t;
+    return true;
+  }
+  bool empty() const {
+    return head.load(std::memory_order_relaxed) ==
+           tail.load(std::memory_order_acquire);
+  }
+  bool pop(Record &r) {
+    std::uint32_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    r = records[h % capacity];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+/** consumer thread, created with the first ring*/
+class Sink {
+  std::atomic<Ring *> rings;
+  std::atomic<std::ostream *> output;
+  std::atomic<unsigned int> rate;
+  std::atomic<std::uint64_t> flush_requested;
+  std::atomic<std::uint64_t> flush_done;
+  std::atomic<bool> stop;
+  std::atomic<std::size_t> nb_rings;
+
+  /** the sink sleeps on wake until pending, flush waits on flushed*/
+  std::mutex lock;
+  std::condition_variable wake, flushed;
+  bool pending;
+
+  // consumer state
+  Record last;
+  std::uint64_t repeats;
+  bool has_last;
+  std::chrono::steady_clock::time_point window;
+  unsigned int lines;
+  std::uint64_t suppressed;
+
+  std::thread worker;
+
+  void line(std::ostream &out, const Record &r) {
+    if (lines >= rate.load(std::memory_order_relaxed)) {
+      suppressed++;
+      return;
+    }
+    lines++;
+    out << status_name(r.status) << " at " << r.fn_name
+        << " :: " << r.file_name << " :: " << r.line_info << "\n";
+  }
+  void end_repeats(std::ostream &out) {
+    if (repeats > 0) {
+      out << "last message repeated " << repeats << " times\n";
+      repeats = 0;
+    }
+  }
+  void tick(std::ostream &out) {
+    std::chrono::steady_clock::time_point now =
+        std::chrono::steady_clock::now();
+    if (now - window >= std::chrono::seconds(1)) {
+      if (suppressed > 0) {
+        out << suppressed << " messages suppressed by the rate limit\n";
+      }
+      window = now;
+      lines = 0;
+      suppressed = 0;
+    }
+  }
+  /** takes g out of the list, rings are only added at the head*/
+  void unlink(Ring *prev, Ring *g) {
+    if (prev != nullptr) {
+      prev->next = g->next;
+      return;
+    }
+    Ring *head = g;
+    if (!rings.compare_exchange_strong(head, g->next,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      // rings were added in front of g
+      while (head->next != g) {
+        head = head->next;
+      }
+      head->next = g->next;
+    }
+  }
+  /** formats everything queued so far, true when a record was found.
+   * Rings of exited threads are freed once empty*/
+  bool drain(std::ostream &out) {
+    bool found = false;
+    tick(out);
+    Ring *prev = nullptr;
+    for (Ring *g = rings.load(std::memory_order_acquire); g != nullptr;) {
+      // read first, the thread pushed everything before it retired
+      const bool gone = g->retired.load(std::memory_order_acquire);
+      Record r;
+      while (g->pop(r)) {
+        found = true;
+        if (has_last && r.same(last)) {
+          repeats++;
+          continue;
+        }
+        end_repeats(out);
+        line(out, r);
+        last = r;
+        has_last = true;
+      }
+      std::uint64_t d = g->dropped.load(std::memory_order_relaxed);
+      if (d != g->reported) {
+        out << d - g->reported << " messages dropped, ring full\n";
+        g->reported = d;
+      }
+      Ring *next = g->next;
+      if (gone) {
+        unlink(prev, g);
+        delete g;
+        nb_rings.fetch_sub(1, std::memory_order_relaxed);
+      } else {
+        prev = g;
+      }
+      g = next;
+    }
+    return found;
+  }
+  /** true when no ring holds a record*/
+  bool idle() const {
+    for (Ring *g = rings.load(std::memory_order_acquire); g != nullptr;
+         g = g->next) {
+      if (!g->empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+  void run() {
+    while (true) {
+      std::uint64_t requested = flush_requested.load(std::memory_order_acquire);
+      bool stopping = stop.load(std::memory_order_acquire);
+      std::ostream &out = *output.load(std::memory_order_acquire);
+      bool found = drain(out);
+      if (requested != flush_done.load(std::memory_order_relaxed) ||
+          stopping) {
+        end_repeats(out);
+        has_last = false;
+        out.flush();
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          flush_done.store(requested, std::memory_order_release);
+        }
+        flushed.notify_all();
+      } else if (!found) {
+        std::unique_lock<std::mutex> guard(lock);
+        // pairs with the fence of Ring::push
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wake.wait(guard, [this] { return pending || !idle(); });
+        pending = false;
+      }
+      if (stopping) {
+        return;
+      }
+    }
+  }
+
+public:
+  Sink()
+      : rings(nullptr), output(&std::cerr), rate(100), flush_requested(0),
+        flush_done(0), stop(false), nb_rings(0), pending(false), repeats(0),
+        has_last(false), window(std::chrono::steady_clock::now()), lines(0),
+        suppressed(0) {
+    worker = std::thread(&Sink::run, this);
+  }
+  ~Sink() {
+    stop.store(true, std::memory_order_release);
+    notify();
+    worker.join();
+  }
+
+  void add(Ring *g) {
+    nb_rings.fetch_add(1, std::memory_order_relaxed);
+    Ring *head = rings.load(std::memory_order_relaxed);
+    do {
+      g->next = head;
+    } while (!rings.compare_exchange_weak(head, g, std::memory_order_release,
+                                          std::memory_order_relaxed));
+  }
+  void set_output(std::ostream &out) {
+    output.store(&out, std::memory_order_release);
+  }
+  void set_rate_limit(unsigned int lines_per_second) {
+    rate.store(lines_per_second, std::memory_order_relaxed);
+  }
+  /** wakes the sink thread up*/
+  void notify() {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      pending = true;
+    }
+    wake.notify_one();
+  }
+  /** waits until everything posted before the call is written*/
+  void flush() {
+    std::uint64_t r =
+        flush_requested.fetch_add(1, std::memory_order_acq_rel) + 1;
+    notify();
+    std::unique_lock<std::mutex> guard(lock);
+    flushed.wait(guard, [this, r] {
+      return flush_done.load(std::memory_order_acquire) >= r;
+    });
+  }
+  /** rings not freed yet, one per thread that posted and is running or
+   * has records left*/
+  std::size_t rings_alive() const {
+    return nb_rings.load(std::memory_order_relaxed);
+  }
+};
+
+inline Sink &sink() {
+  static Sink s;
+  return s;
+}
+
+/** ring of a thread, retired when the thread exits so that the sink
+ * frees it after writing its last records*/
+struct Local {
+  Ring *ring;
+
+  Local() : ring(nullptr) {}
+  ~Local() {
+    if (ring != nullptr) {
+      ring->retired.store(true, std::memory_order_release);
+      ring = nullptr;
+    }
+  }
+};
+
+/** ring of the calling thread*/
+inline Ring &local() {
+  thread_local Local mine;
+  if (mine.ring == nullptr) {
+    mine.ring = new Ring();
+    sink().add(mine.ring);
+  }
+  return *mine.ring;
+}
+
+/** queues a record, false when the ring was full and it got dropped*/
+inline bool post(status_t status, const char *fn, const char *file,
+                 unsigned int line) {
+  Record r;
+  r.fn_name = fn;
+  r.file_name = file;
+  r.line_info = line;
+  r.status = status;
+  bool first = false;
+  bool pushed = local().push(r, first);
+  if (first) {
+    sink().notify();
+  }
+  return pushed;
+}
+
+/** where the sink writes, std::cerr by default*/
+inline void set_output(std::ostream &out) { sink().set_output(out); }
+
+/** formatted lines per second, the rest is counted and reported*/
+inline void set_rate_limit(unsigned int lines_per_second) {
+  sink().set_rate_limit(lines_per_second);
+}
+
+inline void flush() { sink().flush(); }
+
+/** number of thread rings the sink still holds*/
+inline std::size_t rings_alive() { return sink().rings_alive(); }
+
+} // namespace async_log
+} // namespace vepp
+
+#endif
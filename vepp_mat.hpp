@@ -0,0 +1,324 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_MAT_HPP
+#define VEPP_MAT_HPP
+#include "vepp.hpp"
+#include "vepp_array.hpp"
+#include <cstddef>
+
+namespace vepp {
+
+/** Dense R x C matrix
+
+  The elements are stored contiguously in row major order. Products with
+  VecN, with other matrices and with whole VecNArray batches follow the
+  VecN conventions: the result goes to an output argument, which may be
+  one of the operands, and a Result is returned. Policy is the error
+  policy, as for VecN.
+ */
+template <class T, unsigned int R, unsigned int C,
+          class Policy = CheckedPolicy>
+class MatNM {
+  template <class, unsigned int, unsigned int, class> friend class MatNM;
+
+  /** row major elements*/
+  std::array<T, R * C> data;
+
+  /** elements of a tile x tile block of T fit in 16 KB of L1*/
+  static const unsigned int tile = sizeof(T) > 4 ? 32 : 64;
+
+  /** o = this * m, o is R x K and does not alias the operands*/
+  template <unsigned int K>
+  void matmul(const MatNM<T, C, K, Policy> &m, T *o) const {
+    const T *b = m.data.data();
+    if (R <= tile && C <= tile && K <= tile) {
+      simd::matmul_n<T, R, C, K>(data.data(), b, o);
+      return;
+    }
+    for (unsigned int i = 0; i < R * K; i++) {
+      o[i] = static_cast<T>(0);
+    }
+    for (unsigned int i0 = 0; i0 < R; i0 += tile) {
+      const unsigned int i1 = i0 + tile < R ? i0 + tile : R;
+      for (unsigned int k0 = 0; k0 < C; k0 += tile) {
+        const unsigned int k1 = k0 + tile < C ? k0 + tile : C;
+        for (unsigned int j0 = 0; j0 < K; j0 += tile) {
+          const unsigned int j1 = j0 + tile < K ? j0 + tile : K;
+          // two rows of o are accumulated together so every row of m
+          // loaded from cache is used twice
+          unsigned int i = i0;
+          for (; i + 2 <= i1; i += 2) {
+            T *o0 = o + i * K;
+            T *o1 = o0 + K;
+            for (unsigned int k = k0; k < k1; k++) {
+              const T a0 = data[i * C + k];
+              const T a1 = data[(i + 1) * C + k];
+              const T *bk = b + k * K;
+              for (unsigned int j = j0; j < j1; j++) {
+                o0[j] += a0 * bk[j];
+                o1[j] += a1 * bk[j];
+              }
+            }
+          }
+          for (; i < i1; i++) {
+            T *o0 = o + i * K;
+            for (unsigned int k = k0; k < k1; k++) {
+              const T a0 = data[i * C + k];
+              const T *bk = b + k * K;
+              for (unsigned int j = j0; j < j1; j++) {
+                o0[j] += a0 * bk[j];
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+public:
+  typedef T value_type;
+  static const unsigned int rows = R;
+  static const unsigned int cols = C;
+
+  /*! Tested */
+  /** zero, like VecN an output built by default is never indeterminate*/
+  VEPP_CONSTEXPR MatNM() : data() {}
+  /*! Tested */
+  VEPP_CONSTEXPR MatNM(T s) : data() {
+    for (unsigned int i = 0; i < R * C; i++) {
+      data[i] = s;
+    }
+  }
+  /*! Tested */
+  VEPP_CONSTEXPR MatNM(const std::array<T, R * C> &arr) : data(arr) {}
+  /*! Tested */
+  static VEPP_CONSTEXPR MatNM<T, R, C, Policy> identity() {
+    static_assert(R == C, "identity matrix has to be square");
+    MatNM<T, R, C, Policy> out(static_cast<T>(0));
+    for (unsigned int i = 0; i < R; i++) {
+      out.data[i * C + i] = static_cast<T>(1);
+    }
+    return out;
+  }
+  VEPP_CONSTEXPR Result size(unsigned int &nb_rows,
+                             unsigned int &nb_cols) const {
+    nb_rows = R;
+    nb_cols = C;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  VEPP_CONSTEXPR Result get(unsigned int r, unsigned int c, T &out) const {
+    if (policy_fails<Policy>(r < R && c < C, INDEX_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    out = data[r * C + c];
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result get(std::array<T, R * C> &out) const {
+    out = data;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  VEPP_CONSTEXPR Result set(unsigned int r, unsigned int c, T el) {
+    if (policy_fails<Policy>(r < R && c < C, INDEX_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    data[r * C + c] = el;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  template <class P, class S>
+  VEPP_CONSTEXPR Result row(unsigned int r, VecN<T, C, P, S> &out) const {
+    if (policy_fails<Policy>(r < R, INDEX_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    std::array<T, C> arr{};
+    for (unsigned int c = 0; c < C; c++) {
+      arr[c] = data[r * C + c];
+    }
+    out = VecN<T, C, P, S>(arr);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  template <class P, class S>
+  VEPP_CONSTEXPR Result col(unsigned int c, VecN<T, R, P, S> &out) const {
+    if (policy_fails<Policy>(c < C, INDEX_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    std::array<T, R> arr{};
+    for (unsigned int r = 0; r < R; r++) {
+      arr[r] = data[r * C + c];
+    }
+    out = VecN<T, R, P, S>(arr);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  VEPP_CONSTEXPR Result transpose(MatNM<T, C, R, Policy> &out) const {
+    // a square matrix may be transposed in place
+    std::array<T, R * C> arr{};
+    for (unsigned int r = 0; r < R; r++) {
+      for (unsigned int c = 0; c < C; c++) {
+        arr[c * R + r] = data[r * C + c];
+      }
+    }
+    out.data = arr;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result add(const MatNM<T, R, C, Policy> &m,
+                            MatNM<T, R, C, Policy> &out) const {
+    for (unsigned int i = 0; i < R * C; i++) {
+      out.data[i] = data[i] + m.data[i];
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result subtract(const MatNM<T, R, C, Policy> &m,
+                                 MatNM<T, R, C, Policy> &out) const {
+    for (unsigned int i = 0; i < R * C; i++) {
+      out.data[i] = data[i] - m.data[i];
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result multiply(T s, MatNM<T, R, C, Policy> &out) const {
+    for (unsigned int i = 0; i < R * C; i++) {
+      out.data[i] = data[i] * s;
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** matrix vector product, out = this * v*/
+  template <class P, class S>
+  Result multiply(const VecN<T, C, P, S> &v, VecN<T, R, P, S> &out) const {
+    std::array<T, C> x;
+    for (unsigned int c = 0; c < C; c++) {
+      x[c] = v.eval(c);
+    }
+    std::array<T, R> y;
+    simd::matvec_n<T, R, C>(data.data(), x.data(), y.data());
+    out = VecN<T, R, P, S>(y);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** vector matrix product, out = v^T * this*/
+  template <class P, class S>
+  Result left_multiply(const VecN<T, R, P, S> &v, VecN<T, C, P, S> &out) const {
+    std::array<T, C> y;
+    for (unsigned int c = 0; c < C; c++) {
+      y[c] = static_cast<T>(0);
+    }
+    for (unsigned int r = 0; r < R; r++) {
+      const T vr = v.eval(r);
+      for (unsigned int c = 0; c < C; c++) {
+        y[c] += vr * data[r * C + c];
+      }
+    }
+    out = VecN<T, C, P, S>(y);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** matrix product, tiled for large matrices*/
+  template <unsigned int K>
+  Result multiply(const MatNM<T, C, K, Policy> &m,
+                  MatNM<T, R, K, Policy> &out) const {
+    const void *o = &out;
+    if (o == static_cast<const void *>(this) ||
+        o == static_cast<const void *>(&m)) {
+      MatNM<T, R, K, Policy> tmp;
+      matmul(m, tmp.data.data());
+      out = tmp;
+    } else {
+      matmul(m, out.data.data());
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** transforms every vector of a batch, out may be in*/
+  Result multiply(const VecNArray<T, C> &in, VecNArray<T, R> &out) const {
+    if (static_cast<const void *>(&in) == static_cast<const void *>(&out)) {
+      // the kernel reads every input lane for every output lane
+      VecNArray<T, C> copy(in);
+      Result res = multiply(copy, out);
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+      return vflag;
+    }
+    std::size_t n = 0;
+    in.size(n);
+    out.resize_for_overwrite(n);
+    const T *src[C];
+    T *dst[R];
+    for (unsigned int k = 0; k < C; k++) {
+      in.lane(k, src[k]);
+    }
+    for (unsigned int r = 0; r < R; r++) {
+      out.lane(r, dst[r]);
+    }
+    simd::transform(data.data(), R, C, src, dst, n);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+};
+
+/** MatNM aliases for each error policy*/
+template <class T, unsigned int R, unsigned int C>
+using MatNMChecked = MatNM<T, R, C, CheckedPolicy>;
+template <class T, unsigned int R, unsigned int C>
+using MatNMThrow = MatNM<T, R, C, ThrowPolicy>;
+template <class T, unsigned int R, unsigned int C>
+using MatNMAssert = MatNM<T, R, C, AssertPolicy>;
+template <class T, unsigned int R, unsigned int C>
+using MatNMUnchecked = MatNM<T, R, C, UncheckedPolicy>;
+
+} // namespace vepp
+
+#endif
@@ -0,0 +1,257 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_MEMORY_HPP
+#define VEPP_MEMORY_HPP
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace vepp {
+
+/** allocates size bytes aligned to align (a power of two), throws
+ * std::bad_alloc on failure*/
+inline void *aligned_allocate(std::size_t size, std::size_t align) {
+  if (align < sizeof(void *))
+    align = sizeof(void *);
+  void *p = nullptr;
+  if (posix_memalign(&p, align, size == 0 ? align : size) != 0)
+    throw std::bad_alloc();
+  return p;
+}
+inline void aligned_free(void *p) { std::free(p); }
+
+/** std compatible allocator returning Align aligned storage*/
+template <class T, std::size_t Align = 64> struct AlignedAllocator {
+  typedef T value_type;
+  static const std::size_t alignment = Align;
+  template <class U> struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+  AlignedAllocator() {}
+  template <class U> AlignedAllocator(const AlignedAllocator<U, Align> &) {}
+
+  T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_alloc();
+    return static_cast<T *>(aligned_allocate(n * sizeof(T), Align));
+  }
+  void deallocate(T *p, std::size_t) { aligned_free(p); }
+
+  /** default initializes, growing a vector of scalars does not write the
+   * new elements so their pages are first touched by whoever fills them*/
+  template <class U> void construct(U *p) {
+    ::new (static_cast<void *>(p)) U;
+  }
+  template <class U, class... Args> void construct(U *p, Args &&...args) {
+    ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+  }
+};
+template <class T, class U, std::size_t A>
+bool operator==(const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) {
+  return true;
+}
+template <class T, class U, std::size_t A>
+bool operator!=(const AlignedAllocator<T, A> &, const AlignedAllocator<U, A> &) {
+  return false;
+}
+
+/** Bump allocator for short lived temporaries
+
+  Arena hands out memory by moving a cursor through large blocks and never
+  frees single allocations. reset rewinds the cursor to the first block
+  and keeps every block, so a request that allocates the same temporaries
+  as the previous one reuses their memory and does not call malloc at all.
+  Whatever was allocated before reset must not be used afterwards, and
+  containers drawing from the arena are destroyed before it is reset. An
+  Arena is not thread safe, each thread uses its own, see thread_arena.
+ */
+class Arena {
+  struct Block {
+    Block *next;
+    std::size_t size;
+  };
+  /** blocks start with their header, the data after it is 64 byte
+   * aligned*/
+  static const std::size_t header_bytes = 64;
+
+  Block *head, *current;
+  char *cursor, *limit;
+  std::size_t block_bytes, nb_blocks;
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  static char *begin_of(Block *b) {
+    return reinterpret_cast<char *>(b) + header_bytes;
+  }
+  void enter(Block *b) {
+    current = b;
+    cursor = begin_of(b);
+    limit = cursor + b->size;
+  }
+  /** moves to the next block that can hold bytes at align, allocating one
+   * after current when there is none*/
+  void advance(std::size_t bytes, std::size_t align) {
+    const std::size_t need = bytes + align;
+    for (Block *b = current ? current->next : head; b; b = b->next) {
+      if (b->size >= need) {
+        enter(b);
+        return;
+      }
+    }
+    const std::size_t size = need > block_bytes ? need : block_bytes;
+    Block *b = static_cast<Block *>(aligned_allocate(header_bytes + size,
+                                                     header_bytes));
+    b->size = size;
+    if (current) {
+      b->next = current->next;
+      current->next = b;
+    } else {
+      b->next = head;
+      head = b;
+    }
+    nb_blocks++;
+    enter(b);
+  }
+
+public:
+  static const std::size_t default_block_bytes = 1 << 16;
+
+  /*! Tested */
+  explicit Arena(std::size_t block = default_block_bytes)
+      : head(nullptr), current(nullptr), cursor(nullptr), limit(nullptr),
+        block_bytes(block), nb_blocks(0) {}
+  ~Arena() {
+    while (head) {
+      Block *next = head->next;
+      aligned_free(head);
+      head = next;
+    }
+  }
+
+  /*! Tested */
+  /** size bytes aligned to align (a power of two)*/
+  void *allocate(std::size_t size, std::size_t align) {
+    if (size > std::numeric_limits<std::size_t>::max() / 2) {
+      throw std::bad_alloc();
+    }
+    std::size_t pad = (align - reinterpret_cast<std::uintptr_t>(cursor) %
+                                   align) % align;
+    if (cursor == nullptr || size + pad > static_cast<std::size_t>(
+                                              limit - cursor)) {
+      advance(size, align);
+      pad = (align - reinterpret_cast<std::uintptr_t>(cursor) % align) %
+            align;
+    }
+    char *p = cursor + pad;
+    cursor = p + size;
+    return p;
+  }
+  /** gives the memory back only when p is the last allocation. A growing
+   * std::vector allocates its new buffer before freeing the old one, so
+   * the old buffers stay used until reset*/
+  void deallocate(void *p, std::size_t size) {
+    if (static_cast<char *>(p) + size == cursor) {
+      cursor = static_cast<char *>(p);
+    }
+  }
+  /*! Tested */
+  /** releases everything allocated so far, the blocks are kept*/
+  void reset() {
+    if (head) {
+      enter(head);
+    }
+  }
+  /** number of blocks and their bytes, without the headers*/
+  std::size_t blocks() const { return nb_blocks; }
+  std::size_t capacity() const {
+    std::size_t n = 0;
+    for (Block *b = head; b; b = b->next) {
+      n += b->size;
+    }
+    return n;
+  }
+};
+
+/** the arena of the calling thread*/
+/*! Tested */
+inline Arena &thread_arena() {
+  static thread_local Arena arena;
+  return arena;
+}
+
+/** std compatible allocator drawing from an Arena, by default the one
+ * of the calling thread. deallocate only gives back the last allocation,
+ * the rest is released by Arena::reset*/
+template <class T> struct ArenaAllocator {
+  typedef T value_type;
+  template <class U> struct rebind { typedef ArenaAllocator<U> other; };
+
+  Arena *arena;
+
+  ArenaAllocator() : arena(&thread_arena()) {}
+  explicit ArenaAllocator(Arena &a) : arena(&a) {}
+  template <class U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+  T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *p, std::size_t n) { arena->deallocate(p, n * sizeof(T)); }
+};
+template <class T, class U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena == b.arena;
+}
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena != b.arena;
+}
+
+/** std::vector whose storage comes from an Arena*/
+template <class T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace vepp
+
+#endif
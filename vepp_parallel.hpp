@@ -0,0 +1,730 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_PARALLEL_HPP
+#define VEPP_PARALLEL_HPP
+#include "vepp_array.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vepp {
+namespace parallel {
+
+/** Work stealing thread pool
+
+  A job is a number of chunks. Every participant, the calling thread and
+  the workers, starts with a contiguous range of chunks, takes chunks from
+  the front of its own range and, once it is empty, steals the back half
+  of another range. A range is a single 64 bit word so both moves are one
+  compare and swap. The initial split is the same for every job of the
+  same size, so a thread keeps working on the memory it touched first.
+
+  Tasks must not throw. A job started by a task of the same pool runs
+  inline on the thread of that task, and callers from several threads,
+  ie on default_pool(), take turns: one job runs at a time.
+ */
+class Pool {
+  struct alignas(64) Slot {
+    /** begin << 32 | end*/
+    std::atomic<std::uint64_t> range;
+  };
+  typedef void (*task_fn)(const void *ctx, std::size_t chunk,
+                          unsigned int participant);
+
+  unsigned int nb;
+  std::unique_ptr<Slot[]> slots;
+  std::vector<std::thread> workers;
+
+  /** held by the caller for the whole job*/
+  std::mutex running;
+  std::mutex m;
+  std::condition_variable wake;
+  std::uint64_t generation;
+  bool stopping;
+  task_fn task;
+  const void *ctx;
+  std::atomic<unsigned int> finished;
+
+  /** the pool whose job the calling thread is working on*/
+  static const Pool *&active() {
+    static thread_local const Pool *p = nullptr;
+    return p;
+  }
+  static std::uint64_t pack(std::uint32_t b, std::uint32_t e) {
+    return (static_cast<std::uint64_t>(b) << 32) | e;
+  }
+  bool pop(unsigned int p, std::size_t &chunk) {
+    std::uint64_t v = slots[p].range.load(std::memory_order_relaxed);
+    while (true) {
+      std::uint32_t b = static_cast<std::uint32_t>(v >> 32);
+      std::uint32_t e = static_cast<std::uint32_t>(v);
+      if (b >= e) {
+        return false;
+      }
+      if (slots[p].range.compare_exchange_weak(v, pack(b + 1, e),
+                                               std::memory_order_acq_rel)) {
+        chunk = b;
+        return true;
+      }
+    }
+  }
+  bool steal(unsigned int victim, std::uint32_t &b, std::uint32_t &e) {
+    std::uint64_t v = slots[victim].range.load(std::memory_order_relaxed);
+    while (true) {
+      std::uint32_t vb = static_cast<std::uint32_t>(v >> 32);
+      std::uint32_t ve = static_cast<std::uint32_t>(v);
+      if (vb >= ve) {
+        return false;
+      }
+      std::uint32_t mid = ve - (ve - vb + 1) / 2;
+      if (slots[victim].range.compare_exchange_weak(
+              v, pack(vb, mid), std::memory_order_acq_rel)) {
+        b = mid;
+        e = ve;
+        return true;
+      }
+    }
+  }
+  bool next(unsigned int p, std::size_t &chunk) {
+    if (pop(p, chunk)) {
+      return true;
+    }
+    for (unsigned int i = 1; i < nb; i++) {
+      std::uint32_t b, e;
+      if (steal((p + i) % nb, b, e)) {
+        // the own range is empty, thieves leave it alone
+        slots[p].range.store(pack(b + 1, e), std::memory_order_release);
+        chunk = b;
+        return true;
+      }
+    }
+    return false;
+  }
+  void participate(unsigned int p) {
+    std::size_t chunk;
+    while (next(p, chunk)) {
+      task(ctx, chunk, p);
+    }
+  }
+  void work(unsigned int p) {
+    active() = this;
+    std::uint64_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(m);
+        wake.wait(lock, [&]() { return stopping || generation != seen; });
+        if (stopping) {
+          return;
+        }
+        seen = generation;
+      }
+      participate(p);
+      finished.fetch_add(1, std::memory_order_release);
+    }
+  }
+
+public:
+  /** threads counts the calling thread, 0 is one per hardware thread*/
+  explicit Pool(unsigned int threads = 0)
+      : nb(threads != 0 ? threads
+                        : std::max(1u, std::thread::hardware_concurrency())),
+        slots(new Slot[nb]), generation(0), stopping(false), task(nullptr),
+        ctx(nullptr), finished(0) {
+    for (unsigned int p = 0; p < nb; p++) {
+      slots[p].range.store(0, std::memory_order_relaxed);
+    }
+    for (unsigned int p = 1; p < nb; p++) {
+      workers.push_back(std::thread(&Pool::work, this, p));
+    }
+  }
+  ~Pool() {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &w : workers) {
+      w.join();
+    }
+  }
+  Pool(const Pool &) = delete;
+  Pool &operator=(const Pool &) = delete;
+
+  /** number of participants, the calling thread included*/
+  unsigned int size() const { return nb; }
+
+  /** calls fn(chunk, participant) once for every chunk below nb_chunks
+   * and returns when all calls are done, participant is below size()*/
+  template <class Fn> void run(std::size_t nb_chunks, const Fn &fn) {
+    if (nb == 1 || nb_chunks <= 1 || active() == this) {
+      for (std::size_t c = 0; c < nb_chunks; c++) {
+        fn(c, 0u);
+      }
+      return;
+    }
+    std::lock_guard<std::mutex> job(running);
+    {
+      std::lock_guard<std::mutex> lock(m);
+      task = [](const void *f, std::size_t c, unsigned int p) {
+        (*static_cast<const Fn *>(f))(c, p);
+      };
+      ctx = &fn;
+      for (unsigned int p = 0; p < nb; p++) {
+        std::uint32_t b = static_cast<std::uint32_t>(nb_chunks * p / nb);
+        std::uint32_t e = static_cast<std::uint32_t>(nb_chunks * (p + 1) / nb);
+        slots[p].range.store(pack(b, e), std::memory_order_relaxed);
+      }
+      finished.store(0, std::memory_order_relaxed);
+      generation++;
+    }
+    wake.notify_all();
+    const Pool *outer = active();
+    active() = this;
+    participate(0);
+    active() = outer;
+    // workers may still run stolen chunks, and must not see the next job
+    // with this one's task
+    while (finished.load(std::memory_order_acquire) != nb - 1) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+/** pool with one participant per hardware thread*/
+inline Pool &default_pool() {
+  static Pool p;
+  return p;
+}
+
+/** tuning of a bulk call*/
+struct Options {
+  /** elements per chunk, 0 picks one from the size and the pool*/
+  std::size_t chunk;
+  /** reductions combine the chunks in index order, which with a fixed
+   * chunk gives the same result for any number of threads*/
+  bool deterministic;
+
+  Options() : chunk(0), deterministic(false) {}
+};
+
+inline std::size_t chunk_size(const Pool &p, std::size_t n,
+                              const Options &o) {
+  std::size_t c = o.chunk;
+  if (c == 0) {
+    // a deterministic split cannot depend on the number of threads
+    c = o.deterministic ? n / 1024 : n / (8 * p.size());
+    c = std::max<std::size_t>(c, 4096);
+  }
+  // chunk indices are 32 bits
+  return std::max<std::size_t>(c, n / 0xffffffffu + 1);
+}
+
+/** calls fn(begin, end) over chunks of [0, n)*/
+template <class Fn>
+void for_range(Pool &p, std::size_t n, const Fn &fn,
+               const Options &o = Options()) {
+  std::size_t c = chunk_size(p, n, o);
+  p.run((n + c - 1) / c, [&](std::size_t i, unsigned int) {
+    std::size_t b = i * c;
+    fn(b, std::min(n, b + c));
+  });
+}
+
+/** combine(init, map(begin, end)) over the chunks of [0, n), combine must
+ * be associative*/
+template <class T, class Map, class Combine>
+T reduce(Pool &p, std::size_t n, T init, const Map &map,
+         const Combine &combine, const Options &o = Options()) {
+  std::size_t c = chunk_size(p, n, o);
+  std::size_t nb_chunks = (n + c - 1) / c;
+  T acc = init;
+  if (o.deterministic) {
+    std::vector<T> parts(nb_chunks);
+    p.run(nb_chunks, [&](std::size_t i, unsigned int) {
+      std::size_t b = i * c;
+      parts[i] = map(b, std::min(n, b + c));
+    });
+    for (std::size_t i = 0; i < nb_chunks; i++) {
+      acc = combine(acc, parts[i]);
+    }
+    return acc;
+  }
+  struct alignas(64) Part {
+    T value;
+    bool used;
+  };
+  std::vector<Part> parts(p.size());
+  for (Part &part : parts) {
+    part.used = false;
+  }
+  p.run(nb_chunks, [&](std::size_t i, unsigned int w) {
+    std::size_t b = i * c;
+    T v = map(b, std::min(n, b + c));
+    parts[w].value = parts[w].used ? combine(parts[w].value, v) : v;
+    parts[w].used = true;
+  });
+  for (const Part &part : parts) {
+    if (part.used) {
+      acc = combine(acc, part.value);
+    }
+  }
+  return acc;
+}
+
+/** resizes a to n vectors and fills them from the pool threads, so on a
+ * NUMA system each page lands on the node of the thread that later works
+ * on it with the same pool and chunk size*/
+template <class T, unsigned int N>
+Result first_touch(Pool &p, VecNArray<T, N> &a, std::size_t n, T v,
+                   const Options &o = Options()) {
+  a.resize_for_overwrite(n);
+  T *l[N];
+  for (unsigned int k = 0; k < N; k++) {
+    a.lane(k, l[k]);
+  }
+  for_range(p, n, [&](std::size_t b, std::size_t e) {
+    for (unsigned int k = 0; k < N; k++) {
+      std::fill(l[k] + b, l[k] + e, v);
+    }
+  }, o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+
+/** runs kernel(a, b, o, len) over matching slices of every lane*/
+template <class T, unsigned int N, class Kernel>
+Result lanes_apply(Pool &p, const VecNArray<T, N> &a, const VecNArray<T, N> &v,
+                   VecNArray<T, N> &out, const Kernel &kernel,
+                   const Options &o) {
+  std::size_t n = 0, m = 0;
+  a.size(n);
+  v.size(m);
+  if (n != m) {
+    VEPP_PROBE_FAIL(SIZE_ERROR);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  std::size_t on = 0;
+  out.size(on);
+  if (on != n) {
+    out.resize_for_overwrite(n);
+  }
+  const T *la[N];
+  const T *lv[N];
+  T *lo[N];
+  for (unsigned int k = 0; k < N; k++) {
+    a.lane(k, la[k]);
+    v.lane(k, lv[k]);
+    out.lane(k, lo[k]);
+  }
+  for_range(p, n, [&](std::size_t b, std::size_t e) {
+    for (unsigned int k = 0; k < N; k++) {
+      kernel(la[k] + b, lv[k] + b, lo[k] + b, e - b);
+    }
+  }, o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+
+/** bulk element-wise operations, the parallel forms of the VecNArray ones*/
+template <class T, unsigned int N>
+Result add(Pool &p, const VecNArray<T, N> &a, const VecNArray<T, N> &v,
+           VecNArray<T, N> &out, const Options &o = Options()) {
+  Result res = lanes_apply(p, a, v, out,
+                           [](const T *x, const T *y, T *z, std::size_t len) {
+                             simd::add(x, y, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+template <class T, unsigned int N>
+Result add(Pool &p, const VecNArray<T, N> &a, T s, VecNArray<T, N> &out,
+           const Options &o = Options()) {
+  Result res = lanes_apply(p, a, a, out,
+                           [s](const T *x, const T *, T *z, std::size_t len) {
+                             simd::add(x, s, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+template <class T, unsigned int N>
+Result subtract(Pool &p, const VecNArray<T, N> &a, const VecNArray<T, N> &v,
+                VecNArray<T, N> &out, const Options &o = Options()) {
+  Result res = lanes_apply(p, a, v, out,
+                           [](const T *x, const T *y, T *z, std::size_t len) {
+                             simd::subtract(x, y, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+template <class T, unsigned int N>
+Result subtract(Pool &p, const VecNArray<T, N> &a, T s, VecNArray<T, N> &out,
+                const Options &o = Options()) {
+  Result res = lanes_apply(p, a, a, out,
+                           [s](const T *x, const T *, T *z, std::size_t len) {
+                             simd::subtract(x, s, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+template <class T, unsigned int N>
+Result multiply(Pool &p, const VecNArray<T, N> &a, const VecNArray<T, N> &v,
+                VecNArray<T, N> &out, const Options &o = Options()) {
+  Result res = lanes_apply(p, a, v, out,
+                           [](const T *x, const T *y, T *z, std::size_t len) {
+                             simd::multiply(x, y, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+template <class T, unsigned int N>
+Result multiply(Pool &p, const VecNArray<T, N> &a, T s, VecNArray<T, N> &out,
+                const Options &o = Options()) {
+  Result res = lanes_apply(p, a, a, out,
+                           [s](const T *x, const T *, T *z, std::size_t len) {
+                             simd::multiply(x, s, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+template <class T, unsigned int N>
+Result divide(Pool &p, const VecNArray<T, N> &a, const VecNArray<T, N> &v,
+              VecNArray<T, N> &out, const Options &o = Options()) {
+  std::size_t n = 0, m = 0;
+  a.size(m);
+  v.size(n);
+  if (n != m) {
+    VEPP_PROBE_FAIL(SIZE_ERROR);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  // one zero anywhere in the batch fails the whole batch
+  const T *lv[N];
+  for (unsigned int k = 0; k < N; k++) {
+    v.lane(k, lv[k]);
+  }
+  // char rather than bool, the deterministic reduce keeps a vector of T
+  char has_zero = reduce(p, n, static_cast<char>(0),
+                         [&](std::size_t b, std::size_t e) {
+                           char z = 0;
+                           for (unsigned int k = 0; k < N; k++) {
+                             for (std::size_t i = b; i < e; i++) {
+                               z |= lv[k][i] == static_cast<T>(0);
+                             }
+                           }
+                           return z;
+                         },
+                         [](char x, char y) {
+                           return static_cast<char>(x | y);
+                         },
+                         o);
+  if (has_zero) {
+    VEPP_PROBE_FAIL(ARG_ERROR);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+    return vflag;
+  }
+  Result res = lanes_apply(p, a, v, out,
+                           [](const T *x, const T *y, T *z, std::size_t len) {
+                             simd::divide(x, y, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+template <class T, unsigned int N>
+Result divide(Pool &p, const VecNArray<T, N> &a, T s, VecNArray<T, N> &out,
+              const Options &o = Options()) {
+  if (s == static_cast<T>(0)) {
+    VEPP_PROBE_FAIL(ARG_ERROR);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+    return vflag;
+  }
+  Result res = lanes_apply(p, a, a, out,
+                           [s](const T *x, const T *, T *z, std::size_t len) {
+                             simd::divide(x, s, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+
+/** fused updates: out = s * x + y and out = s * x + t * y, out may be y
+ * for an in place update*/
+template <class T, unsigned int N>
+Result axpy(Pool &p, T s, const VecNArray<T, N> &x, const VecNArray<T, N> &y,
+            VecNArray<T, N> &out, const Options &o = Options()) {
+  Result res = lanes_apply(p, x, y, out,
+                           [s](const T *a, const T *b, T *z, std::size_t len) {
+                             simd::axpy(s, a, b, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+template <class T, unsigned int N>
+Result axpby(Pool &p, T s, const VecNArray<T, N> &x, T t,
+             const VecNArray<T, N> &y, VecNArray<T, N> &out,
+             const Options &o = Options()) {
+  Result res = lanes_apply(p, x, y, out,
+                           [s, t](const T *a, const T *b, T *z,
+                                  std::size_t len) {
+                             simd::axpby(s, a, t, b, z, len);
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+/** out = a * b + c, element-wise*/
+template <class T, unsigned int N>
+Result fma(Pool &p, const VecNArray<T, N> &a, const VecNArray<T, N> &b,
+           const VecNArray<T, N> &c, VecNArray<T, N> &out,
+           const Options &o = Options()) {
+  std::size_t n = 0, nb = 0, nc = 0;
+  a.size(n);
+  b.size(nb);
+  c.size(nc);
+  if (nb != n || nc != n) {
+    VEPP_PROBE_FAIL(SIZE_ERROR);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  std::size_t on = 0;
+  out.size(on);
+  if (on != n) {
+    out.resize_for_overwrite(n);
+  }
+  const T *la[N];
+  const T *lb[N];
+  const T *lc[N];
+  T *lo[N];
+  for (unsigned int k = 0; k < N; k++) {
+    a.lane(k, la[k]);
+    b.lane(k, lb[k]);
+    c.lane(k, lc[k]);
+    out.lane(k, lo[k]);
+  }
+  for_range(p, n, [&](std::size_t s, std::size_t e) {
+    for (unsigned int k = 0; k < N; k++) {
+      simd::fma(la[k] + s, lb[k] + s, lc[k] + s, lo[k] + s, e - s);
+    }
+  }, o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+
+/** calls fn(x, y) on every pair of components, a user kernel*/
+template <class T, unsigned int N, class Fn>
+Result apply_el(Pool &p, const VecNArray<T, N> &a, const VecNArray<T, N> &v,
+                const Fn &fn, VecNArray<T, N> &out,
+                const Options &o = Options()) {
+  Result res = lanes_apply(p, a, v, out,
+                           [&fn](const T *x, const T *y, T *z,
+                                 std::size_t len) {
+                             for (std::size_t i = 0; i < len; i++) {
+                               z[i] = fn(x[i], y[i]);
+                             }
+                           },
+                           o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+
+/** sum of the dot products of the i-th vectors of both arrays*/
+template <class T, unsigned int N>
+Result dot(Pool &p, const VecNArray<T, N> &a, const VecNArray<T, N> &v,
+           T &out, const Options &o = Options()) {
+  std::size_t n = 0, m = 0;
+  a.size(n);
+  v.size(m);
+  if (n != m) {
+    VEPP_PROBE_FAIL(SIZE_ERROR);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  const T *la[N];
+  const T *lv[N];
+  for (unsigned int k = 0; k < N; k++) {
+    a.lane(k, la[k]);
+    v.lane(k, lv[k]);
+  }
+  out = reduce(p, n, static_cast<T>(0),
+               [&](std::size_t b, std::size_t e) {
+                 T acc = static_cast<T>(0);
+                 for (unsigned int k = 0; k < N; k++) {
+                   acc += simd::dot(la[k] + b, lv[k] + b, e - b);
+                 }
+                 return acc;
+               },
+               [](T x, T y) { return x + y; }, o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+
+/** same accumulated in Acc, ie double for float arrays or float for the
+ * 16 bit floats of vepp_half.hpp*/
+template <class T, unsigned int N, class Acc>
+Result dot(Pool &p, const VecNArray<T, N> &a, const VecNArray<T, N> &v,
+           Acc &out, const Options &o = Options()) {
+  std::size_t n = 0, m = 0;
+  a.size(n);
+  v.size(m);
+  if (n != m) {
+    VEPP_PROBE_FAIL(SIZE_ERROR);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  const T *la[N];
+  const T *lv[N];
+  for (unsigned int k = 0; k < N; k++) {
+    a.lane(k, la[k]);
+    v.lane(k, lv[k]);
+  }
+  out = reduce(p, n, static_cast<Acc>(0),
+               [&](std::size_t b, std::size_t e) {
+                 Acc acc = static_cast<Acc>(0);
+                 for (unsigned int k = 0; k < N; k++) {
+                   acc += simd::dot_acc<Acc>(la[k] + b, lv[k] + b, e - b);
+                 }
+                 return acc;
+               },
+               [](Acc x, Acc y) { return x + y; }, o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+
+/** out[i] is the length of the i-th vector*/
+template <class T, unsigned int N, class A>
+Result norms(Pool &p, const VecNArray<T, N> &a, std::vector<T, A> &out,
+             const Options &o = Options()) {
+  std::size_t n = 0;
+  a.size(n);
+  if (out.size() != n) {
+    out.resize(n);
+  }
+  const T *la[N];
+  for (unsigned int k = 0; k < N; k++) {
+    a.lane(k, la[k]);
+  }
+  T *d = out.data();
+  for_range(p, n, [&](std::size_t b, std::size_t e) {
+    for (std::size_t i = b; i < e; i++) {
+      T acc = static_cast<T>(0);
+      for (unsigned int k = 0; k < N; k++) {
+        acc += la[k][i] * la[k][i];
+      }
+      d[i] = static_cast<T>(std::sqrt(acc));
+    }
+  }, o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+
+/** component-wise minimum or maximum of all vectors, an empty array is a
+ * SIZE_ERROR*/
+template <class T, unsigned int N, class P, class S, class Pick>
+Result extremum(Pool &p, const VecNArray<T, N> &a, VecN<T, N, P, S> &out,
+                const Pick &pick, const Options &o) {
+  std::size_t n = 0;
+  a.size(n);
+  if (n == 0) {
+    VEPP_PROBE_FAIL(SIZE_ERROR);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  const T *la[N];
+  std::array<T, N> init;
+  for (unsigned int k = 0; k < N; k++) {
+    a.lane(k, la[k]);
+    init[k] = la[k][0];
+  }
+  std::array<T, N> r = reduce(
+      p, n, init,
+      [&](std::size_t b, std::size_t e) {
+        std::array<T, N> m;
+        for (unsigned int k = 0; k < N; k++) {
+          T v = la[k][b];
+          for (std::size_t i = b + 1; i < e; i++) {
+            v = pick(v, la[k][i]);
+          }
+          m[k] = v;
+        }
+        return m;
+      },
+      [&](const std::array<T, N> &x, const std::array<T, N> &y) {
+        std::array<T, N> m;
+        for (unsigned int k = 0; k < N; k++) {
+          m[k] = pick(x[k], y[k]);
+        }
+        return m;
+      },
+      o);
+  out = VecN<T, N, P, S>(r);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+template <class T, unsigned int N, class P, class S>
+Result min(Pool &p, const VecNArray<T, N> &a, VecN<T, N, P, S> &out,
+           const Options &o = Options()) {
+  Result res = extremum(p, a, out, [](T x, T y) { return y < x ? y : x; }, o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+template <class T, unsigned int N, class P, class S>
+Result max(Pool &p, const VecNArray<T, N> &a, VecN<T, N, P, S> &out,
+           const Options &o = Options()) {
+  Result res = extremum(p, a, out, [](T x, T y) { return x < y ? y : x; }, o);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, res.status);
+  return vflag;
+}
+
+} // namespace parallel
+} // namespace vepp
+
+#endif
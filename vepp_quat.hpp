@@ -0,0 +1,371 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_QUAT_HPP
+#define VEPP_QUAT_HPP
+#include "vepp.hpp"
+#include "vepp_array.hpp"
+#include "vepp_mat.hpp"
+#include <cmath>
+#include <cstddef>
+
+namespace vepp {
+
+/** Quaternion w + x i + y j + z k
+
+  The components are kept in a VecN<T, 4> in x, y, z, w order, the same
+  order as the lanes of a VecNArray<T, 4> holding a batch of them for the
+  functions of the quat namespace below. Rotations expect a unit
+  quaternion. As with VecN the result goes to an output argument, which
+  may be an operand, and a Result is returned.
+ */
+template <class T, class Policy = CheckedPolicy> class Quat {
+  /** x, y, z, w*/
+  VecN<T, 4, Policy> q;
+
+  /** the vector part as a VecN*/
+  template <class P, class S> VecN<T, 3, P, S> axis() const {
+    return VecN<T, 3, P, S>(std::array<T, 3>{x(), y(), z()});
+  }
+
+public:
+  typedef T value_type;
+
+  /*! Tested */
+  Quat() {}
+  /*! Tested */
+  VEPP_CONSTEXPR Quat(T x, T y, T z, T w)
+      : q(std::array<T, 4>{x, y, z, w}) {}
+  /*! Tested */
+  template <class P, class S>
+  explicit VEPP_CONSTEXPR Quat(const VecN<T, 4, P, S> &v) : q(v) {}
+  /*! Tested */
+  static VEPP_CONSTEXPR Quat<T, Policy> identity() {
+    return Quat<T, Policy>(static_cast<T>(0), static_cast<T>(0),
+                           static_cast<T>(0), static_cast<T>(1));
+  }
+  /*! Tested */
+  /** rotation of angle radians around axis, a zero axis is an ARG_ERROR*/
+  template <class P, class S>
+  static Result from_axis_angle(const VecN<T, 3, P, S> &axis, T angle,
+                                Quat<T, Policy> &out) {
+    VecN<T, 3, P, S> u;
+    if (axis.normalize(u).status != SUCCESS) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    const T half = angle / static_cast<T>(2);
+    const T s = static_cast<T>(std::sin(half));
+    out = Quat<T, Policy>(u.eval(0) * s, u.eval(1) * s, u.eval(2) * s,
+                          static_cast<T>(std::cos(half)));
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+
+  VEPP_CONSTEXPR T x() const { return q.eval(0); }
+  VEPP_CONSTEXPR T y() const { return q.eval(1); }
+  VEPP_CONSTEXPR T z() const { return q.eval(2); }
+  VEPP_CONSTEXPR T w() const { return q.eval(3); }
+  /** the x, y, z, w components*/
+  VEPP_CONSTEXPR const VecN<T, 4, Policy> &coeffs() const { return q; }
+
+  /*! Tested */
+  /** Hamilton product, out = this * b*/
+  VEPP_CONSTEXPR Result multiply(const Quat<T, Policy> &b,
+                                 Quat<T, Policy> &out) const {
+    const T ax = x(), ay = y(), az = z(), aw = w();
+    const T bx = b.x(), by = b.y(), bz = b.z(), bw = b.w();
+    out = Quat<T, Policy>(aw * bx + ax * bw + (ay * bz - az * by),
+                          aw * by + ay * bw + (az * bx - ax * bz),
+                          aw * bz + az * bw + (ax * by - ay * bx),
+                          aw * bw - (ax * bx + ay * by + az * bz));
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  VEPP_CONSTEXPR Result conjugate(Quat<T, Policy> &out) const {
+    out = Quat<T, Policy>(-x(), -y(), -z(), w());
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** conjugate over the squared norm, a zero quaternion is an ARG_ERROR*/
+  Result inverse(Quat<T, Policy> &out) const {
+    T sq = static_cast<T>(0);
+    q.dot(q, sq);
+    if (policy_fails<Policy>(sq != static_cast<T>(0), ARG_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    const T inv = static_cast<T>(1) / sq;
+    out = Quat<T, Policy>(-x() * inv, -y() * inv, -z() * inv, w() * inv);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  VEPP_CONSTEXPR Result dot(const Quat<T, Policy> &b, T &out) const {
+    return q.dot(b.q, out);
+  }
+  /*! Tested */
+  Result length(T &out) const { return q.length(out); }
+  /*! Tested */
+  /** unit quaternion, a zero quaternion is an ARG_ERROR*/
+  Result normalize(Quat<T, Policy> &out) const { return q.normalize(out.q); }
+  /*! Tested */
+  /** rotates v by this unit quaternion, v + w t + xyz x t with
+   * t = 2 xyz x v*/
+  template <class P, class S>
+  Result rotate(const VecN<T, 3, P, S> &v, VecN<T, 3, P, S> &out) const {
+    const VecN<T, 3, P, S> u = axis<P, S>();
+    VecN<T, 3, P, S> t, c;
+    u.cross(v, t);
+    t.multiply_inplace(static_cast<T>(2));
+    u.cross(t, c);
+    out = v + t * w() + c;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** rotates a whole batch by this unit quaternion through its rotation
+   * matrix, 9 multiply-adds per vector, out may be in*/
+  Result rotate(const VecNArray<T, 3> &in, VecNArray<T, 3> &out) const {
+    MatNM<T, 3, 3, Policy> m;
+    to_matrix(m);
+    return m.multiply(in, out);
+  }
+  /*! Tested */
+  /** rotation matrix of this unit quaternion*/
+  VEPP_CONSTEXPR Result to_matrix(MatNM<T, 3, 3, Policy> &out) const {
+    const T one = static_cast<T>(1), two = static_cast<T>(2);
+    const T xx = x() * x(), yy = y() * y(), zz = z() * z();
+    const T xy = x() * y(), xz = x() * z(), yz = y() * z();
+    const T wx = w() * x(), wy = w() * y(), wz = w() * z();
+    out = MatNM<T, 3, 3, Policy>(std::array<T, 9>{
+        one - two * (yy + zz), two * (xy - wz), two * (xz + wy),
+        two * (xy + wz), one - two * (xx + zz), two * (yz - wx),
+        two * (xz - wy), two * (yz + wx), one - two * (xx + yy)});
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  /** normalized linear interpolation from this to b at t in [0, 1], along
+   * the shorter arc*/
+  Result nlerp(const Quat<T, Policy> &b, T t, Quat<T, Policy> &out) const {
+    T d = static_cast<T>(0);
+    q.dot(b.q, d);
+    const T wb = d < static_cast<T>(0) ? -t : t;
+    Quat<T, Policy> r;
+    r.q = q * (static_cast<T>(1) - t) + b.q * wb;
+    return r.normalize(out);
+  }
+  /*! Tested */
+  /** spherical linear interpolation from this to b at t in [0, 1], along
+   * the shorter arc. Nearly parallel inputs fall back to nlerp, where
+   * sin(theta) would lose every digit*/
+  Result slerp(const Quat<T, Policy> &b, T t, Quat<T, Policy> &out) const {
+    T d = static_cast<T>(0);
+    q.dot(b.q, d);
+    const T sign = d < static_cast<T>(0) ? static_cast<T>(-1)
+                                         : static_cast<T>(1);
+    d *= sign;
+    if (d > static_cast<T>(0.9995)) {
+      return nlerp(b, t, out);
+    }
+    const T theta = static_cast<T>(std::acos(d));
+    const T inv = static_cast<T>(1) / static_cast<T>(std::sin(theta));
+    const T wa = static_cast<T>(std::sin((1 - t) * theta)) * inv;
+    const T wb = static_cast<T>(std::sin(t * theta)) * inv * sign;
+    out.q = q * wa + b.q * wb;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+};
+
+/** Quat aliases for each error policy*/
+template <class T> using QuatChecked = Quat<T, CheckedPolicy>;
+template <class T> using QuatThrow = Quat<T, ThrowPolicy>;
+template <class T> using QuatAssert = Quat<T, AssertPolicy>;
+template <class T> using QuatUnchecked = Quat<T, UncheckedPolicy>;
+
+/** Batched quaternion operations
+
+  A batch of quaternions is a VecNArray<T, 4> with the x, y, z, w lanes.
+  Every function works element by element on arrays of the same size,
+  reports SIZE_ERROR otherwise, and its output may be one of the inputs.
+  multiply and rotate run the SIMD kernels of vepp_simd.hpp.
+ */
+namespace quat {
+
+/*! Tested */
+/** Hamilton products out[i] = a[i] * b[i]*/
+template <class T>
+Result multiply(const VecNArray<T, 4> &a, const VecNArray<T, 4> &b,
+                VecNArray<T, 4> &out) {
+  std::size_t n = 0, nb = 0;
+  a.size(n);
+  b.size(nb);
+  if (n != nb) {
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  const T *pa[4], *pb[4];
+  for (unsigned int k = 0; k < 4; k++) {
+    a.lane(k, pa[k]);
+    b.lane(k, pb[k]);
+  }
+  out.resize_for_overwrite(n);
+  T *po[4];
+  for (unsigned int k = 0; k < 4; k++) {
+    out.lane(k, po[k]);
+  }
+  simd::quat_multiply(pa, pb, po, n);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+/*! Tested */
+/** rotates v[i] by the unit quaternion q[i]*/
+template <class T>
+Result rotate(const VecNArray<T, 4> &q, const VecNArray<T, 3> &v,
+              VecNArray<T, 3> &out) {
+  std::size_t n = 0, nv = 0;
+  q.size(n);
+  v.size(nv);
+  if (n != nv) {
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  const T *pq[4], *pv[3];
+  for (unsigned int k = 0; k < 4; k++) {
+    q.lane(k, pq[k]);
+  }
+  for (unsigned int k = 0; k < 3; k++) {
+    v.lane(k, pv[k]);
+  }
+  out.resize_for_overwrite(n);
+  T *po[3];
+  for (unsigned int k = 0; k < 3; k++) {
+    out.lane(k, po[k]);
+  }
+  simd::quat_rotate(pq, pv, po, n);
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+/*! Tested */
+/** nlerp from a[i] to b[i] at t, along the shorter arc. Zero results are
+ * left unnormalized*/
+template <class T>
+Result nlerp(const VecNArray<T, 4> &a, const VecNArray<T, 4> &b, T t,
+             VecNArray<T, 4> &out) {
+  std::size_t n = 0, nb = 0;
+  a.size(n);
+  b.size(nb);
+  if (n != nb) {
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  const T *pa[4], *pb[4];
+  for (unsigned int k = 0; k < 4; k++) {
+    a.lane(k, pa[k]);
+    b.lane(k, pb[k]);
+  }
+  out.resize_for_overwrite(n);
+  T *po[4];
+  for (unsigned int k = 0; k < 4; k++) {
+    out.lane(k, po[k]);
+  }
+  const T s = static_cast<T>(1) - t;
+  for (std::size_t i = 0; i < n; i++) {
+    T d = static_cast<T>(0);
+    for (unsigned int k = 0; k < 4; k++) {
+      d += pa[k][i] * pb[k][i];
+    }
+    const T wb = d < static_cast<T>(0) ? -t : t;
+    T r[4];
+    T sq = static_cast<T>(0);
+    for (unsigned int k = 0; k < 4; k++) {
+      r[k] = s * pa[k][i] + wb * pb[k][i];
+      sq += r[k] * r[k];
+    }
+    const T inv = sq > static_cast<T>(0)
+                      ? static_cast<T>(1) / static_cast<T>(std::sqrt(sq))
+                      : static_cast<T>(1);
+    for (unsigned int k = 0; k < 4; k++) {
+      po[k][i] = r[k] * inv;
+    }
+  }
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+/*! Tested */
+/** slerp from a[i] to b[i] at t, element by element as Quat::slerp*/
+template <class T>
+Result slerp(const VecNArray<T, 4> &a, const VecNArray<T, 4> &b, T t,
+             VecNArray<T, 4> &out) {
+  std::size_t n = 0, nb = 0;
+  a.size(n);
+  b.size(nb);
+  if (n != nb) {
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+    return vflag;
+  }
+  const T *pa[4], *pb[4];
+  for (unsigned int k = 0; k < 4; k++) {
+    a.lane(k, pa[k]);
+    b.lane(k, pb[k]);
+  }
+  out.resize_for_overwrite(n);
+  T *po[4];
+  for (unsigned int k = 0; k < 4; k++) {
+    out.lane(k, po[k]);
+  }
+  for (std::size_t i = 0; i < n; i++) {
+    Quat<T, UncheckedPolicy> qa(pa[0][i], pa[1][i], pa[2][i], pa[3][i]);
+    Quat<T, UncheckedPolicy> qb(pb[0][i], pb[1][i], pb[2][i], pb[3][i]);
+    qa.slerp(qb, t, qa);
+    po[0][i] = qa.x();
+    po[1][i] = qa.y();
+    po[2][i] = qa.z();
+    po[3][i] = qa.w();
+  }
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+  return vflag;
+}
+
+} // namespace quat
+
+} // namespace vepp
+
+#endif
@@ -0,0 +1,1163 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_SIMD_HPP
+#define VEPP_SIMD_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if !defined(VEPP_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64)) &&     \
+    (defined(__GNUC__) || defined(__clang__))
+#define VEPP_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define VEPP_SIMD_X86 0
+#endif
+
+/** SIMD backend
+
+  Two kinds of kernels live here:
+
+  - bulk kernels over contiguous arrays (add, subtract, multiply, divide,
+    their scalar forms, dot, the fused fma, axpy and axpby, and the
+    batched quaternion products and rotations) for float, double and
+    int32_t. Each is compiled for SSE2, AVX2 and AVX-512 and the widest
+    one the CPU supports is chosen at runtime.
+  - fixed size dot products for VecN, using the baseline instruction set
+    with the last lanes padded with zeros when N is not a multiple of
+    the register width.
+
+  Every other type, and every platform other than x86-64 with GCC or
+  Clang, goes through the portable scalar loops. Defining VEPP_NO_SIMD
+  forces the scalar path everywhere.
+ */
+namespace vepp {
+namespace simd {
+
+enum isa_t : std::uint8_t {
+  ISA_SCALAR = 0,
+  ISA_SSE2 = 1,
+  ISA_AVX2 = 2,
+  ISA_AVX512 = 3
+};
+
+inline const char *isa_name(isa_t isa) {
+  switch (isa) {
+  case ISA_SCALAR:
+    return "scalar";
+  case ISA_SSE2:
+    return "sse2";
+  case ISA_AVX2:
+    return "avx2";
+  case ISA_AVX512:
+    return "avx512";
+  }
+  return "unknown";
+}
+
+/** widest instruction set supported by the CPU*/
+inline isa_t detect_isa() {
+#if VEPP_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return ISA_AVX512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return ISA_AVX2;
+  return ISA_SSE2;
+#else
+  return ISA_SCALAR;
+#endif
+}
+
+inline std::atomic<int> &isa_slot() {
+  static std::atomic<int> slot(static_cast<int>(detect_isa()));
+  return slot;
+}
+
+/** instruction set used by the bulk kernels*/
+inline isa_t active_isa() {
+  return static_cast<isa_t>(isa_slot().load(std::memory_order_relaxed));
+}
+
+/** selects the instruction set of the bulk kernels, requests above what
+ * the CPU supports are clamped, returns the selected one*/
+inline isa_t set_isa(isa_t isa) {
+  isa_t best = detect_isa();
+  if (isa > best)
+    isa = best;
+  isa_slot().store(static_cast<int>(isa), std::memory_order_relaxed);
+  return isa;
+}
+
+/** element-wise operation tags*/
+struct add_tag {};
+struct subtract_tag {};
+struct multiply_tag {};
+struct divide_tag {};
+
+template <class T> T scalar_apply(add_tag, T a, T b) { return a + b; }
+template <class T> T scalar_apply(subtract_tag, T a, T b) { return a - b; }
+template <class T> T scalar_apply(multiply_tag, T a, T b) { return a * b; }
+template <class T> T scalar_apply(divide_tag, T a, T b) { return a / b; }
+
+/** portable kernels, also the reference the SIMD ones are tested against*/
+namespace scalar {
+template <class T, class Op>
+void binary(const T *a, const T *b, T *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = scalar_apply(Op(), a[i], b[i]);
+  }
+}
+template <class T, class Op>
+void binary_scalar(const T *a, T s, T *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = scalar_apply(Op(), a[i], s);
+  }
+}
+template <class T> T dot(const T *a, const T *b, std::size_t n) {
+  T out = static_cast<T>(0);
+  for (std::size_t i = 0; i < n; i++) {
+    out += a[i] * b[i];
+  }
+  return out;
+}
+template <class T>
+void fused(const T *a, const T *b, const T *c, T *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = a[i] * b[i] + c[i];
+  }
+}
+template <class T>
+void axpy(T s, const T *x, const T *y, T *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = s * x[i] + y[i];
+  }
+}
+template <class T>
+void axpby(T s, const T *x, T t, const T *y, T *out, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = s * x[i] + t * y[i];
+  }
+}
+template <class T>
+void transform(const T *m, unsigned int rows, unsigned int cols,
+               const T *const *in, T *const *out, std::size_t n) {
+  for (unsigned int r = 0; r < rows; r++) {
+    const T *mr = m + r * cols;
+    for (std::size_t i = 0; i < n; i++) {
+      T acc = static_cast<T>(0);
+      for (unsigned int k = 0; k < cols; k++) {
+        acc += mr[k] * in[k][i];
+      }
+      out[r][i] = acc;
+    }
+  }
+}
+/** Hamilton product of quaternion i of the x, y, z, w lanes a and b*/
+template <class T>
+void quat_multiply_one(const T *const *a, const T *const *b, T *const *out,
+                       std::size_t i) {
+  const T ax = a[0][i], ay = a[1][i], az = a[2][i], aw = a[3][i];
+  const T bx = b[0][i], by = b[1][i], bz = b[2][i], bw = b[3][i];
+  out[0][i] = aw * bx + ax * bw + (ay * bz - az * by);
+  out[1][i] = aw * by + ay * bw + (az * bx - ax * bz);
+  out[2][i] = aw * bz + az * bw + (ax * by - ay * bx);
+  out[3][i] = aw * bw - (ax * bx + ay * by + az * bz);
+}
+/** rotates vector i of the lanes v by the unit quaternion i of q, as
+ * v + w t + q.xyz x t with t = 2 q.xyz x v*/
+template <class T>
+void quat_rotate_one(const T *const *q, const T *const *v, T *const *out,
+                     std::size_t i) {
+  const T qx = q[0][i], qy = q[1][i], qz = q[2][i], qw = q[3][i];
+  const T vx = v[0][i], vy = v[1][i], vz = v[2][i];
+  const T tx = 2 * (qy * vz - qz * vy);
+  const T ty = 2 * (qz * vx - qx * vz);
+  const T tz = 2 * (qx * vy - qy * vx);
+  out[0][i] = vx + qw * tx + (qy * tz - qz * ty);
+  out[1][i] = vy + qw * ty + (qz * tx - qx * tz);
+  out[2][i] = vz + qw * tz + (qx * ty - qy * tx);
+}
+template <class T>
+void quat_multiply(const T *const *a, const T *const *b, T *const *out,
+                   std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    quat_multiply_one(a, b, out, i);
+  }
+}
+template <class T>
+void quat_rotate(const T *const *q, const T *const *v, T *const *out,
+                 std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) {
+    quat_rotate_one(q, v, out, i);
+  }
+}
+} // namespace scalar
+
+/** table of bulk kernels for one type and instruction set*/
+template <class T> struct Kernels {
+  void (*add)(const T *, const T *, T *, std::size_t);
+  void (*subtract)(const T *, const T *, T *, std::size_t);
+  void (*multiply)(const T *, const T *, T *, std::size_t);
+  void (*divide)(const T *, const T *, T *, std::size_t);
+  void (*add_scalar)(const T *, T, T *, std::size_t);
+  void (*subtract_scalar)(const T *, T, T *, std::size_t);
+  void (*multiply_scalar)(const T *, T, T *, std::size_t);
+  void (*divide_scalar)(const T *, T, T *, std::size_t);
+  T (*dot)(const T *, const T *, std::size_t);
+  void (*fma)(const T *, const T *, const T *, T *, std::size_t);
+  void (*axpy)(T, const T *, const T *, T *, std::size_t);
+  void (*axpby)(T, const T *, T, const T *, T *, std::size_t);
+  void (*transform)(const T *, unsigned int, unsigned int, const T *const *,
+                    T *const *, std::size_t);
+  void (*quat_multiply)(const T *const *, const T *const *, T *const *,
+                        std::size_t);
+  void (*quat_rotate)(const T *const *, const T *const *, T *const *,
+                      std::size_t);
+};
+
+template <class T> Kernels<T> scalar_kernels() {
+  Kernels<T> k;
+  k.add = scalar::binary<T, add_tag>;
+  k.subtract = scalar::binary<T, subtract_tag>;
+  k.multiply = scalar::binary<T, multiply_tag>;
+  k.divide = scalar::binary<T, divide_tag>;
+  k.add_scalar = scalar::binary_scalar<T, add_tag>;
+  k.subtract_scalar = scalar::binary_scalar<T, subtract_tag>;
+  k.multiply_scalar = scalar::binary_scalar<T, multiply_tag>;
+  k.divide_scalar = scalar::binary_scalar<T, divide_tag>;
+  k.dot = scalar::dot<T>;
+  k.fma = scalar::fused<T>;
+  k.axpy = scalar::axpy<T>;
+  k.axpby = scalar::axpby<T>;
+  k.transform = scalar::transform<T>;
+  k.quat_multiply = scalar::quat_multiply<T>;
+  k.quat_rotate = scalar::quat_rotate<T>;
+  return k;
+}
+
+#if VEPP_SIMD_X86
+
+/** Kernels shared by every instruction set. V is a register traits type
+ * giving load, store, set1, zero, apply(tag, a, b), fmadd and hsum over
+ * width lanes. The macro is expanded once per instruction set so the
+ * kernels get compiled with the matching target options.*/
+#define VEPP_SIMD_GENERIC_KERNELS                                              \
+  template <class V, class Op>                                                 \
+  void binary(const typename V::scalar *a, const typename V::scalar *b,        \
+              typename V::scalar *out, std::size_t n) {                        \
+    std::size_t i = 0;                                                         \
+    for (; i + V::width <= n; i += V::width) {                                 \
+      V::store(out + i, V::apply(Op(), V::load(a + i), V::load(b + i)));       \
+    }                                                                          \
+    for (; i < n; i++) {                                                       \
+      out[i] = scalar_apply(Op(), a[i], b[i]);                                 \
+    }                                                                          \
+  }                                                                            \
+  template <class V, class Op>                                                 \
+  void binary_scalar(const typename V::scalar *a, typename V::scalar s,        \
+                     typename V::scalar *out, std::size_t n) {                 \
+    typename V::reg vs = V::set1(s);                                           \
+    std::size_t i = 0;                                                         \
+    for (; i + V::width <= n; i += V::width) {                                 \
+      V::store(out + i, V::apply(Op(), V::load(a + i), vs));                   \
+    }                                                                          \
+    for (; i < n; i++) {                                                       \
+      out[i] = scalar_apply(Op(), a[i], s);                                    \
+    }                                                                          \
+  }                                                                            \
+  template <class V>                                                           \
+  typename V::scalar dot(const typename V::scalar *a,                          \
+                         const typename V::scalar *b, std::size_t n) {         \
+    /* four accumulators hide the latency of the multiply-add chain */        \
+    typename V::reg acc0 = V::zero(), acc1 = V::zero(), acc2 = V::zero(),      \
+                    acc3 = V::zero();                                          \
+    std::size_t i = 0;                                                         \
+    for (; i + 4 * V::width <= n; i += 4 * V::width) {                         \
+      acc0 = V::fmadd(V::load(a + i), V::load(b + i), acc0);                   \
+      acc1 = V::fmadd(V::load(a + i + V::width), V::load(b + i + V::width),    \
+                      acc1);                                                   \
+      acc2 = V::fmadd(V::load(a + i + 2 * V::width),                           \
+                      V::load(b + i + 2 * V::width), acc2);                    \
+      acc3 = V::fmadd(V::load(a + i + 3 * V::width),                           \
+                      V::load(b + i + 3 * V::width), acc3);                    \
+    }                                                                          \
+    for (; i + V::width <= n; i += V::width) {                                 \
+      acc0 = V::fmadd(V::load(a + i), V::load(b + i), acc0);                   \
+    }                                                                          \
+    acc0 = V::apply(add_tag(), V::apply(add_tag(), acc0, acc1),                \
+                    V::apply(add_tag(), acc2, acc3));                          \
+    typename V::scalar out = V::hsum(acc0);                                    \
+    for (; i < n; i++) {                                                       \
+      out += a[i] * b[i];                                                      \
+    }                                                                          \
+    return out;                                                                \
+  }                                                                            \
+  template <class V>                                                           \
+  void fused(const typename V::scalar *a, const typename V::scalar *b,         \
+             const typename V::scalar *c, typename V::scalar *out,             \
+             std::size_t n) {                                                  \
+    std::size_t i = 0;                                                         \
+    for (; i + V::width <= n; i += V::width) {                                 \
+      V::store(out + i,                                                        \
+               V::fmadd(V::load(a + i), V::load(b + i), V::load(c + i)));      \
+    }                                                                          \
+    for (; i < n; i++) {                                                       \
+      out[i] = a[i] * b[i] + c[i];                                             \
+    }                                                                          \
+  }                                                                            \
+  template <class V>                                                           \
+  void axpy(typename V::scalar s, const typename V::scalar *x,                 \
+            const typename V::scalar *y, typename V::scalar *out,              \
+            std::size_t n) {                                                   \
+    typename V::reg vs = V::set1(s);                                           \
+    std::size_t i = 0;                                                         \
+    for (; i + V::width <= n; i += V::width) {                                 \
+      V::store(out + i, V::fmadd(vs, V::load(x + i), V::load(y + i)));         \
+    }                                                                          \
+    for (; i < n; i++) {                                                       \
+      out[i] = s * x[i] + y[i];                                                \
+    }                                                                          \
+  }                                                                            \
+  template <class V>                                                           \
+  void axpby(typename V::scalar s, const typename V::scalar *x,                \
+             typename V::scalar t, const typename V::scalar *y,                \
+             typename V::scalar *out, std::size_t n) {                         \
+    typename V::reg vs = V::set1(s), vt = V::set1(t);                          \
+    std::size_t i = 0;                                                         \
+    for (; i + V::width <= n; i += V::width) {                                 \
+      V::store(out + i,                                                        \
+               V::fmadd(vs, V::load(x + i),                                    \
+                        V::apply(multiply_tag(), vt, V::load(y + i))));        \
+    }                                                                          \
+    for (; i < n; i++) {                                                       \
+      out[i] = s * x[i] + t * y[i];                                            \
+    }                                                                          \
+  }                                                                            \
+  template <class V>                                                           \
+  void transform(const typename V::scalar *m, unsigned int rows,               \
+                 unsigned int cols, const typename V::scalar *const *in,       \
+                 typename V::scalar *const *out, std::size_t n) {              \
+    typedef typename V::scalar S;                                              \
+    /* every row is computed while a block of the input lanes is in L1 */     \
+    std::size_t i = 0;                                                         \
+    for (; i + V::width <= n; i += V::width) {                                 \
+      for (unsigned int r = 0; r < rows; r++) {                                \
+        const S *mr = m + r * cols;                                            \
+        typename V::reg acc = V::zero();                                       \
+        for (unsigned int k = 0; k < cols; k++) {                              \
+          acc = V::fmadd(V::set1(mr[k]), V::load(in[k] + i), acc);             \
+        }                                                                      \
+        V::store(out[r] + i, acc);                                             \
+      }                                                                        \
+    }                                                                          \
+    for (; i < n; i++) {                                                       \
+      for (unsigned int r = 0; r < rows; r++) {                                \
+        S acc = static_cast<S>(0);                                             \
+        for (unsigned int k = 0; k < cols; k++) {                              \
+          acc += m[r * cols + k] * in[k][i];                                   \
+        }                                                                      \
+        out[r][i] = acc;                                                       \
+      }                                                                        \
+    }                                                                          \
+  }                                                                            \
+  /* a * b - c * d, the cross product terms */                                 \
+  template <class V>                                                           \
+  typename V::reg cross_term(typename V::reg a, typename V::reg b,             \
+                             typename V::reg c, typename V::reg d) {           \
+    return V::apply(subtract_tag(), V::apply(multiply_tag(), a, b),            \
+                    V::apply(multiply_tag(), c, d));                           \
+  }                                                                            \
+  template <class V>                                                           \
+  void quat_multiply(const typename V::scalar *const *a,                       \
+                     const typename V::scalar *const *b,                       \
+                     typename V::scalar *const *out, std::size_t n) {          \
+    typedef typename V::reg R;                                                 \
+    std::size_t i = 0;                                                         \
+    for (; i + V::width <= n; i += V::width) {                                 \
+      const R ax = V::load(a[0] + i), ay = V::load(a[1] + i),                  \
+              az = V::load(a[2] + i), aw = V::load(a[3] + i);                  \
+      const R bx = V::load(b[0] + i), by = V::load(b[1] + i),                  \
+              bz = V::load(b[2] + i), bw = V::load(b[3] + i);                  \
+      const R x = V::fmadd(aw, bx,                                             \
+                            V::fmadd(ax, bw, cross_term<V>(ay, bz, az, by)));  \
+      const R y = V::fmadd(aw, by,                                             \
+                            V::fmadd(ay, bw, cross_term<V>(az, bx, ax, bz)));  \
+      const R z = V::fmadd(aw, bz,                                             \
+                            V::fmadd(az, bw, cross_term<V>(ax, by, ay, bx)));  \
+      const R w = V::apply(subtract_tag(), V::apply(multiply_tag(), aw, bw),   \
+                           V::fmadd(ax, bx, V::fmadd(ay, by,                   \
+                                    V::apply(multiply_tag(), az, bz))));       \
+      V::store(out[0] + i, x);                                                 \
+      V::store(out[1] + i, y);                                                 \
+      V::store(out[2] + i, z);                                                 \
+      V::store(out[3] + i, w);                                                 \
+    }                                                                          \
+    for (; i < n; i++) {                                                       \
+      scalar::quat_multiply_one(a, b, out, i);                                 \
+    }                                                                          \
+  }                                                                            \
+  template <class V>                                                           \
+  void quat_rotate(const typename V::scalar *const *q,                         \
+                   const typename V::scalar *const *v,                         \
+                   typename V::scalar *const *out, std::size_t n) {            \
+    typedef typename V::reg R;                                                 \
+    const R two = V::set1(static_cast<typename V::scalar>(2));                 \
+    std::size_t i = 0;                                                         \
+    for (; i + V::width <= n; i += V::width) {                                 \
+      const R qx = V::load(q[0] + i), qy = V::load(q[1] + i),                  \
+              qz = V::load(q[2] + i), qw = V::load(q[3] + i);                  \
+      const R vx = V::load(v[0] + i), vy = V::load(v[1] + i),                  \
+              vz = V::load(v[2] + i);                                          \
+      /* t = 2 q.xyz x v, out = v + w t + q.xyz x t */                         \
+      const R tx =                                                             \
+          V::apply(multiply_tag(), two, cross_term<V>(qy, vz, qz, vy));        \
+      const R ty =                                                             \
+          V::apply(multiply_tag(), two, cross_term<V>(qz, vx, qx, vz));        \
+      const R tz =                                                             \
+          V::apply(multiply_tag(), two, cross_term<V>(qx, vy, qy, vx));        \
+      V::store(out[0] + i, V::apply(add_tag(), V::fmadd(qw, tx, vx),           \
+                                    cross_term<V>(qy, tz, qz, ty)));           \
+      V::store(out[1] + i, V::apply(add_tag(), V::fmadd(qw, ty, vy),           \
+                                    cross_term<V>(qz, tx, qx, tz)));           \
+      V::store(out[2] + i, V::apply(add_tag(), V::fmadd(qw, tz, vz),           \
+                                    cross_term<V>(qx, ty, qy, tx)));           \
+    }                                                                          \
+    for (; i < n; i++) {                                                       \
+      scalar::quat_rotate_one(q, v, out, i);                                   \
+    }                                                                          \
+  }                                                                            \
+  template <class V> Kernels<typename V::scalar> make_kernels() {              \
+    typedef typename V::scalar S;                                              \
+    Kernels<S> k;                                                              \
+    k.add = binary<V, add_tag>;                                                \
+    k.subtract = binary<V, subtract_tag>;                                      \
+    k.multiply = binary<V, multiply_tag>;                                      \
+    k.divide = binary<V, divide_tag>;                                          \
+    k.add_scalar = binary_scalar<V, add_tag>;                                  \
+    k.subtract_scalar = binary_scalar<V, subtract_tag>;                        \
+    k.multiply_scalar = binary_scalar<V, multiply_tag>;                        \
+    k.divide_scalar = binary_scalar<V, divide_tag>;                            \
+    k.dot = dot<V>;                                                            \
+    k.fma = fused<V>;                                                          \
+    k.axpy = axpy<V>;                                                          \
+    k.axpby = axpby<V>;                                                        \
+    k.transform = transform<V>;                                                \
+    k.quat_multiply = quat_multiply<V>;                                        \
+    k.quat_rotate = quat_rotate<V>;                                            \
+    return k;                                                                  \
+  }
+
+/** SSE2 is the x86-64 baseline, no target options needed*/
+namespace sse2 {
+
+/** 32 bit multiplication, SSE2 has no pmulld*/
+inline __m128i mullo_epi32(__m128i a, __m128i b) {
+  __m128i even = _mm_mul_epu32(a, b);
+  __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+  return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+inline float hsum_ps(__m128 v) {
+  __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+  __m128 sums = _mm_add_ps(v, shuf);
+  shuf = _mm_movehl_ps(shuf, sums);
+  sums = _mm_add_ss(sums, shuf);
+  return _mm_cvtss_f32(sums);
+}
+inline double hsum_pd(__m128d v) {
+  return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+inline std::int32_t hsum_epi32(__m128i v) {
+  __m128i hi = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+  __m128i sum = _mm_add_epi32(v, hi);
+  hi = _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1));
+  return _mm_cvtsi128_si32(_mm_add_epi32(sum, hi));
+}
+
+struct f32 {
+  typedef float scalar;
+  typedef __m128 reg;
+  static const std::size_t width = 4;
+  static reg load(const float *p) { return _mm_loadu_ps(p); }
+  static void store(float *p, reg v) { _mm_storeu_ps(p, v); }
+  static reg set1(float s) { return _mm_set1_ps(s); }
+  static reg zero() { return _mm_setzero_ps(); }
+  static reg apply(add_tag, reg a, reg b) { return _mm_add_ps(a, b); }
+  static reg apply(subtract_tag, reg a, reg b) { return _mm_sub_ps(a, b); }
+  static reg apply(multiply_tag, reg a, reg b) { return _mm_mul_ps(a, b); }
+  static reg apply(divide_tag, reg a, reg b) { return _mm_div_ps(a, b); }
+  static reg fmadd(reg a, reg b, reg c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+  }
+  static float hsum(reg v) { return hsum_ps(v); }
+};
+struct f64 {
+  typedef double scalar;
+  typedef __m128d reg;
+  static const std::size_t width = 2;
+  static reg load(const double *p) { return _mm_loadu_pd(p); }
+  static void store(double *p, reg v) { _mm_storeu_pd(p, v); }
+  static reg set1(double s) { return _mm_set1_pd(s); }
+  static reg zero() { return _mm_setzero_pd(); }
+  static reg apply(add_tag, reg a, reg b) { return _mm_add_pd(a, b); }
+  static reg apply(subtract_tag, reg a, reg b) { return _mm_sub_pd(a, b); }
+  static reg apply(multiply_tag, reg a, reg b) { return _mm_mul_pd(a, b); }
+  static reg apply(divide_tag, reg a, reg b) { return _mm_div_pd(a, b); }
+  static reg fmadd(reg a, reg b, reg c) {
+    return _mm_add_pd(_mm_mul_pd(a, b), c);
+  }
+  static double hsum(reg v) { return hsum_pd(v); }
+};
+struct i32 {
+  typedef std::int32_t scalar;
+  typedef __m128i reg;
+  static const std::size_t width = 4;
+  static reg load(const std::int32_t *p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  }
+  static void store(std::int32_t *p, reg v) {
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+  }
+  static reg set1(std::int32_t s) { return _mm_set1_epi32(s); }
+  static reg zero() { return _mm_setzero_si128(); }
+  static reg apply(add_tag, reg a, reg b) { return _mm_add_epi32(a, b); }
+  static reg apply(subtract_tag, reg a, reg b) { return _mm_sub_epi32(a, b); }
+  static reg apply(multiply_tag, reg a, reg b) { return mullo_epi32(a, b); }
+  /** there is no integer division instruction, divide lane by lane*/
+  static reg apply(divide_tag, reg a, reg b) {
+    std::int32_t x[width], y[width];
+    store(x, a);
+    store(y, b);
+    for (std::size_t i = 0; i < width; i++) {
+      x[i] /= y[i];
+    }
+    return load(x);
+  }
+  static reg fmadd(reg a, reg b, reg c) {
+    return _mm_add_epi32(mullo_epi32(a, b), c);
+  }
+  static std::int32_t hsum(reg v) { return hsum_epi32(v); }
+};
+
+VEPP_SIMD_GENERIC_KERNELS
+
+} // namespace sse2
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))),           \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+namespace avx2 {
+
+struct f32 {
+  typedef float scalar;
+  typedef __m256 reg;
+  static const std::size_t width = 8;
+  static reg load(const float *p) { return _mm256_loadu_ps(p); }
+  static void store(float *p, reg v) { _mm256_storeu_ps(p, v); }
+  static reg set1(float s) { return _mm256_set1_ps(s); }
+  static reg zero() { return _mm256_setzero_ps(); }
+  static reg apply(add_tag, reg a, reg b) { return _mm256_add_ps(a, b); }
+  static reg apply(subtract_tag, reg a, reg b) { return _mm256_sub_ps(a, b); }
+  static reg apply(multiply_tag, reg a, reg b) { return _mm256_mul_ps(a, b); }
+  static reg apply(divide_tag, reg a, reg b) { return _mm256_div_ps(a, b); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_ps(a, b, c); }
+  static float hsum(reg v) {
+    return sse2::hsum_ps(_mm_add_ps(_mm256_castps256_ps128(v),
+                                    _mm256_extractf128_ps(v, 1)));
+  }
+};
+struct f64 {
+  typedef double scalar;
+  typedef __m256d reg;
+  static const std::size_t width = 4;
+  static reg load(const double *p) { return _mm256_loadu_pd(p); }
+  static void store(double *p, reg v) { _mm256_storeu_pd(p, v); }
+  static reg set1(double s) { return _mm256_set1_pd(s); }
+  static reg zero() { return _mm256_setzero_pd(); }
+  static reg apply(add_tag, reg a, reg b) { return _mm256_add_pd(a, b); }
+  static reg apply(subtract_tag, reg a, reg b) { return _mm256_sub_pd(a, b); }
+  static reg apply(multiply_tag, reg a, reg b) { return _mm256_mul_pd(a, b); }
+  static reg apply(divide_tag, reg a, reg b) { return _mm256_div_pd(a, b); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+  static double hsum(reg v) {
+    return sse2::hsum_pd(_mm_add_pd(_mm256_castpd256_pd128(v),
+                                    _mm256_extractf128_pd(v, 1)));
+  }
+};
+struct i32 {
+  typedef std::int32_t scalar;
+  typedef __m256i reg;
+  static const std::size_t width = 8;
+  static reg load(const std::int32_t *p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  }
+  static void store(std::int32_t *p, reg v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v);
+  }
+  static reg set1(std::int32_t s) { return _mm256_set1_epi32(s); }
+  static reg zero() { return _mm256_setzero_si256(); }
+  static reg apply(add_tag, reg a, reg b) { return _mm256_add_epi32(a, b); }
+  static reg apply(subtract_tag, reg a, reg b) {
+    return _mm256_sub_epi32(a, b);
+  }
+  static reg apply(multiply_tag, reg a, reg b) {
+    return _mm256_mullo_epi32(a, b);
+  }
+  /** there is no integer division instruction, divide lane by lane*/
+  static reg apply(divide_tag, reg a, reg b) {
+    std::int32_t x[width], y[width];
+    store(x, a);
+    store(y, b);
+    for (std::size_t i = 0; i < width; i++) {
+      x[i] /= y[i];
+    }
+    return load(x);
+  }
+  static reg fmadd(reg a, reg b, reg c) {
+    return _mm256_add_epi32(_mm256_mullo_epi32(a, b), c);
+  }
+  static std::int32_t hsum(reg v) {
+    return sse2::hsum_epi32(_mm_add_epi32(_mm256_castsi256_si128(v),
+                                          _mm256_extracti128_si256(v, 1)));
+  }
+};
+
+VEPP_SIMD_GENERIC_KERNELS
+
+} // namespace avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))),            \
+                             apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+// the GCC 12 reduce intrinsics read an undefined register on purpose
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+namespace avx512 {
+
+struct f32 {
+  typedef float scalar;
+  typedef __m512 reg;
+  static const std::size_t width = 16;
+  static reg load(const float *p) { return _mm512_loadu_ps(p); }
+  static void store(float *p, reg v) { _mm512_storeu_ps(p, v); }
+  static reg set1(float s) { return _mm512_set1_ps(s); }
+  static reg zero() { return _mm512_setzero_ps(); }
+  static reg apply(add_tag, reg a, reg b) { return _mm512_add_ps(a, b); }
+  static reg apply(subtract_tag, reg a, reg b) { return _mm512_sub_ps(a, b); }
+  static reg apply(multiply_tag, reg a, reg b) { return _mm512_mul_ps(a, b); }
+  static reg apply(divide_tag, reg a, reg b) { return _mm512_div_ps(a, b); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_ps(a, b, c); }
+  static float hsum(reg v) { return _mm512_reduce_add_ps(v); }
+};
+struct f64 {
+  typedef double scalar;
+  typedef __m512d reg;
+  static const std::size_t width = 8;
+  static reg load(const double *p) { return _mm512_loadu_pd(p); }
+  static void store(double *p, reg v) { _mm512_storeu_pd(p, v); }
+  static reg set1(double s) { return _mm512_set1_pd(s); }
+  static reg zero() { return _mm512_setzero_pd(); }
+  static reg apply(add_tag, reg a, reg b) { return _mm512_add_pd(a, b); }
+  static reg apply(subtract_tag, reg a, reg b) { return _mm512_sub_pd(a, b); }
+  static reg apply(multiply_tag, reg a, reg b) { return _mm512_mul_pd(a, b); }
+  static reg apply(divide_tag, reg a, reg b) { return _mm512_div_pd(a, b); }
+  static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+  static double hsum(reg v) { return _mm512_reduce_add_pd(v); }
+};
+struct i32 {
+  typedef std::int32_t scalar;
+  typedef __m512i reg;
+  static const std::size_t width = 16;
+  static reg load(const std::int32_t *p) { return _mm512_loadu_si512(p); }
+  static void store(std::int32_t *p, reg v) { _mm512_storeu_si512(p, v); }
+  static reg set1(std::int32_t s) { return _mm512_set1_epi32(s); }
+  static reg zero() { return _mm512_setzero_si512(); }
+  static reg apply(add_tag, reg a, reg b) { return _mm512_add_epi32(a, b); }
+  static reg apply(subtract_tag, reg a, reg b) {
+    return _mm512_sub_epi32(a, b);
+  }
+  static reg apply(multiply_tag, reg a, reg b) {
+    return _mm512_mullo_epi32(a, b);
+  }
+  /** there is no integer division instruction, divide lane by lane*/
+  static reg apply(divide_tag, reg a, reg b) {
+    std::int32_t x[width], y[width];
+    store(x, a);
+    store(y, b);
+    for (std::size_t i = 0; i < width; i++) {
+      x[i] /= y[i];
+    }
+    return load(x);
+  }
+  static reg fmadd(reg a, reg b, reg c) {
+    return _mm512_add_epi32(_mm512_mullo_epi32(a, b), c);
+  }
+  static std::int32_t hsum(reg v) { return _mm512_reduce_add_epi32(v); }
+};
+
+VEPP_SIMD_GENERIC_KERNELS
+
+} // namespace avx512
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+#endif
+
+#undef VEPP_SIMD_GENERIC_KERNELS
+
+/** maps a scalar type to its register traits for each instruction set*/
+template <class T> struct traits_of {};
+template <> struct traits_of<float> {
+  typedef sse2::f32 sse2_t;
+  typedef avx2::f32 avx2_t;
+  typedef avx512::f32 avx512_t;
+};
+template <> struct traits_of<double> {
+  typedef sse2::f64 sse2_t;
+  typedef avx2::f64 avx2_t;
+  typedef avx512::f64 avx512_t;
+};
+template <> struct traits_of<std::int32_t> {
+  typedef sse2::i32 sse2_t;
+  typedef avx2::i32 avx2_t;
+  typedef avx512::i32 avx512_t;
+};
+
+template <class T> Kernels<T> isa_kernels(isa_t isa) {
+  typedef traits_of<T> tr;
+  switch (isa) {
+  case ISA_SSE2:
+    return sse2::make_kernels<typename tr::sse2_t>();
+  case ISA_AVX2:
+    return avx2::make_kernels<typename tr::avx2_t>();
+  case ISA_AVX512:
+    return avx512::make_kernels<typename tr::avx512_t>();
+  default:
+    return scalar_kernels<T>();
+  }
+}
+/** types with SIMD kernels*/
+template <class T> struct has_kernels { static const bool value = false; };
+template <> struct has_kernels<float> { static const bool value = true; };
+template <> struct has_kernels<double> { static const bool value = true; };
+template <> struct has_kernels<std::int32_t> {
+  static const bool value = true;
+};
+
+#else
+
+template <class T> struct has_kernels { static const bool value = false; };
+
+#endif
+
+/** kernel tables, one per instruction set for the types that have SIMD
+ * kernels and a single scalar one for every other type*/
+template <class T, bool Simd = has_kernels<T>::value> struct table {
+  static const Kernels<T> &get() {
+    static const Kernels<T> k = scalar_kernels<T>();
+    return k;
+  }
+};
+#if VEPP_SIMD_X86
+template <class T> struct table<T, true> {
+  static const Kernels<T> &get() {
+    static const Kernels<T> tables[4] = {
+        isa_kernels<T>(ISA_SCALAR), isa_kernels<T>(ISA_SSE2),
+        isa_kernels<T>(ISA_AVX2), isa_kernels<T>(ISA_AVX512)};
+    return tables[active_isa()];
+  }
+};
+#endif
+
+/** kernel table of the active instruction set*/
+template <class T> const Kernels<T> &kernels() { return table<T>::get(); }
+
+/** bulk kernels over n elements, out may alias a or b*/
+template <class T>
+void add(const T *a, const T *b, T *out, std::size_t n) {
+  kernels<T>().add(a, b, out, n);
+}
+template <class T>
+void subtract(const T *a, const T *b, T *out, std::size_t n) {
+  kernels<T>().subtract(a, b, out, n);
+}
+template <class T>
+void multiply(const T *a, const T *b, T *out, std::size_t n) {
+  kernels<T>().multiply(a, b, out, n);
+}
+template <class T>
+void divide(const T *a, const T *b, T *out, std::size_t n) {
+  kernels<T>().divide(a, b, out, n);
+}
+template <class T> void add(const T *a, T s, T *out, std::size_t n) {
+  kernels<T>().add_scalar(a, s, out, n);
+}
+template <class T> void subtract(const T *a, T s, T *out, std::size_t n) {
+  kernels<T>().subtract_scalar(a, s, out, n);
+}
+template <class T> void multiply(const T *a, T s, T *out, std::size_t n) {
+  kernels<T>().multiply_scalar(a, s, out, n);
+}
+template <class T> void divide(const T *a, T s, T *out, std::size_t n) {
+  kernels<T>().divide_scalar(a, s, out, n);
+}
+template <class T> T dot(const T *a, const T *b, std::size_t n) {
+  return kernels<T>().dot(a, b, n);
+}
+/** fused kernels: out = a * b + c, out = s * x + y and out = s * x + t * y.
+ * The AVX2 and AVX-512 ones round once per element with the FMA
+ * instructions, SSE2 has none and multiplies then adds. out may alias
+ * any input*/
+template <class T>
+void fma(const T *a, const T *b, const T *c, T *out, std::size_t n) {
+  kernels<T>().fma(a, b, c, out, n);
+}
+template <class T>
+void axpy(T s, const T *x, const T *y, T *out, std::size_t n) {
+  kernels<T>().axpy(s, x, y, out, n);
+}
+template <class T>
+void axpby(T s, const T *x, T t, const T *y, T *out, std::size_t n) {
+  kernels<T>().axpby(s, x, t, y, out, n);
+}
+/** batched matrix transform over structure of arrays lanes: out[r][i] is
+ * the dot product of row r of the rows x cols row major matrix m with
+ * (in[0][i], ..., in[cols - 1][i]). out must not alias in*/
+template <class T>
+void transform(const T *m, unsigned int rows, unsigned int cols,
+               const T *const *in, T *const *out, std::size_t n) {
+  kernels<T>().transform(m, rows, cols, in, out, n);
+}
+/** batched quaternion kernels over the x, y, z, w lanes of n quaternions:
+ * the Hamilton product a[i] b[i], and the rotation of the xyz vector
+ * v[i] by the unit quaternion q[i]. out may alias any input*/
+template <class T>
+void quat_multiply(const T *const *a, const T *const *b, T *const *out,
+                   std::size_t n) {
+  kernels<T>().quat_multiply(a, b, out, n);
+}
+template <class T>
+void quat_rotate(const T *const *q, const T *const *v, T *const *out,
+                 std::size_t n) {
+  kernels<T>().quat_rotate(q, v, out, n);
+}
+
+/** converts n elements from S to D. A plain cast unless a faster kernel
+ * is specialized, as vepp_half.hpp does for the 16 bit floats*/
+template <class S, class D> struct converter {
+  static void apply(const S *in, D *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+      out[i] = static_cast<D>(in[i]);
+    }
+  }
+};
+template <class S, class D> void convert(const S *in, D *out, std::size_t n) {
+  converter<S, D>::apply(in, out, n);
+}
+
+/** dot product of n elements of T accumulated in Acc, ie in double for
+ * float arrays. The same type goes through the bulk dot kernel*/
+template <class Acc, class T> struct widening_dot {
+  static Acc apply(const T *a, const T *b, std::size_t n) {
+    Acc out = static_cast<Acc>(0);
+    for (std::size_t i = 0; i < n; i++) {
+      out += static_cast<Acc>(a[i]) * static_cast<Acc>(b[i]);
+    }
+    return out;
+  }
+};
+template <class T> struct widening_dot<T, T> {
+  static T apply(const T *a, const T *b, std::size_t n) {
+    return dot(a, b, n);
+  }
+};
+template <class Acc, class T>
+Acc dot_acc(const T *a, const T *b, std::size_t n) {
+  return widening_dot<Acc, T>::apply(a, b, n);
+}
+
+/** fixed size dot product of N elements*/
+template <class T, unsigned int N> struct fixed {
+  static T dot(const T *a, const T *b) {
+    T out = static_cast<T>(0);
+    for (unsigned int i = 0; i < N; i++) {
+      out += a[i] * b[i];
+    }
+    return out;
+  }
+};
+
+/** same with a and b 16 byte aligned and N elements filling whole 16
+ * byte registers*/
+template <class T, unsigned int N> struct fixed_aligned : fixed<T, N> {};
+
+/** fixed size product of the R x C and C x K row major matrices a and
+ * b, out must not alias a or b*/
+template <class T, unsigned int R, unsigned int C, unsigned int K>
+struct fixed_matmul {
+  static void apply(const T *a, const T *b, T *out) {
+    for (unsigned int i = 0; i < R; i++) {
+      T *oi = out + i * K;
+      for (unsigned int j = 0; j < K; j++) {
+        oi[j] = static_cast<T>(0);
+      }
+      for (unsigned int k = 0; k < C; k++) {
+        const T s = a[i * C + k];
+        for (unsigned int j = 0; j < K; j++) {
+          oi[j] += s * b[k * K + j];
+        }
+      }
+    }
+  }
+};
+
+/** fixed size product of the R x C row major matrix m with v, out must
+ * not alias v*/
+template <class T, unsigned int R, unsigned int C> struct fixed_matvec {
+  static void apply(const T *m, const T *v, T *out) {
+    for (unsigned int r = 0; r < R; r++) {
+      out[r] = fixed<T, C>::dot(m + r * C, v);
+    }
+  }
+};
+
+#if VEPP_SIMD_X86
+
+/** loads the n < 4 trailing floats of p, the other lanes are zero*/
+inline __m128 load_partial_ps(const float *p, unsigned int n) {
+  switch (n) {
+  case 1:
+    return _mm_load_ss(p);
+  case 2:
+    // __m64 accesses may alias float, a double load could not
+    return _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(p));
+  case 3:
+    return _mm_movelh_ps(
+        _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64 *>(p)),
+        _mm_load_ss(p + 2));
+  default:
+    return _mm_setzero_ps();
+  }
+}
+
+template <unsigned int N> struct fixed<float, N> {
+  static float dot(const float *a, const float *b) {
+    __m128 acc = _mm_setzero_ps();
+    unsigned int i = 0;
+    for (; i + 4 <= N; i += 4) {
+      acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    if (N % 4 != 0) {
+      // padded lanes are zero in both operands and add nothing
+      acc = _mm_add_ps(acc, _mm_mul_ps(load_partial_ps(a + i, N % 4),
+                                       load_partial_ps(b + i, N % 4)));
+    }
+    return sse2::hsum_ps(acc);
+  }
+};
+template <unsigned int N> struct fixed<double, N> {
+  static double dot(const double *a, const double *b) {
+    __m128d acc = _mm_setzero_pd();
+    unsigned int i = 0;
+    for (; i + 2 <= N; i += 2) {
+      acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    }
+    if (N % 2 != 0) {
+      acc = _mm_add_pd(acc, _mm_mul_pd(_mm_load_sd(a + i), _mm_load_sd(b + i)));
+    }
+    return sse2::hsum_pd(acc);
+  }
+};
+template <unsigned int N> struct fixed<std::int32_t, N> {
+  static std::int32_t dot(const std::int32_t *a, const std::int32_t *b) {
+    __m128i acc = _mm_setzero_si128();
+    unsigned int i = 0;
+    for (; i + 4 <= N; i += 4) {
+      acc = _mm_add_epi32(acc, sse2::mullo_epi32(sse2::i32::load(a + i),
+                                                 sse2::i32::load(b + i)));
+    }
+    std::int32_t out = sse2::hsum_epi32(acc);
+    for (; i < N; i++) {
+      out += a[i] * b[i];
+    }
+    return out;
+  }
+};
+template <unsigned int N> struct fixed_aligned<float, N> {
+  static float dot(const float *a, const float *b) {
+    static_assert(N % 4 == 0, "aligned dot needs whole registers");
+    __m128 acc = _mm_mul_ps(_mm_load_ps(a), _mm_load_ps(b));
+    for (unsigned int i = 4; i < N; i += 4) {
+      acc = _mm_add_ps(acc,
+                       _mm_mul_ps(_mm_load_ps(a + i), _mm_load_ps(b + i)));
+    }
+    return sse2::hsum_ps(acc);
+  }
+};
+template <unsigned int N> struct fixed_aligned<double, N> {
+  static double dot(const double *a, const double *b) {
+    static_assert(N % 2 == 0, "aligned dot needs whole registers");
+    __m128d acc = _mm_mul_pd(_mm_load_pd(a), _mm_load_pd(b));
+    for (unsigned int i = 2; i < N; i += 2) {
+      acc = _mm_add_pd(acc,
+                       _mm_mul_pd(_mm_load_pd(a + i), _mm_load_pd(b + i)));
+    }
+    return sse2::hsum_pd(acc);
+  }
+};
+/** a single element gains nothing from a register*/
+template <> struct fixed<float, 1> {
+  static float dot(const float *a, const float *b) { return a[0] * b[0]; }
+};
+template <> struct fixed<double, 1> {
+  static double dot(const double *a, const double *b) { return a[0] * b[0]; }
+};
+
+/** columns of out are computed two registers at a time, so every
+ * broadcast element of a feeds two multiply-adds and the accumulators
+ * stay in registers over the whole k loop*/
+template <class V, unsigned int R, unsigned int C, unsigned int K>
+struct register_matmul {
+  typedef typename V::scalar S;
+  static void apply(const S *a, const S *b, S *out) {
+    const unsigned int w = static_cast<unsigned int>(V::width);
+    for (unsigned int i = 0; i < R; i++) {
+      const S *ai = a + i * C;
+      S *oi = out + i * K;
+      unsigned int j = 0;
+      for (; j + 2 * w <= K; j += 2 * w) {
+        typename V::reg acc0 = V::zero(), acc1 = V::zero();
+        for (unsigned int k = 0; k < C; k++) {
+          typename V::reg s = V::set1(ai[k]);
+          acc0 = V::fmadd(s, V::load(b + k * K + j), acc0);
+          acc1 = V::fmadd(s, V::load(b + k * K + j + w), acc1);
+        }
+        V::store(oi + j, acc0);
+        V::store(oi + j + w, acc1);
+      }
+      for (; j + w <= K; j += w) {
+        typename V::reg acc = V::zero();
+        for (unsigned int k = 0; k < C; k++) {
+          acc = V::fmadd(V::set1(ai[k]), V::load(b + k * K + j), acc);
+        }
+        V::store(oi + j, acc);
+      }
+      for (; j < K; j++) {
+        S acc = static_cast<S>(0);
+        for (unsigned int k = 0; k < C; k++) {
+          acc += ai[k] * b[k * K + j];
+        }
+        oi[j] = acc;
+      }
+    }
+  }
+};
+template <unsigned int R, unsigned int C, unsigned int K>
+struct fixed_matmul<float, R, C, K> : register_matmul<sse2::f32, R, C, K> {};
+template <unsigned int R, unsigned int C, unsigned int K>
+struct fixed_matmul<double, R, C, K> : register_matmul<sse2::f64, R, C, K> {
+};
+
+/** 3x3 and 4x4 float transforms: the row products are transposed so a
+ * single vertical sum gives all the components at once*/
+template <> struct fixed_matvec<float, 4, 4> {
+  static void apply(const float *m, const float *v, float *out) {
+    __m128 x = _mm_loadu_ps(v);
+    __m128 r0 = _mm_mul_ps(_mm_loadu_ps(m), x);
+    __m128 r1 = _mm_mul_ps(_mm_loadu_ps(m + 4), x);
+    __m128 r2 = _mm_mul_ps(_mm_loadu_ps(m + 8), x);
+    __m128 r3 = _mm_mul_ps(_mm_loadu_ps(m + 12), x);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(out, _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3)));
+  }
+};
+template <> struct fixed_matvec<float, 3, 3> {
+  static void apply(const float *m, const float *v, float *out) {
+    __m128 x = load_partial_ps(v, 3);
+    __m128 r0 = _mm_mul_ps(load_partial_ps(m, 3), x);
+    __m128 r1 = _mm_mul_ps(load_partial_ps(m + 3, 3), x);
+    __m128 r2 = _mm_mul_ps(load_partial_ps(m + 6, 3), x);
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    __m128 sum = _mm_add_ps(_mm_add_ps(r0, r1), r2);
+    _mm_storel_pi(reinterpret_cast<__m64 *>(out), sum);
+    _mm_store_ss(out + 2, _mm_movehl_ps(sum, sum));
+  }
+};
+
+#endif
+
+template <class T, unsigned int N> T dot_n(const T *a, const T *b) {
+  return fixed<T, N>::dot(a, b);
+}
+/** dot_n over storage known to be aligned when Aligned is true*/
+template <class T, unsigned int N, bool Aligned>
+T dot_lanes_n(const T *a, const T *b) {
+  return std::conditional<Aligned, fixed_aligned<T, N>,
+                          fixed<T, N>>::type::dot(a, b);
+}
+template <class T, unsigned int R, unsigned int C, unsigned int K>
+void matmul_n(const T *a, const T *b, T *out) {
+  fixed_matmul<T, R, C, K>::apply(a, b, out);
+}
+template <class T, unsigned int R, unsigned int C>
+void matvec_n(const T *m, const T *v, T *out) {
+  fixed_matvec<T, R, C>::apply(m, v, out);
+}
+
+} // namespace simd
+} // namespace vepp
+
+#endif
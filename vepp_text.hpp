@@ -0,0 +1,353 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_TEXT_HPP
+#define VEPP_TEXT_HPP
+#include "vepp_array.hpp"
+#include "vepp_parallel.hpp"
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+#include <vector>
+
+/** Text ingest
+
+  parse reads vectors written one per line as numbers separated by a
+  delimiter, whitespace or both ("1,2,3", "1 2 3", "1, 2, 3"), straight
+  into the lanes of a VecNArray. Line ends are found with memchr, which
+  the C library implements with SIMD compares, and numbers are converted
+  with std::from_chars, so there is no stream, locale or temporary vector
+  per row. Blank lines and comment lines are skipped. A row that does not
+  hold exactly N numbers is counted as malformed and left out; the call
+  carries on and reports FORMAT_ERROR with the counts in Stats.
+
+  The overloads taking a parallel::Pool split the text at line ends and
+  parse the pieces concurrently, the vectors keep their order.
+ */
+namespace vepp {
+namespace text {
+
+/** input syntax*/
+struct Format {
+  /** separates numbers besides spaces and tabs, 0 for whitespace only*/
+  char delimiter;
+  /** lines starting with it are skipped, 0 for none*/
+  char comment;
+
+  Format() : delimiter(','), comment('#') {}
+};
+
+/** counts of a parse*/
+struct Stats {
+  /** lines read, blank and comment lines included*/
+  std::size_t lines;
+  std::size_t vectors;
+  /** rows left out: a bad number, or not N of them*/
+  std::size_t malformed;
+  /** line number, from 1, of the first malformed row, 0 if none*/
+  std::size_t first_malformed;
+
+  Stats() : lines(0), vectors(0), malformed(0), first_malformed(0) {}
+
+  /** adds the counts of the text that follows*/
+  void merge(const Stats &s) {
+    if (first_malformed == 0 && s.first_malformed != 0) {
+      first_malformed = lines + s.first_malformed;
+    }
+    lines += s.lines;
+    vectors += s.vectors;
+    malformed += s.malformed;
+  }
+};
+
+/** bytes read from a file at a time*/
+static const std::size_t chunk_bytes = 1 << 22;
+/** smallest piece of text given to one thread*/
+static const std::size_t piece_bytes = 1 << 18;
+
+/** appends rows to the lanes of a VecNArray, growing them geometrically*/
+template <class T, unsigned int N> class Builder {
+  VecNArray<T, N> &out;
+  std::size_t n;
+  std::size_t cap;
+  T *lanes[N];
+
+  void reserve(std::size_t c) {
+    if (c <= cap) {
+      return;
+    }
+    cap = c < 2 * cap ? 2 * cap : c;
+    out.resize_for_overwrite(cap);
+    for (unsigned int k = 0; k < N; k++) {
+      out.lane(k, lanes[k]);
+    }
+  }
+
+public:
+  explicit Builder(VecNArray<T, N> &o) : out(o), n(0), cap(0), lanes() {
+    out.resize_for_overwrite(0);
+  }
+  void push(const T *row) {
+    if (n == cap) {
+      reserve(n + 1024);
+    }
+    for (unsigned int k = 0; k < N; k++) {
+      lanes[k][n] = row[k];
+    }
+    n++;
+  }
+  void append(const VecNArray<T, N> &a) {
+    std::size_t m = 0;
+    a.size(m);
+    if (m == 0) {
+      return;
+    }
+    reserve(n + m);
+    for (unsigned int k = 0; k < N; k++) {
+      const T *l = nullptr;
+      a.lane(k, l);
+      std::memcpy(lanes[k] + n, l, m * sizeof(T));
+    }
+    n += m;
+  }
+  /** trims the lanes to the rows pushed*/
+  void finish() { out.resize_for_overwrite(n); }
+};
+
+inline const char *skip_blanks(const char *p, const char *e) {
+  while (p != e && (*p == ' ' || *p == '\t')) {
+    ++p;
+  }
+  return p;
+}
+
+/** converts the number at p, from_chars takes no leading plus sign. A
+ * sign right after the plus, as in +-5, is malformed*/
+template <class T> bool read_number(const char *&p, const char *e, T &out) {
+  if (p != e && *p == '+') {
+    ++p;
+    if (p != e && (*p == '+' || *p == '-')) {
+      return false;
+    }
+  }
+  std::from_chars_result r = std::from_chars(p, e, out);
+  if (r.ec != std::errc()) {
+    return false;
+  }
+  p = r.ptr;
+  return true;
+}
+
+/** parses the line [b, e) without its line feed: 1 with row filled, 0
+ * for a blank or comment line, -1 when malformed*/
+template <class T, unsigned int N>
+int parse_line(const char *b, const char *e, const Format &f, T *row) {
+  if (e != b && e[-1] == '\r') {
+    --e;
+  }
+  const char *p = skip_blanks(b, e);
+  if (p == e || (f.comment != 0 && *p == f.comment)) {
+    return 0;
+  }
+  for (unsigned int k = 0; k < N; k++) {
+    if (k > 0) {
+      // blanks, at most one delimiter, blanks, and at least one of them
+      const char *q = skip_blanks(p, e);
+      if (q != e && f.delimiter != 0 && *q == f.delimiter) {
+        q = skip_blanks(q + 1, e);
+      }
+      if (q == p) {
+        return -1;
+      }
+      p = q;
+    }
+    if (!read_number(p, e, row[k])) {
+      return -1;
+    }
+  }
+  return skip_blanks(p, e) == e ? 1 : -1;
+}
+
+/** parses every line of [b, e), the last one may lack its line feed*/
+template <class T, unsigned int N>
+void parse_block(const char *b, const char *e, const Format &f,
+                 Builder<T, N> &out, Stats &st) {
+  T row[N];
+  while (b != e) {
+    const char *nl =
+        static_cast<const char *>(std::memchr(b, '\n', e - b));
+    const char *end = nl != nullptr ? nl : e;
+    st.lines++;
+    int r = parse_line<T, N>(b, end, f, row);
+    if (r > 0) {
+      out.push(row);
+      st.vectors++;
+    } else if (r < 0) {
+      if (st.malformed == 0) {
+        st.first_malformed = st.lines;
+      }
+      st.malformed++;
+    }
+    b = nl != nullptr ? nl + 1 : e;
+  }
+}
+
+/** parse_block over pieces of [b, e) cut at line ends, on the pool when
+ * there is one and the text is large enough*/
+template <class T, unsigned int N>
+void parse_lines(parallel::Pool *p, const char *b, const char *e,
+                 const Format &f, Builder<T, N> &out, Stats &st) {
+  const std::size_t n = static_cast<std::size_t>(e - b);
+  std::size_t nb = p != nullptr ? n / piece_bytes : 1;
+  if (p != nullptr && nb > 4 * p->size()) {
+    nb = 4 * p->size();
+  }
+  if (nb <= 1) {
+    Stats s;
+    parse_block(b, e, f, out, s);
+    st.merge(s);
+    return;
+  }
+  std::vector<const char *> cuts(nb + 1);
+  cuts[0] = b;
+  cuts[nb] = e;
+  for (std::size_t i = 1; i < nb; i++) {
+    const char *c = b + n * i / nb;
+    if (c < cuts[i - 1]) {
+      c = cuts[i - 1];
+    }
+    const char *nl =
+        static_cast<const char *>(std::memchr(c, '\n', e - c));
+    cuts[i] = nl != nullptr ? nl + 1 : e;
+  }
+  std::vector<VecNArray<T, N>> parts(nb);
+  std::vector<Stats> stats(nb);
+  p->run(nb, [&](std::size_t i, unsigned int) {
+    Builder<T, N> part(parts[i]);
+    parse_block(cuts[i], cuts[i + 1], f, part, stats[i]);
+    part.finish();
+  });
+  for (std::size_t i = 0; i < nb; i++) {
+    out.append(parts[i]);
+    st.merge(stats[i]);
+  }
+}
+
+template <class T, unsigned int N>
+Result parse_text(parallel::Pool *p, const char *data, std::size_t n,
+                  VecNArray<T, N> &out, Stats &stats, const Format &f) {
+  stats = Stats();
+  Builder<T, N> b(out);
+  parse_lines(p, data, data + n, f, b, stats);
+  b.finish();
+  Result vflag(__LINE__, __FILE__, __FUNCTION__,
+               probe_status(stats.malformed == 0 ? SUCCESS : FORMAT_ERROR));
+  return vflag;
+}
+
+template <class T, unsigned int N>
+Result parse_file(parallel::Pool *p, std::FILE *in, VecNArray<T, N> &out,
+                  Stats &stats, const Format &f) {
+  stats = Stats();
+  Builder<T, N> b(out);
+  std::vector<char> buf(chunk_bytes);
+  // buf[0, kept) is the start of a line not yet complete
+  std::size_t kept = 0;
+  bool eof = false;
+  while (!eof) {
+    if (kept == buf.size()) {
+      // a line longer than the buffer
+      buf.resize(2 * buf.size());
+    }
+    std::size_t got = std::fread(buf.data() + kept, 1, buf.size() - kept, in);
+    eof = got < buf.size() - kept;
+    const std::size_t end = kept + got;
+    std::size_t last = end;
+    if (!eof) {
+      while (last > 0 && buf[last - 1] != '\n') {
+        last--;
+      }
+    }
+    parse_lines(p, buf.data(), buf.data() + last, f, b, stats);
+    kept = end - last;
+    std::memmove(buf.data(), buf.data() + last, kept);
+  }
+  b.finish();
+  status_t s = SUCCESS;
+  if (stats.malformed != 0) {
+    s = FORMAT_ERROR;
+  }
+  if (std::ferror(in)) {
+    s = IO_ERROR;
+  }
+  Result vflag(__LINE__, __FILE__, __FUNCTION__, probe_status(s));
+  return vflag;
+}
+
+/*! Tested */
+/** parses n bytes of text into out*/
+template <class T, unsigned int N>
+Result parse(const char *data, std::size_t n, VecNArray<T, N> &out,
+             Stats &stats, const Format &f = Format()) {
+  return parse_text<T, N>(nullptr, data, n, out, stats, f);
+}
+/*! Tested */
+template <class T, unsigned int N>
+Result parse(parallel::Pool &p, const char *data, std::size_t n,
+             VecNArray<T, N> &out, Stats &stats, const Format &f = Format()) {
+  return parse_text<T, N>(&p, data, n, out, stats, f);
+}
+/*! Tested */
+/** reads in to its end a chunk at a time*/
+template <class T, unsigned int N>
+Result parse(std::FILE *in, VecNArray<T, N> &out, Stats &stats,
+             const Format &f = Format()) {
+  return parse_file<T, N>(nullptr, in, out, stats, f);
+}
+/*! Tested */
+template <class T, unsigned int N>
+Result parse(parallel::Pool &p, std::FILE *in, VecNArray<T, N> &out,
+             Stats &stats, const Format &f = Format()) {
+  return parse_file<T, N>(&p, in, out, stats, f);
+}
+
+} // namespace text
+} // namespace vepp
+
+#endif
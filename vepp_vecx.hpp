@@ -0,0 +1,503 @@
+/*
+MIT License
+
+Copyright (c) 2021 Viva Lambda email
+<76657254+Viva-Lambda@users.noreply.github.com>
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy
+of this software and associated documentation files (the
+"Software"), to deal
+in the Software without restriction, including without
+limitation the rights
+to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO
+EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef VEPP_VECX_HPP
+#define VEPP_VECX_HPP
+#include "vepp.hpp"
+#include <cstddef>
+#include <memory>
+
+namespace vepp {
+
+/** Vector whose dimension is set at runtime
+
+  Up to Inline elements live in a buffer inside the object, larger
+  vectors are allocated with Alloc, which can be any standard allocator
+  including stateful arena allocators. A VecX can also borrow memory it
+  does not own, ie the elements of a VecN, without copying; a borrowed
+  vector cannot change size.
+
+  The methods mirror VecN. Sizes are checked once per call and an
+  output of the right size is reused as it is, so repeated calls do not
+  allocate. Outputs may alias the operands.
+ */
+template <class T, unsigned int Inline = 16, class Policy = CheckedPolicy,
+          class Alloc = std::allocator<T>>
+class VecX {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "VecX elements are copied as raw memory");
+  typedef std::allocator_traits<Alloc> alloc_traits;
+
+  T *ptr;
+  std::size_t count;
+  std::size_t capacity;
+  bool owned;
+  Alloc alloc;
+  T buffer[Inline == 0 ? 1 : Inline];
+
+  bool on_heap() const { return owned && ptr != buffer; }
+  void release() {
+    if (on_heap()) {
+      alloc_traits::deallocate(alloc, ptr, capacity);
+    }
+    ptr = buffer;
+    capacity = Inline;
+    owned = true;
+  }
+  /** makes room for n elements keeping the first count ones*/
+  void grow(std::size_t n) {
+    if (n <= capacity) {
+      return;
+    }
+    T *p = alloc_traits::allocate(alloc, n);
+    for (std::size_t i = 0; i < count; i++) {
+      p[i] = ptr[i];
+    }
+    release();
+    ptr = p;
+    capacity = n;
+  }
+  void assign(const T *p, std::size_t n) {
+    count = 0;
+    grow(n);
+    for (std::size_t i = 0; i < n; i++) {
+      ptr[i] = p[i];
+    }
+    count = n;
+  }
+  /** gives out the size n, false when out is a borrowed vector of
+   * another size*/
+  static bool fit(VecX &out, std::size_t n) {
+    if (out.count == n) {
+      return true;
+    }
+    if (!out.owned) {
+      return false;
+    }
+    out.count = 0;
+    out.grow(n);
+    out.count = n;
+    return true;
+  }
+
+public:
+  typedef T value_type;
+  static const unsigned int inline_size = Inline;
+
+  /*! Tested */
+  explicit VecX(const Alloc &a = Alloc())
+      : ptr(buffer), count(0), capacity(Inline), owned(true), alloc(a) {}
+  /*! Tested */
+  explicit VecX(std::size_t n, T s = static_cast<T>(0),
+                const Alloc &a = Alloc())
+      : ptr(buffer), count(0), capacity(Inline), owned(true), alloc(a) {
+    grow(n);
+    for (std::size_t i = 0; i < n; i++) {
+      ptr[i] = s;
+    }
+    count = n;
+  }
+  /*! Tested */
+  template <class A = std::allocator<T>>
+  VecX(const std::vector<T, A> &v, const Alloc &a = Alloc())
+      : ptr(buffer), count(0), capacity(Inline), owned(true), alloc(a) {
+    assign(v.data(), v.size());
+  }
+  VecX(const T *p, std::size_t n, const Alloc &a = Alloc())
+      : ptr(buffer), count(0), capacity(Inline), owned(true), alloc(a) {
+    assign(p, n);
+  }
+  /** copies the elements of a VecN, see borrow for a zero copy view*/
+  /*! Tested */
+  template <unsigned int N, class P, class S>
+  explicit VecX(const VecN<T, N, P, S> &v, const Alloc &a = Alloc())
+      : ptr(buffer), count(0), capacity(Inline), owned(true), alloc(a) {
+    assign(v.elements(), N);
+  }
+  /** copies own their elements, even when other is borrowed*/
+  /*! Tested */
+  VecX(const VecX &other)
+      : ptr(buffer), count(0), capacity(Inline), owned(true),
+        alloc(alloc_traits::select_on_container_copy_construction(
+            other.alloc)) {
+    assign(other.ptr, other.count);
+  }
+  /*! Tested */
+  VecX(VecX &&other) noexcept
+      : ptr(buffer), count(0), capacity(Inline), owned(true),
+        alloc(std::move(other.alloc)) {
+    if (other.on_heap() || !other.owned) {
+      ptr = other.ptr;
+      capacity = other.capacity;
+      owned = other.owned;
+      count = other.count;
+      other.ptr = other.buffer;
+      other.capacity = Inline;
+      other.owned = true;
+      other.count = 0;
+    } else {
+      assign(other.ptr, other.count);
+    }
+  }
+  /** a borrowed vector writes through, see assign. Other sizes cannot be
+   * reported through a Result, so they throw StatusError(SIZE_ERROR)
+   * whatever the policy*/
+  /*! Tested */
+  VecX &operator=(const VecX &other) {
+    if (!owned && other.count != count) {
+      policy_fails<Policy>(false, SIZE_ERROR);
+      throw StatusError(SIZE_ERROR);
+    }
+    assign(other);
+    return *this;
+  }
+  /** a borrowed vector keeps its view and writes through like the copy*/
+  VecX &operator=(VecX &&other) {
+    if (!owned) {
+      return *this = static_cast<const VecX &>(other);
+    }
+    if (this != &other) {
+      release();
+      count = 0;
+      if (other.on_heap() || !other.owned) {
+        // the allocator follows the memory it has to free
+        alloc = std::move(other.alloc);
+        ptr = other.ptr;
+        capacity = other.capacity;
+        owned = other.owned;
+        count = other.count;
+        other.ptr = other.buffer;
+        other.capacity = Inline;
+        other.owned = true;
+        other.count = 0;
+      } else {
+        assign(other.ptr, other.count);
+      }
+    }
+    return *this;
+  }
+  ~VecX() { release(); }
+
+  /** non owning view of n elements at p, p must outlive the view*/
+  /*! Tested */
+  static VecX borrow(T *p, std::size_t n) {
+    VecX v;
+    v.ptr = p;
+    v.count = n;
+    v.capacity = n;
+    v.owned = false;
+    return v;
+  }
+  /** non owning view of the elements of a VecN*/
+  /*! Tested */
+  template <unsigned int N, class P, class S>
+  static VecX borrow(VecN<T, N, P, S> &v) {
+    return borrow(v.elements(), N);
+  }
+
+  /*! Tested */
+  Result size(std::size_t &out) const {
+    out = count;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** true when the elements are on the heap*/
+  bool allocated() const { return on_heap(); }
+  /** true when the elements belong to someone else*/
+  bool borrowed() const { return !owned; }
+  /** contiguous storage of the elements*/
+  const T *elements() const { return ptr; }
+  T *elements() { return ptr; }
+
+  /** copies the elements of other. A borrowed vector keeps its view and
+   * writes through to the memory it views, other must then have its size*/
+  /*! Tested */
+  Result assign(const VecX &other) {
+    if (owned) {
+      if (this != &other) {
+        assign(other.ptr, other.count);
+      }
+    } else {
+      if (policy_fails<Policy>(other.count == count, SIZE_ERROR)) {
+        Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+        return vflag;
+      }
+      for (std::size_t i = 0; i < count; i++) {
+        ptr[i] = other.ptr[i];
+      }
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result resize(std::size_t n) {
+    if (policy_fails<Policy>(owned || n == count, SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    std::size_t old = count;
+    grow(n);
+    for (std::size_t i = old; i < n; i++) {
+      ptr[i] = static_cast<T>(0);
+    }
+    count = n;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result get(std::size_t index, T &out) const {
+    if (policy_fails<Policy>(index < count, INDEX_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    out = ptr[index];
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result set(std::size_t index, T el) {
+    if (policy_fails<Policy>(index < count, INDEX_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, INDEX_ERROR);
+      return vflag;
+    }
+    ptr[index] = el;
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** copies into a VecN, the sizes have to match*/
+  /*! Tested */
+  template <unsigned int N, class P, class S>
+  Result to_vecn(VecN<T, N, P, S> &out) const {
+    if (policy_fails<Policy>(count == N, SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    T *o = out.elements();
+    for (unsigned int i = 0; i < N; i++) {
+      o[i] = ptr[i];
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+
+  //
+  template <class Fn> Result apply_el(T v, const Fn &fn, VecX &out) const {
+    if (policy_fails<Policy>(fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    T *o = out.ptr;
+    for (std::size_t i = 0; i < count; i++) {
+      o[i] = fn(ptr[i], v);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  template <class Fn>
+  Result apply_el(const VecX &v, const Fn &fn, VecX &out) const {
+    if (policy_fails<Policy>(v.count == count && fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    T *o = out.ptr;
+    for (std::size_t i = 0; i < count; i++) {
+      o[i] = fn(ptr[i], v.ptr[i]);
+    }
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+
+  /*! Tested */
+  Result add(T v, VecX &out) const {
+    if (policy_fails<Policy>(fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    simd::add(ptr, v, out.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result add(const VecX &v, VecX &out) const {
+    if (policy_fails<Policy>(v.count == count && fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    simd::add(ptr, v.ptr, out.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result subtract(T v, VecX &out) const {
+    if (policy_fails<Policy>(fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    simd::subtract(ptr, v, out.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result subtract(const VecX &v, VecX &out) const {
+    if (policy_fails<Policy>(v.count == count && fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    simd::subtract(ptr, v.ptr, out.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result multiply(T v, VecX &out) const {
+    if (policy_fails<Policy>(fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    simd::multiply(ptr, v, out.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result multiply(const VecX &v, VecX &out) const {
+    if (policy_fails<Policy>(v.count == count && fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    simd::multiply(ptr, v.ptr, out.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result divide(T v, VecX &out) const {
+    if (policy_fails<Policy>(v != static_cast<T>(0), ARG_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    if (policy_fails<Policy>(fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    simd::divide(ptr, v, out.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result divide(const VecX &v, VecX &out) const {
+    if (policy_fails<Policy>(v.count == count, SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    bool has_zero = false;
+    for (std::size_t i = 0; i < count; i++) {
+      has_zero |= v.ptr[i] == static_cast<T>(0);
+    }
+    if (policy_fails<Policy>(!has_zero, ARG_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    if (policy_fails<Policy>(fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    simd::divide(ptr, v.ptr, out.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result dot(const VecX &v, T &out) const {
+    if (policy_fails<Policy>(v.count == count, SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    out = simd::dot(ptr, v.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result length_squared(T &out) const {
+    out = simd::dot(ptr, ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /*! Tested */
+  Result length(T &out) const {
+    out = static_cast<T>(std::sqrt(simd::dot(ptr, ptr, count)));
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  Result distance(const VecX &v, T &out) const {
+    if (policy_fails<Policy>(v.count == count, SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    T sq = static_cast<T>(0);
+    for (std::size_t i = 0; i < count; i++) {
+      T d = ptr[i] - v.ptr[i];
+      sq += d * d;
+    }
+    out = static_cast<T>(std::sqrt(sq));
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+  /** unit vector in the same direction, a zero vector is an ARG_ERROR*/
+  /*! Tested */
+  Result normalize(VecX &out) const {
+    T sq = simd::dot(ptr, ptr, count);
+    if (policy_fails<Policy>(sq != static_cast<T>(0), ARG_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, ARG_ERROR);
+      return vflag;
+    }
+    if (policy_fails<Policy>(fit(out, count), SIZE_ERROR)) {
+      Result vflag(__LINE__, __FILE__, __FUNCTION__, SIZE_ERROR);
+      return vflag;
+    }
+    simd::multiply(ptr, static_cast<T>(1) / static_cast<T>(std::sqrt(sq)),
+                   out.ptr, count);
+    Result vflag(__LINE__, __FILE__, __FUNCTION__, SUCCESS);
+    return vflag;
+  }
+};
+
+/** VecX aliases for each error policy*/
+template <class T, unsigned int Inline = 16>
+using VecXChecked = VecX<T, Inline, CheckedPolicy>;
+template <class T, unsigned int Inline = 16>
+using VecXThrow = VecX<T, Inline, ThrowPolicy>;
+template <class T, unsigned int Inline = 16>
+using VecXUnchecked = VecX<T, Inline, UncheckedPolicy>;
+
+} // namespace vepp
+
+#endif